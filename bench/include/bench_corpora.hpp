@@ -0,0 +1,109 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_BENCH_CORPORA_HPP
+#define BXZSTR_BENCH_CORPORA_HPP
+
+#include <cstdint>
+#include <string>
+
+// Generated inputs for bxzstr_bench. Every corpus is the same for a
+// given size, so that results can be compared across commits.
+namespace bench {
+enum Corpus { random_corpus, text_corpus, fastq_corpus, log_corpus };
+
+inline const char* corpus_name(const Corpus corpus) {
+    switch (corpus) {
+	case random_corpus: return "random";
+	case text_corpus: return "text";
+	case fastq_corpus: return "fastq";
+	default: return "log";
+    }
+}
+
+class xorshift {
+  public:
+    xorshift() : x(88172645463325252ULL) {}
+    uint64_t operator()() {
+	x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+	return x;
+    }
+  private:
+    uint64_t x;
+};
+
+// Incompressible bytes.
+inline std::string random_data(const std::size_t size) {
+    xorshift rng;
+    std::string data(size, '\0');
+    for (std::size_t i = 0; i < size; ++i) data[i] = (char)(rng() & 0xff);
+    return data;
+}
+
+// Lines of prose-like text.
+inline std::string text_data(const std::size_t size) {
+    static const char* words[] = { "the", "of", "and", "to", "in", "compression", "stream", "buffer",
+				   "data", "is", "a", "for", "that", "with", "file", "read", "write",
+				   "block", "level", "format", "library", "header", "input", "output" };
+    xorshift rng;
+    std::string data;
+    data.reserve(size + 64);
+    while (data.size() < size) {
+	const uint64_t r = rng();
+	data += words[r % 24];
+	data += (r % 13 == 0 ? ".\n" : (r % 7 == 0 ? ", " : " "));
+    }
+    data.resize(size);
+    return data;
+}
+
+// FASTQ records with 150 bp reads.
+inline std::string fastq_data(const std::size_t size) {
+    static const char bases[] = "ACGT";
+    xorshift rng;
+    std::string data;
+    data.reserve(size + 512);
+    for (uint64_t read = 0; data.size() < size; ++read) {
+	data += "@SRR0000001." + std::to_string(read) + " length=150\n";
+	for (int i = 0; i < 150; ++i) data += bases[rng() % 4];
+	data += "\n+\n";
+	for (int i = 0; i < 150; ++i) data += (char)('0' + (i < 100 ? 10 : 0) + (int)(rng() % 6));
+	data += '\n';
+    }
+    data.resize(size);
+    return data;
+}
+
+// Timestamped service log lines.
+inline std::string log_data(const std::size_t size) {
+    static const char* levels[] = { "INFO", "INFO", "INFO", "DEBUG", "WARN", "ERROR" };
+    static const char* events[] = { "request completed", "cache miss", "connection opened",
+				    "connection closed", "retrying upstream", "slow query" };
+    xorshift rng;
+    std::string data;
+    data.reserve(size + 256);
+    for (uint64_t ms = 1700000000000ULL; data.size() < size; ms += rng() % 50) {
+	const uint64_t r = rng();
+	data += std::to_string(ms) + " " + levels[r % 6] + " worker-" + std::to_string(r % 16) + " "
+	    + events[(r >> 8) % 6] + " id=" + std::to_string((r >> 16) % 1000000)
+	    + " latency_ms=" + std::to_string((r >> 32) % 2000) + "\n";
+    }
+    data.resize(size);
+    return data;
+}
+
+inline std::string make_corpus(const Corpus corpus, const std::size_t size) {
+    switch (corpus) {
+	case random_corpus: return random_data(size);
+	case text_corpus: return text_data(size);
+	case fastq_corpus: return fastq_data(size);
+	default: return log_data(size);
+    }
+}
+} // namespace bench
+
+#endif
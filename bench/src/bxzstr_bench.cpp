@@ -0,0 +1,467 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+// Throughput benchmarks for bxzstr. Run with
+//   bxzstr_bench --benchmark_out=results.json --benchmark_out_format=json
+// and compare two runs with compare.py from Google Benchmark. The
+// corpus size is 8 MiB, or BXZSTR_BENCH_CORPUS_MB from the environment.
+
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+#include <sstream>
+
+#include <benchmark/benchmark.h>
+
+#include "bxzstr.hpp"
+#include "bench_corpora.hpp"
+
+namespace {
+struct codec {
+    const char* name;
+    bxz::Compression type;
+    std::vector<int> levels;
+};
+
+std::vector<codec> codecs() {
+    std::vector<codec> available;
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+    available.push_back({ "gzip", bxz::z, { 1, 6, 9 } });
+    available.push_back({ "bgzf", bxz::bgzf, { 1, 6 } });
+#endif
+#if defined(BXZSTR_BZ2_SUPPORT) && (BXZSTR_BZ2_SUPPORT) == 1
+    available.push_back({ "bz2", bxz::bz2, { 1, 9 } });
+#endif
+#if defined(BXZSTR_LZMA_SUPPORT) && (BXZSTR_LZMA_SUPPORT) == 1
+    available.push_back({ "lzma", bxz::lzma, { 0, 6 } });
+#endif
+#if defined(BXZSTR_ZSTD_SUPPORT) && (BXZSTR_ZSTD_SUPPORT) == 1
+    available.push_back({ "zstd", bxz::zstd, { 1, 3, 19 } });
+#endif
+#if defined(BXZSTR_LZ4_SUPPORT) && (BXZSTR_LZ4_SUPPORT) == 1
+    available.push_back({ "lz4", bxz::lz4, { 0, -8 } });
+#endif
+#if defined(BXZSTR_BROTLI_SUPPORT) && (BXZSTR_BROTLI_SUPPORT) == 1
+    available.push_back({ "brotli", bxz::brotli, { 1, 6 } });
+#endif
+    return available;
+}
+
+const bench::Corpus corpora[] = { bench::random_corpus, bench::text_corpus, bench::fastq_corpus, bench::log_corpus };
+
+std::size_t corpus_size() {
+    const char* mb = std::getenv("BXZSTR_BENCH_CORPUS_MB");
+    return (mb != nullptr && std::atoi(mb) > 0 ? (std::size_t)std::atoi(mb) : 8) << 20;
+}
+
+const std::string& corpus(const bench::Corpus which) {
+    static std::map<int, std::string> cache;
+    std::string &data = cache[which];
+    if (data.empty()) data = bench::make_corpus(which, corpus_size());
+    return data;
+}
+
+std::string stream_compress(const std::string &data, const bxz::Compression type, const int level,
+		     const std::size_t buff_size = (std::size_t)1 << 20) {
+    std::stringbuf out;
+    {
+	bxz::ostreambuf obuf(&out, type, level, buff_size);
+	obuf.sputn(data.data(), (std::streamsize)data.size());
+    }
+    return out.str();
+}
+
+// Compressed inputs for the decompression benchmarks, made once.
+const std::string& compressed(const bxz::Compression type, const bench::Corpus which, const int level) {
+    static std::map<std::string, std::string> cache;
+    std::string &data = cache[std::to_string(type) + "/" + std::to_string(which) + "/" + std::to_string(level)];
+    if (data.empty()) data = stream_compress(corpus(which), type, level);
+    return data;
+}
+
+std::size_t stream_decompress(const std::string &data, const bxz::Compression type,
+		       const std::size_t buff_size = (std::size_t)1 << 20) {
+    std::stringbuf in(data);
+    bxz::istreambuf ibuf(&in, type, buff_size);
+    std::vector<char> out((std::size_t)1 << 16);
+    std::size_t total = 0;
+    std::streamsize n;
+    while ((n = ibuf.sgetn(out.data(), (std::streamsize)out.size())) > 0) total += (std::size_t)n;
+    return total;
+}
+
+int default_level(const codec &c) { return c.levels[c.levels.size() / 2]; }
+
+void register_codec_benchmarks() {
+    for (const codec &c : codecs()) {
+	for (const bench::Corpus which : corpora) {
+	    for (const int level : c.levels) {
+		const std::string name = std::string("compress/") + c.name + "/" + std::to_string(level)
+		    + "/" + bench::corpus_name(which);
+		const bxz::Compression type = c.type;
+		benchmark::RegisterBenchmark(name.c_str(), [type, which, level](benchmark::State &state) {
+		    const std::string &data = corpus(which);
+		    std::size_t size = 0;
+		    for (auto _ : state) {
+			size = stream_compress(data, type, level).size();
+			benchmark::DoNotOptimize(size);
+		    }
+		    state.SetBytesProcessed((int64_t)state.iterations()*(int64_t)data.size());
+		    state.counters["ratio"] = (double)data.size()/(double)size;
+		})->Unit(benchmark::kMillisecond);
+	    }
+	    const std::string name = std::string("decompress/") + c.name + "/" + bench::corpus_name(which);
+	    const bxz::Compression type = c.type;
+	    const int level = default_level(c);
+	    benchmark::RegisterBenchmark(name.c_str(), [type, which, level](benchmark::State &state) {
+		const std::string &data = compressed(type, which, level);
+		for (auto _ : state) benchmark::DoNotOptimize(stream_decompress(data, type));
+		state.SetBytesProcessed((int64_t)state.iterations()*(int64_t)corpus(which).size());
+	    })->Unit(benchmark::kMillisecond);
+	}
+    }
+}
+
+// Buffer sizes from 4 KiB to 4 MiB for gzip and zstd.
+void register_buffer_size_benchmarks() {
+    for (const codec &c : codecs()) {
+	if (c.type != bxz::z && c.type != bxz::zstd) continue;
+	const bxz::Compression type = c.type;
+	const int level = default_level(c);
+	for (std::size_t buff_size = (std::size_t)1 << 12; buff_size <= ((std::size_t)1 << 22); buff_size <<= 2) {
+	    const std::string suffix = std::string(c.name) + "/" + std::to_string(buff_size);
+	    benchmark::RegisterBenchmark(("buff_size/compress/" + suffix).c_str(), [type, level, buff_size](benchmark::State &state) {
+		const std::string &data = corpus(bench::log_corpus);
+		for (auto _ : state) benchmark::DoNotOptimize(stream_compress(data, type, level, buff_size));
+		state.SetBytesProcessed((int64_t)state.iterations()*(int64_t)data.size());
+	    })->Unit(benchmark::kMillisecond);
+	    benchmark::RegisterBenchmark(("buff_size/decompress/" + suffix).c_str(), [type, level, buff_size](benchmark::State &state) {
+		const std::string &data = compressed(type, bench::log_corpus, level);
+		for (auto _ : state) benchmark::DoNotOptimize(stream_decompress(data, type, buff_size));
+		state.SetBytesProcessed((int64_t)state.iterations()*(int64_t)corpus(bench::log_corpus).size());
+	    })->Unit(benchmark::kMillisecond);
+	}
+    }
+}
+
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+// The ways of reading a bxz::istream, on gzip compressed log lines.
+template <typename Read>
+void access_benchmark(benchmark::State &state, Read read) {
+    const std::string &data = compressed(bxz::z, bench::log_corpus, 6);
+    for (auto _ : state) {
+	std::stringbuf in(data);
+	bxz::istream is(&in);
+	benchmark::DoNotOptimize(read(is));
+    }
+    state.SetBytesProcessed((int64_t)state.iterations()*(int64_t)corpus(bench::log_corpus).size());
+}
+
+void BM_AccessGet(benchmark::State &state) {
+    access_benchmark(state, [](std::istream &is) {
+	std::size_t n = 0;
+	char c;
+	while (is.get(c)) ++n;
+	return n;
+    });
+}
+void BM_AccessGetline(benchmark::State &state) {
+    access_benchmark(state, [](std::istream &is) {
+	std::size_t n = 0;
+	std::string line;
+	while (std::getline(is, line)) n += line.size();
+	return n;
+    });
+}
+void BM_AccessRead(benchmark::State &state) {
+    access_benchmark(state, [](std::istream &is) {
+	std::size_t n = 0;
+	std::vector<char> buf((std::size_t)1 << 16);
+	while (is.read(buf.data(), (std::streamsize)buf.size()) || is.gcount() > 0) n += (std::size_t)is.gcount();
+	return n;
+    });
+}
+void BM_AccessExtract(benchmark::State &state) {
+    access_benchmark(state, [](std::istream &is) {
+	std::size_t n = 0;
+	std::string word;
+	while (is >> word) n += word.size();
+	return n;
+    });
+}
+BENCHMARK(BM_AccessGet)->Name("access/get")->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_AccessGetline)->Name("access/getline")->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_AccessRead)->Name("access/read")->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_AccessExtract)->Name("access/operator>>")->Unit(benchmark::kMillisecond);
+
+// Reading a whole gzip file into a string, through an ifstream and
+// with bxz::read_all().
+const char* whole_file_path = "bxzstr_bench_whole_file.gz";
+const std::string& whole_file() {
+    static const std::string path = whole_file_path;
+    static bool written = false;
+    if (!written) {
+	std::ofstream out(path, std::ios_base::binary);
+	out << compressed(bxz::z, bench::log_corpus, 6);
+	written = true;
+    }
+    return path;
+}
+void BM_WholeFileIterator(benchmark::State &state) {
+    for (auto _ : state) {
+	bxz::ifstream in(whole_file());
+	std::string s((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	benchmark::DoNotOptimize(s);
+    }
+    state.SetBytesProcessed((int64_t)state.iterations()*(int64_t)corpus(bench::log_corpus).size());
+}
+void BM_WholeFileReadAll(benchmark::State &state) {
+    for (auto _ : state) benchmark::DoNotOptimize(bxz::read_all(whole_file()));
+    state.SetBytesProcessed((int64_t)state.iterations()*(int64_t)corpus(bench::log_corpus).size());
+}
+BENCHMARK(BM_WholeFileIterator)->Name("whole_file/istreambuf_iterator")->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_WholeFileReadAll)->Name("whole_file/read_all")->Unit(benchmark::kMillisecond);
+
+// Counting the lines of the gzip file with std::getline(), by
+// scanning the chunks of the output buffer in place and with
+// bxz::line_reader.
+void BM_ScanGetline(benchmark::State &state) {
+    for (auto _ : state) {
+	bxz::ifstream in(whole_file());
+	std::size_t lines = 0;
+	for (std::string line; std::getline(in, line); ) ++lines;
+	benchmark::DoNotOptimize(lines);
+    }
+    state.SetBytesProcessed((int64_t)state.iterations()*(int64_t)corpus(bench::log_corpus).size());
+}
+void BM_ScanChunks(benchmark::State &state) {
+    for (auto _ : state) {
+	bxz::ifstream in(whole_file());
+	std::size_t lines = 0;
+	for (const bxz::chunk &c : bxz::chunks(in)) lines += std::count(c.begin(), c.end(), '\n');
+	benchmark::DoNotOptimize(lines);
+    }
+    state.SetBytesProcessed((int64_t)state.iterations()*(int64_t)corpus(bench::log_corpus).size());
+}
+void BM_ScanLineReader(benchmark::State &state) {
+    for (auto _ : state) {
+	bxz::ifstream in(whole_file());
+	std::size_t lines = 0;
+	for (const bxz::chunk &line : bxz::line_reader(in)) lines += (line.size > 0);
+	benchmark::DoNotOptimize(lines);
+    }
+    state.SetBytesProcessed((int64_t)state.iterations()*(int64_t)corpus(bench::log_corpus).size());
+}
+BENCHMARK(BM_ScanGetline)->Name("scan_lines/getline")->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ScanChunks)->Name("scan_lines/next_chunk")->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ScanLineReader)->Name("scan_lines/line_reader")->Unit(benchmark::kMillisecond);
+
+// zlib without the wrapper, with the same 1 MiB buffers as the
+// compress/gzip/6 and decompress/gzip benchmarks.
+void BM_RawZlibCompress(benchmark::State &state) {
+    const std::string &data = corpus(bench::log_corpus);
+    std::vector<unsigned char> out((std::size_t)1 << 20);
+    for (auto _ : state) {
+	z_stream strm = z_stream();
+	deflateInit2(&strm, 6, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+	std::string compressed;
+	for (std::size_t pos = 0; ; ) {
+	    const std::size_t n = std::min(out.size(), data.size() - pos);
+	    strm.next_in = (Bytef*)data.data() + pos;
+	    strm.avail_in = (uInt)n;
+	    pos += n;
+	    const int flush = (pos == data.size() ? Z_FINISH : Z_NO_FLUSH);
+	    int ret;
+	    do {
+		strm.next_out = out.data();
+		strm.avail_out = (uInt)out.size();
+		ret = deflate(&strm, flush);
+		compressed.append((const char*)out.data(), out.size() - strm.avail_out);
+	    } while (strm.avail_out == 0);
+	    if (ret == Z_STREAM_END) break;
+	}
+	deflateEnd(&strm);
+	benchmark::DoNotOptimize(compressed);
+    }
+    state.SetBytesProcessed((int64_t)state.iterations()*(int64_t)data.size());
+}
+void BM_RawZlibDecompress(benchmark::State &state) {
+    const std::string &data = compressed(bxz::z, bench::log_corpus, 6);
+    std::vector<unsigned char> out((std::size_t)1 << 20);
+    for (auto _ : state) {
+	z_stream strm = z_stream();
+	inflateInit2(&strm, 15 + 32);
+	strm.next_in = (Bytef*)data.data();
+	strm.avail_in = (uInt)data.size();
+	std::size_t total = 0;
+	int ret = Z_OK;
+	while (ret == Z_OK) {
+	    strm.next_out = out.data();
+	    strm.avail_out = (uInt)out.size();
+	    ret = inflate(&strm, Z_NO_FLUSH);
+	    total += out.size() - strm.avail_out;
+	}
+	inflateEnd(&strm);
+	benchmark::DoNotOptimize(total);
+    }
+    state.SetBytesProcessed((int64_t)state.iterations()*(int64_t)corpus(bench::log_corpus).size());
+}
+void BM_WrappedZlibCompress(benchmark::State &state) {
+    const std::string &data = corpus(bench::log_corpus);
+    for (auto _ : state) benchmark::DoNotOptimize(stream_compress(data, bxz::z, 6));
+    state.SetBytesProcessed((int64_t)state.iterations()*(int64_t)data.size());
+}
+void BM_WrappedZlibDecompress(benchmark::State &state) {
+    const std::string &data = compressed(bxz::z, bench::log_corpus, 6);
+    for (auto _ : state) benchmark::DoNotOptimize(stream_decompress(data, bxz::z));
+    state.SetBytesProcessed((int64_t)state.iterations()*(int64_t)corpus(bench::log_corpus).size());
+}
+BENCHMARK(BM_RawZlibCompress)->Name("overhead/compress/gzip/raw")->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_WrappedZlibCompress)->Name("overhead/compress/gzip/bxzstr")->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RawZlibDecompress)->Name("overhead/decompress/gzip/raw")->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_WrappedZlibDecompress)->Name("overhead/decompress/gzip/bxzstr")->Unit(benchmark::kMillisecond);
+#endif
+
+#if defined(BXZSTR_ZSTD_SUPPORT) && (BXZSTR_ZSTD_SUPPORT) == 1
+// zstd without the wrapper, with the same 1 MiB buffers.
+void BM_RawZstdCompress(benchmark::State &state) {
+    const std::string &data = corpus(bench::log_corpus);
+    std::vector<char> out((std::size_t)1 << 20);
+    for (auto _ : state) {
+	ZSTD_CCtx *cctx = ZSTD_createCCtx();
+	ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, 3);
+	std::string compressed;
+	for (std::size_t pos = 0; ; ) {
+	    const std::size_t n = std::min(out.size(), data.size() - pos);
+	    ZSTD_inBuffer input = { data.data() + pos, n, 0 };
+	    pos += n;
+	    const ZSTD_EndDirective mode = (pos == data.size() ? ZSTD_e_end : ZSTD_e_continue);
+	    std::size_t remaining;
+	    do {
+		ZSTD_outBuffer output = { out.data(), out.size(), 0 };
+		remaining = ZSTD_compressStream2(cctx, &output, &input, mode);
+		compressed.append(out.data(), output.pos);
+	    } while (mode == ZSTD_e_end ? remaining != 0 : input.pos < input.size);
+	    if (mode == ZSTD_e_end) break;
+	}
+	ZSTD_freeCCtx(cctx);
+	benchmark::DoNotOptimize(compressed);
+    }
+    state.SetBytesProcessed((int64_t)state.iterations()*(int64_t)data.size());
+}
+void BM_RawZstdDecompress(benchmark::State &state) {
+    const std::string &data = compressed(bxz::zstd, bench::log_corpus, 3);
+    std::vector<char> out((std::size_t)1 << 20);
+    for (auto _ : state) {
+	ZSTD_DCtx *dctx = ZSTD_createDCtx();
+	ZSTD_inBuffer input = { data.data(), data.size(), 0 };
+	std::size_t total = 0;
+	while (input.pos < input.size) {
+	    ZSTD_outBuffer output = { out.data(), out.size(), 0 };
+	    ZSTD_decompressStream(dctx, &output, &input);
+	    total += output.pos;
+	}
+	ZSTD_freeDCtx(dctx);
+	benchmark::DoNotOptimize(total);
+    }
+    state.SetBytesProcessed((int64_t)state.iterations()*(int64_t)corpus(bench::log_corpus).size());
+}
+void BM_WrappedZstdCompress(benchmark::State &state) {
+    const std::string &data = corpus(bench::log_corpus);
+    for (auto _ : state) benchmark::DoNotOptimize(stream_compress(data, bxz::zstd, 3));
+    state.SetBytesProcessed((int64_t)state.iterations()*(int64_t)data.size());
+}
+void BM_WrappedZstdDecompress(benchmark::State &state) {
+    const std::string &data = compressed(bxz::zstd, bench::log_corpus, 3);
+    for (auto _ : state) benchmark::DoNotOptimize(stream_decompress(data, bxz::zstd));
+    state.SetBytesProcessed((int64_t)state.iterations()*(int64_t)corpus(bench::log_corpus).size());
+}
+BENCHMARK(BM_RawZstdCompress)->Name("overhead/compress/zstd/raw")->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_WrappedZstdCompress)->Name("overhead/compress/zstd/bxzstr")->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RawZstdDecompress)->Name("overhead/decompress/zstd/raw")->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_WrappedZstdDecompress)->Name("overhead/decompress/zstd/bxzstr")->Unit(benchmark::kMillisecond);
+#endif
+
+// 4 KiB messages compressed through an ostreambuf and with the
+// one-shot bxz::compress().
+void small_message_benchmark(benchmark::State &state, const bxz::Compression type, const bool one_shot) {
+    const std::string message = corpus(bench::log_corpus).substr(0, 4096);
+    for (auto _ : state) {
+	if (one_shot) benchmark::DoNotOptimize(bxz::compress(type, message, 3));
+	else benchmark::DoNotOptimize(stream_compress(message, type, 3));
+    }
+    state.SetBytesProcessed((int64_t)state.iterations()*(int64_t)message.size());
+}
+void register_small_message_benchmarks() {
+    for (const codec &c : codecs()) {
+	if (c.type != bxz::z && c.type != bxz::zstd) continue;
+	const bxz::Compression type = c.type;
+	benchmark::RegisterBenchmark(("small_message/" + std::string(c.name) + "/stream").c_str(),
+				     [type](benchmark::State &state) { small_message_benchmark(state, type, false); });
+	benchmark::RegisterBenchmark(("small_message/" + std::string(c.name) + "/one_shot").c_str(),
+				     [type](benchmark::State &state) { small_message_benchmark(state, type, true); });
+    }
+}
+
+// The log corpus cut into 64 KiB pages, compressed through an
+// ostreambuf per page and with bxz::compress_batch() on one thread and
+// on one thread per core.
+void batch_benchmark(benchmark::State &state, const bxz::Compression type, const int mode) {
+    const std::string &data = corpus(bench::log_corpus);
+    const std::size_t page_size = (std::size_t)1 << 16;
+    std::vector<bxz::batch_input> inputs;
+    std::vector<bxz::batch_output> outputs;
+    std::vector<std::string> pages_out;
+    for (std::size_t pos = 0; pos < data.size(); pos += page_size)
+	inputs.emplace_back(&data[pos], std::min(page_size, data.size() - pos));
+    for (const bxz::batch_input &in : inputs) pages_out.push_back(std::string(bxz::compress_bound(type, in.size), '\0'));
+    for (std::string &out : pages_out) outputs.emplace_back(&out[0], out.size());
+    for (auto _ : state) {
+	if (mode == 0) {
+	    for (const bxz::batch_input &in : inputs)
+		benchmark::DoNotOptimize(stream_compress(std::string(static_cast<const char*>(in.data), in.size), type, 3));
+	} else {
+	    bxz::params prm(3);
+	    prm.max_threads = (mode == 1 ? 1 : 0);
+	    benchmark::DoNotOptimize(bxz::compress_batch(type, inputs, outputs, prm));
+	}
+    }
+    state.SetBytesProcessed((int64_t)state.iterations()*(int64_t)data.size());
+}
+void register_batch_benchmarks() {
+    for (const codec &c : codecs()) {
+	if (c.type != bxz::z && c.type != bxz::zstd) continue;
+	const bxz::Compression type = c.type;
+	const char *modes[] = { "streams", "batch_1_thread", "batch_all_threads" };
+	for (int mode = 0; mode < 3; ++mode) {
+	    benchmark::RegisterBenchmark(("batch/" + std::string(c.name) + "/" + modes[mode]).c_str(),
+					 [type, mode](benchmark::State &state) { batch_benchmark(state, type, mode); })
+		->Unit(benchmark::kMillisecond)->UseRealTime();
+	}
+    }
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    register_codec_benchmarks();
+    register_buffer_size_benchmarks();
+    register_small_message_benchmarks();
+    register_batch_benchmarks();
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+    std::remove(whole_file_path);
+#endif
+    return 0;
+}
@@ -0,0 +1,33 @@
+# Finds the brotli encoder and decoder libraries.
+#
+# Defines BROTLI_FOUND, BROTLI_INCLUDE_DIR, BROTLI_LIBRARIES and the
+# imported target Brotli::Brotli. Set Brotli_ROOT to search a custom
+# installation prefix first.
+
+include(FindPackageHandleStandardArgs)
+
+find_path(BROTLI_INCLUDE_DIR NAMES brotli/decode.h brotli/encode.h)
+
+find_library(BROTLI_ENC_LIBRARY NAMES brotlienc brotlienc-static)
+find_library(BROTLI_DEC_LIBRARY NAMES brotlidec brotlidec-static)
+find_library(BROTLI_COMMON_LIBRARY NAMES brotlicommon brotlicommon-static)
+
+find_package_handle_standard_args(Brotli REQUIRED_VARS BROTLI_ENC_LIBRARY BROTLI_DEC_LIBRARY BROTLI_COMMON_LIBRARY BROTLI_INCLUDE_DIR)
+
+mark_as_advanced(BROTLI_INCLUDE_DIR BROTLI_ENC_LIBRARY BROTLI_DEC_LIBRARY BROTLI_COMMON_LIBRARY)
+
+if(BROTLI_FOUND)
+
+  set(BROTLI_LIBRARIES ${BROTLI_ENC_LIBRARY} ${BROTLI_DEC_LIBRARY} ${BROTLI_COMMON_LIBRARY})
+
+  if(NOT TARGET Brotli::Brotli)
+
+    add_library(Brotli::Brotli INTERFACE IMPORTED)
+
+    set_target_properties(Brotli::Brotli PROPERTIES
+      INTERFACE_INCLUDE_DIRECTORIES ${BROTLI_INCLUDE_DIR}
+      INTERFACE_LINK_LIBRARIES "${BROTLI_LIBRARIES}")
+
+  endif()
+
+endif()
@@ -0,0 +1,33 @@
+# Finds the igzip library of ISA-L (Intel Intelligent Storage
+# Acceleration Library).
+#
+# Defines ISAL_FOUND, ISAL_INCLUDE_DIR, ISAL_LIBRARIES and the imported
+# target ISAL::ISAL. Set ISAL_ROOT to search a custom installation
+# prefix first.
+
+include(FindPackageHandleStandardArgs)
+
+find_path(ISAL_INCLUDE_DIR NAMES isa-l/igzip_lib.h)
+
+find_library(ISAL_LIBRARY NAMES isal)
+
+find_package_handle_standard_args(ISAL REQUIRED_VARS ISAL_LIBRARY ISAL_INCLUDE_DIR)
+
+mark_as_advanced(ISAL_INCLUDE_DIR ISAL_LIBRARY)
+
+if(ISAL_FOUND)
+
+  set(ISAL_LIBRARIES ${ISAL_LIBRARY})
+
+  if(NOT TARGET ISAL::ISAL)
+
+    add_library(ISAL::ISAL UNKNOWN IMPORTED)
+
+    set_target_properties(ISAL::ISAL PROPERTIES
+      INTERFACE_INCLUDE_DIRECTORIES ${ISAL_INCLUDE_DIR}
+      IMPORTED_LOCATION "${ISAL_LIBRARY}"
+      IMPORTED_LINK_INTERFACE_LANGUAGES C)
+
+  endif()
+
+endif()
@@ -0,0 +1,63 @@
+# Finds the lz4 library and the LZ4 frame API header (lz4frame.h).
+#
+# Defines LZ4_FOUND, LZ4_INCLUDE_DIR, LZ4_LIBRARIES, LZ4_VERSION_STRING
+# and the imported target LZ4::LZ4. Set LZ4_ROOT to search a custom
+# installation prefix first.
+
+include(SelectLibraryConfigurations)
+include(FindPackageHandleStandardArgs)
+
+find_path(LZ4_INCLUDE_DIR NAMES lz4frame.h)
+
+find_library(LZ4_LIBRARY_DEBUG NAMES lz4d lz4_staticd)
+find_library(LZ4_LIBRARY_RELEASE NAMES lz4 lz4_static)
+
+select_library_configurations(LZ4)
+
+if(LZ4_INCLUDE_DIR AND EXISTS "${LZ4_INCLUDE_DIR}/lz4.h")
+
+  file(STRINGS "${LZ4_INCLUDE_DIR}/lz4.h" _lz4_h REGEX "#define LZ4_VERSION_[A-Z]+[ \t]+[0-9]+")
+
+  string(REGEX REPLACE ".*#define LZ4_VERSION_MAJOR[ \t]+([0-9]+).*" "\\1" LZ4_VERSION_MAJOR "${_lz4_h}")
+  string(REGEX REPLACE ".*#define LZ4_VERSION_MINOR[ \t]+([0-9]+).*" "\\1" LZ4_VERSION_MINOR "${_lz4_h}")
+  string(REGEX REPLACE ".*#define LZ4_VERSION_RELEASE[ \t]+([0-9]+).*" "\\1" LZ4_VERSION_PATCH "${_lz4_h}")
+
+  set(LZ4_VERSION_STRING "${LZ4_VERSION_MAJOR}.${LZ4_VERSION_MINOR}.${LZ4_VERSION_PATCH}")
+
+  unset(_lz4_h)
+
+endif()
+
+find_package_handle_standard_args(LZ4 REQUIRED_VARS LZ4_LIBRARIES LZ4_INCLUDE_DIR VERSION_VAR LZ4_VERSION_STRING)
+
+mark_as_advanced(LZ4_INCLUDE_DIR)
+
+if(LZ4_FOUND AND NOT TARGET LZ4::LZ4)
+
+  add_library(LZ4::LZ4 UNKNOWN IMPORTED)
+
+  set_target_properties(LZ4::LZ4 PROPERTIES
+    INTERFACE_INCLUDE_DIRECTORIES ${LZ4_INCLUDE_DIR}
+    IMPORTED_LINK_INTERFACE_LANGUAGES C)
+
+  if(LZ4_LIBRARY_RELEASE)
+
+    set_property(TARGET LZ4::LZ4 APPEND PROPERTY
+      IMPORTED_CONFIGURATIONS RELEASE)
+
+    set_target_properties(LZ4::LZ4 PROPERTIES
+      IMPORTED_LOCATION_RELEASE "${LZ4_LIBRARY_RELEASE}")
+
+  endif()
+
+  if(LZ4_LIBRARY_DEBUG)
+
+    set_property(TARGET LZ4::LZ4 APPEND PROPERTY
+      IMPORTED_CONFIGURATIONS DEBUG)
+
+    set_target_properties(LZ4::LZ4 PROPERTIES
+      IMPORTED_LOCATION_DEBUG "${LZ4_LIBRARY_DEBUG}")
+
+  endif()
+
+endif()
@@ -0,0 +1,41 @@
+# Finds libdeflate (https://github.com/ebiggers/libdeflate).
+#
+# Defines LIBDEFLATE_FOUND, LIBDEFLATE_INCLUDE_DIR, LIBDEFLATE_LIBRARIES,
+# LIBDEFLATE_VERSION_STRING and the imported target
+# Libdeflate::Libdeflate. Set Libdeflate_ROOT to search a custom
+# installation prefix first.
+
+include(FindPackageHandleStandardArgs)
+
+find_path(LIBDEFLATE_INCLUDE_DIR NAMES libdeflate.h)
+
+find_library(LIBDEFLATE_LIBRARY NAMES deflate libdeflate)
+
+if(LIBDEFLATE_INCLUDE_DIR AND EXISTS "${LIBDEFLATE_INCLUDE_DIR}/libdeflate.h")
+
+  file(STRINGS "${LIBDEFLATE_INCLUDE_DIR}/libdeflate.h" _libdeflate_h REGEX "#define LIBDEFLATE_VERSION_STRING[ \t]+\"[^\"]+\"")
+  string(REGEX REPLACE ".*#define LIBDEFLATE_VERSION_STRING[ \t]+\"([^\"]+)\".*" "\\1" LIBDEFLATE_VERSION_STRING "${_libdeflate_h}")
+  unset(_libdeflate_h)
+
+endif()
+
+find_package_handle_standard_args(Libdeflate REQUIRED_VARS LIBDEFLATE_LIBRARY LIBDEFLATE_INCLUDE_DIR VERSION_VAR LIBDEFLATE_VERSION_STRING)
+
+mark_as_advanced(LIBDEFLATE_INCLUDE_DIR LIBDEFLATE_LIBRARY)
+
+if(LIBDEFLATE_FOUND)
+
+  set(LIBDEFLATE_LIBRARIES ${LIBDEFLATE_LIBRARY})
+
+  if(NOT TARGET Libdeflate::Libdeflate)
+
+    add_library(Libdeflate::Libdeflate UNKNOWN IMPORTED)
+
+    set_target_properties(Libdeflate::Libdeflate PROPERTIES
+      INTERFACE_INCLUDE_DIRECTORIES ${LIBDEFLATE_INCLUDE_DIR}
+      IMPORTED_LOCATION "${LIBDEFLATE_LIBRARY}"
+      IMPORTED_LINK_INTERFACE_LANGUAGES C)
+
+  endif()
+
+endif()
@@ -0,0 +1,40 @@
+# Finds the native (zng_ prefixed) API of zlib-ng.
+#
+# Defines ZLIBNG_FOUND, ZLIBNG_INCLUDE_DIR, ZLIBNG_LIBRARIES,
+# ZLIBNG_VERSION_STRING and the imported target ZlibNG::ZlibNG. Set
+# ZlibNG_ROOT to search a custom installation prefix first.
+
+include(FindPackageHandleStandardArgs)
+
+find_path(ZLIBNG_INCLUDE_DIR NAMES zlib-ng.h)
+
+find_library(ZLIBNG_LIBRARY NAMES z-ng zlib-ng)
+
+if(ZLIBNG_INCLUDE_DIR AND EXISTS "${ZLIBNG_INCLUDE_DIR}/zlib-ng.h")
+
+  file(STRINGS "${ZLIBNG_INCLUDE_DIR}/zlib-ng.h" _zlibng_h REGEX "#define ZLIBNG_VERSION[ \t]+\"[^\"]+\"")
+  string(REGEX REPLACE ".*#define ZLIBNG_VERSION[ \t]+\"([^\"]+)\".*" "\\1" ZLIBNG_VERSION_STRING "${_zlibng_h}")
+  unset(_zlibng_h)
+
+endif()
+
+find_package_handle_standard_args(ZlibNG REQUIRED_VARS ZLIBNG_LIBRARY ZLIBNG_INCLUDE_DIR VERSION_VAR ZLIBNG_VERSION_STRING)
+
+mark_as_advanced(ZLIBNG_INCLUDE_DIR ZLIBNG_LIBRARY)
+
+if(ZLIBNG_FOUND)
+
+  set(ZLIBNG_LIBRARIES ${ZLIBNG_LIBRARY})
+
+  if(NOT TARGET ZlibNG::ZlibNG)
+
+    add_library(ZlibNG::ZlibNG UNKNOWN IMPORTED)
+
+    set_target_properties(ZlibNG::ZlibNG PROPERTIES
+      INTERFACE_INCLUDE_DIRECTORIES ${ZLIBNG_INCLUDE_DIR}
+      IMPORTED_LOCATION "${ZLIBNG_LIBRARY}"
+      IMPORTED_LINK_INTERFACE_LANGUAGES C)
+
+  endif()
+
+endif()
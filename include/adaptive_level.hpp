@@ -0,0 +1,59 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_ADAPTIVE_LEVEL_HPP
+#define BXZSTR_ADAPTIVE_LEVEL_HPP
+
+#include <chrono>
+
+namespace bxz {
+namespace detail {
+// Picks the compression level of an ostreambuf with
+// params::adaptive_level from the time spent compressing and the time
+// spent blocked writing to the sink. A sink that is slower than the
+// compressor leaves room for a higher level, and a compressor that is
+// slower than the sink needs a lower one.
+class adaptive_level {
+  public:
+    adaptive_level(const int _level, const int _min_level, const int _max_level)
+	    : min_level(_min_level), max_level(_max_level),
+	      current(_level < _min_level ? _min_level : (_level > _max_level ? _max_level : _level)),
+	      compress_time(0), sink_time(0) {}
+
+    void record(const std::chrono::steady_clock::duration compress,
+		const std::chrono::steady_clock::duration sink) {
+	this->compress_time += compress;
+	this->sink_time += sink;
+    }
+    // Called between blocks. Returns true and the new level in `*level`
+    // if the level should change. The level is only taken with
+    // set_level(), once the codec has changed to it.
+    bool update(int *level) {
+	const double compress = (double)this->compress_time.count();
+	const double sink = (double)this->sink_time.count();
+	this->compress_time = this->sink_time = std::chrono::steady_clock::duration(0);
+	int next = this->current;
+	if (sink > compress*1.25 && next < this->max_level) ++next;
+	else if (compress > sink*1.25 && next > this->min_level) --next;
+	if (next == this->current) return false;
+	*level = next;
+	return true;
+    }
+    void set_level(const int level) { this->current = level; }
+    int level() const { return this->current; }
+
+  private:
+    int min_level;
+    int max_level;
+    int current;
+    std::chrono::steady_clock::duration compress_time;
+    std::chrono::steady_clock::duration sink_time;
+}; // class adaptive_level
+} // namespace detail
+} // namespace bxz
+
+#endif
@@ -0,0 +1,105 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_BATCH_HPP
+#define BXZSTR_BATCH_HPP
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "compression_types.hpp"
+#include "executor.hpp"
+#include "params.hpp"
+#include "one_shot.hpp"
+
+namespace bxz {
+// An input of compress_batch() or decompress_batch().
+struct batch_input {
+    batch_input() : data(nullptr), size(0) {}
+    batch_input(const void *_data, const std::size_t _size) : data(_data), size(_size) {}
+
+    const void *data;
+    std::size_t size;
+};
+
+// The buffer that the output of an item is written to.
+struct batch_output {
+    batch_output() : data(nullptr), capacity(0) {}
+    batch_output(void *_data, const std::size_t _capacity) : data(_data), capacity(_capacity) {}
+
+    void *data;
+    std::size_t capacity;
+};
+
+// The number of bytes written for an item, or why it failed.
+struct batch_result {
+    batch_result() : size(0), error() {}
+
+    std::size_t size;
+    std::string error;
+
+    bool ok() const { return this->error.empty(); }
+};
+
+namespace detail {
+// Runs `item` on each input and output on the executor of `prm`. The
+// one-shot functions cache their codec contexts per thread, so each
+// thread reuses its contexts for all the items it takes.
+inline std::vector<batch_result> run_batch(const std::vector<batch_input> &inputs,
+					   const std::vector<batch_output> &outputs, const params &prm,
+					   const std::function<std::size_t(const batch_input&, const batch_output&)> &item) {
+    if (inputs.size() != outputs.size())
+	throw std::runtime_error("bxzstr: a batch needs one output per input.");
+    std::vector<batch_result> results(inputs.size());
+    const std::function<void(std::size_t)> run_item = [&](const std::size_t i) {
+	try {
+	    results[i].size = item(inputs[i], outputs[i]);
+	} catch (const std::exception &e) {
+	    results[i].error = e.what();
+	} catch (...) {
+	    results[i].error = "bxzstr: unknown error.";
+	}
+    };
+    parallel_for(prm.executor_p ? prm.executor_p : default_executor(), inputs.size(), prm.max_threads, run_item);
+    return results;
+}
+} // namespace detail
+
+// Compresses each input into the output with the same index with
+// bxz::compress() on the executor of `prm`, using at most
+// prm.max_threads threads, for many small independent blobs such as
+// the pages of a database. An item fails on its own, e.g. when its
+// output is smaller than compress_bound(); the result tells its
+// compressed size or the error. Of `prm`, the level, lz4_hc and
+// zstd_dict_id (a dictionary registered with add_zstd_dictionary())
+// are used.
+inline std::vector<batch_result> compress_batch(const Compression type, const std::vector<batch_input> &inputs,
+						const std::vector<batch_output> &outputs,
+						const params &prm = params()) {
+    return detail::run_batch(inputs, outputs, prm, [&](const batch_input &in, const batch_output &out) {
+	return compress(type, in.data, in.size, out.data, out.capacity, prm);
+    });
+}
+
+// Decompresses each input into the output with the same index with
+// bxz::decompress(), detecting the format of each item when `type` is
+// none. zstd items use the registered dictionary with the ID in their
+// frame header, or prm.zstd_dict_id.
+inline std::vector<batch_result> decompress_batch(const std::vector<batch_input> &inputs,
+						  const std::vector<batch_output> &outputs, const Compression type = none,
+						  const params &prm = params()) {
+    return detail::run_batch(inputs, outputs, prm, [&](const batch_input &in, const batch_output &out) {
+	return decompress(in.data, in.size, out.data, out.capacity, type, prm);
+    });
+}
+} // namespace bxz
+
+#endif
@@ -0,0 +1,406 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+
+#ifndef BXZSTR_BGZF_STREAM_WRAPPER_HPP
+#define BXZSTR_BGZF_STREAM_WRAPPER_HPP
+
+#include <zlib.h>
+#if defined(BXZSTR_LIBDEFLATE_SUPPORT) && (BXZSTR_LIBDEFLATE_SUPPORT) == 1
+#include <libdeflate.h>
+#endif
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <memory>
+
+#include "stream_wrapper.hpp"
+#include "z_stream_wrapper.hpp"
+#include "params.hpp"
+
+namespace bxz {
+/// Exception class thrown by failed BGZF operations. Derives from
+/// zException, since BGZF files are gzip files.
+class bgzfException : public zException {
+  public:
+    bgzfException(const std::string &msg) : zException("bgzf: " + msg) {}
+}; // class bgzfException
+
+namespace detail {
+// Decodes and encodes the deflate data of whole BGZF blocks in one
+// call, with libdeflate when bxzstr is configured with
+// BXZSTR_LIBDEFLATE_SUPPORT and with zlib otherwise.
+#if defined(BXZSTR_LIBDEFLATE_SUPPORT) && (BXZSTR_LIBDEFLATE_SUPPORT) == 1
+class bgzf_block_codec {
+  public:
+    bgzf_block_codec(const bool is_input, const int level) : dec(nullptr), enc(nullptr) {
+	if (is_input) {
+	    dec = libdeflate_alloc_decompressor();
+	    if (dec == nullptr) throw bgzfException("libdeflate_alloc_decompressor() failed");
+	} else {
+	    // libdeflate has levels 0-12 and no Z_DEFAULT_COMPRESSION
+	    enc = libdeflate_alloc_compressor(level < 0 ? 6 : level);
+	    if (enc == nullptr) throw bgzfException("invalid compression level " + std::to_string(level));
+	}
+    }
+    ~bgzf_block_codec() {
+	if (dec != nullptr) libdeflate_free_decompressor(dec);
+	if (enc != nullptr) libdeflate_free_compressor(enc);
+    }
+    bgzf_block_codec(const bgzf_block_codec &) = delete;
+    bgzf_block_codec & operator = (const bgzf_block_codec &) = delete;
+
+    // Decodes the gzip member `block` of `size` bytes, whose deflate
+    // data starts at `header`, into the `isize` bytes at `out`.
+    void inflate_block(const uint8_t* block, const size_t size, const size_t header,
+		       uint8_t* out, const size_t isize, const bool verify) {
+	size_t got = 0;
+	// libdeflate_gzip_decompress() also checks the CRC32 and ISIZE
+	const libdeflate_result ret = (verify
+				       ? libdeflate_gzip_decompress(dec, block, size, out, isize, &got)
+				       : libdeflate_deflate_decompress(dec, block + header, size - header - 8,
+								       out, isize, &got));
+	if (ret != LIBDEFLATE_SUCCESS || got != isize)
+	    throw bgzfException("corrupt block (libdeflate error " + std::to_string((int)ret) + ")");
+    }
+    // Returns the size of the raw deflate data written to `out`, or 0
+    // if it does not fit in `capacity` bytes.
+    size_t deflate_block(const uint8_t* in, const size_t n, uint8_t* out, const size_t capacity) {
+	return libdeflate_deflate_compress(enc, in, n, out, capacity);
+    }
+    static uint32_t crc32(const uint8_t* in, const size_t n) { return libdeflate_crc32(0, in, n); }
+    static std::size_t memory_usage() { return (std::size_t)1 << 15; }
+
+  private:
+    libdeflate_decompressor* dec;
+    libdeflate_compressor* enc;
+}; // class bgzf_block_codec
+#else
+class bgzf_block_codec {
+  public:
+    bgzf_block_codec(const bool _is_input, const int level) : is_input(_is_input) {
+	std::memset(&strm, 0, sizeof(strm));
+	const int ret = (is_input ? inflateInit2(&strm, -15)
+			 : deflateInit2(&strm, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY));
+	if (ret != Z_OK) throw zException(strm.msg ? strm.msg : "invalid parameters", ret);
+    }
+    ~bgzf_block_codec() {
+	if (is_input) inflateEnd(&strm); else deflateEnd(&strm);
+    }
+    bgzf_block_codec(const bgzf_block_codec &) = delete;
+    bgzf_block_codec & operator = (const bgzf_block_codec &) = delete;
+
+    void inflate_block(const uint8_t* block, const size_t size, const size_t header,
+		       uint8_t* out, const size_t isize, const bool verify) {
+	inflateReset(&strm);
+	strm.next_in = const_cast<uint8_t*>(block + header);
+	strm.avail_in = (uInt)(size - header - 8);
+	strm.next_out = out;
+	strm.avail_out = (uInt)isize;
+	const int ret = inflate(&strm, Z_FINISH);
+	if (ret != Z_STREAM_END || strm.avail_out != 0)
+	    throw zException(strm.msg ? strm.msg : "bgzf: corrupt block", ret == Z_STREAM_END ? Z_DATA_ERROR : ret);
+	if (verify && crc32(out, isize) != load32(block + size - 8))
+	    throw bgzfException("incorrect data check");
+    }
+    size_t deflate_block(const uint8_t* in, const size_t n, uint8_t* out, const size_t capacity) {
+	deflateReset(&strm);
+	strm.next_in = const_cast<uint8_t*>(in);
+	strm.avail_in = (uInt)n;
+	strm.next_out = out;
+	strm.avail_out = (uInt)capacity;
+	if (deflate(&strm, Z_FINISH) != Z_STREAM_END) return 0;
+	return capacity - strm.avail_out;
+    }
+    static uint32_t crc32(const uint8_t* in, const size_t n) { return (uint32_t)::crc32(0, in, (uInt)n); }
+    // estimates from the zlib documentation
+    std::size_t memory_usage() const {
+	return is_input ? ((std::size_t)1 << 15) + 7160 : ((std::size_t)1 << 17) + ((std::size_t)1 << 17) + 6144;
+    }
+
+  private:
+    bool is_input;
+    z_stream strm;
+
+    static uint32_t load32(const uint8_t* p) {
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+}; // class bgzf_block_codec
+#endif
+
+// BGZF (the blocked gzip of htslib/samtools): a series of gzip members
+// of at most 64 KiB that store their compressed size in the BC extra
+// field. Since the size of each member is known from its header, whole
+// members are decoded in one call instead of streaming them through
+// inflate(), directly from the input and into the output buffer when
+// they fit there. The compressor writes blocks of 0xff00 input bytes,
+// ends one early on flush, and writes the empty BGZF end-of-file block
+// on finish. A gzip member without the BC field, such as a plain gzip
+// member appended to a BGZF file, is decoded with z_stream_wrapper to
+// its end. Takes the zlib flush values of bxz::z.
+class bgzf_stream_wrapper final : public stream_wrapper {
+  public:
+    bgzf_stream_wrapper(const bool _is_input = true, const int _level = Z_DEFAULT_COMPRESSION)
+	    : bgzf_stream_wrapper(_is_input, params(_level)) {}
+    bgzf_stream_wrapper(const bool _is_input, const params &p)
+	    : is_input(_is_input), verify(p.verify_checksums), finished(false), ended(false),
+	      nextIn(nullptr), availIn(0), nextOut(nullptr), availOut(0),
+	      prm(p), codec(_is_input, p.level), pending_pos(0) {
+	if (is_input) {
+	    member.reserve(max_block_size);
+	} else {
+	    block.reserve(block_input_size);
+	}
+    }
+
+    int decompress(const int _flags = Z_NO_FLUSH) override {
+	while (!plain && drain() && !finished && availIn > 0) {
+	    // fast path: the whole member is in the input buffer
+	    if (member.empty()) {
+		if (plain_member(nextIn, availIn)) {
+		    plain.reset(new z_stream_wrapper(true, prm));
+		    break;
+		}
+		const size_t size = block_size(nextIn, availIn);
+		if (size > 0 && availIn >= size) {
+		    decode(nextIn, size);
+		    consume(size);
+		    continue;
+		}
+	    }
+	    size_t want = block_size(member.data(), member.size());
+	    if (want == 0) want = header_size(member.data(), member.size());
+	    const size_t n = (want - member.size() < availIn ? want - member.size() : availIn);
+	    member.insert(member.end(), nextIn, nextIn + n);
+	    consume(n);
+	    if (plain_member(member.data(), member.size())) {
+		plain.reset(new z_stream_wrapper(true, prm));
+		break;
+	    }
+	    if (member.size() == want && block_size(member.data(), member.size()) == want) {
+		decode(member.data(), want);
+		member.clear();
+	    }
+	}
+	if (plain) inflate_plain(_flags);
+	return finished ? Z_STREAM_END : Z_OK;
+    }
+    int compress(const int _flags = Z_NO_FLUSH) override {
+	if (!drain()) return Z_OK;
+	while (availIn > 0) {
+	    const size_t n = (block_input_size - block.size() < availIn ? block_input_size - block.size() : availIn);
+	    block.insert(block.end(), nextIn, nextIn + n);
+	    nextIn += n;
+	    availIn -= n;
+	    if (block.size() == block_input_size) {
+		encode();
+		if (!drain()) return Z_OK;
+	    }
+	}
+	if (_flags != Z_NO_FLUSH && !block.empty()) {
+	    encode();
+	    if (!drain()) return Z_OK;
+	}
+	if (_flags == Z_FINISH && !ended) {
+	    // the empty block that ends BGZF files
+	    static const uint8_t eof_block[28] = { 0x1F, 0x8B, Z_DEFLATED, 0x04, 0, 0, 0, 0, 0, 0xFF, 6, 0, 'B', 'C', 2, 0,
+						   27, 0, 0x03, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+	    pending.assign(eof_block, eof_block + sizeof(eof_block));
+	    pending_pos = 0;
+	    ended = true;
+	    if (!drain()) return Z_OK;
+	}
+	finished = ended;
+	return finished ? Z_STREAM_END : Z_OK;
+    }
+    // The decoder ends the stream after the empty end-of-file block,
+    // and bxz::istreambuf starts a new one if more data follows.
+    bool stream_end() const override { return finished; }
+    bool done() const override { return stream_end(); }
+    std::size_t memory_usage() const override {
+	return 2*max_block_size + codec.memory_usage() + (plain ? plain->memory_usage() : 0);
+    }
+
+    const uint8_t* next_in() const override { return nextIn; }
+    long avail_in() const override { return availIn; }
+    uint8_t* next_out() const override { return nextOut; }
+    long avail_out() const override { return availOut; }
+
+    void set_next_in(const unsigned char* in) override { nextIn = in; }
+    void set_avail_in(long in) override { availIn = (size_t)in; }
+    void set_next_out(const uint8_t* in) override { nextOut = const_cast<uint8_t*>(in); }
+    void set_avail_out(long in) override { availOut = (size_t)in; }
+
+    // Size of a BGZF block and of the input in one block (BGZF_BLOCK_SIZE in htslib)
+    static const size_t max_block_size = (size_t)1 << 16;
+    static const size_t block_input_size = 0xff00;
+
+    // Returns the size of the BGZF block that starts with the `n` bytes
+    // at `p`, or 0 if they do not cover its header yet.
+    static size_t block_size(const uint8_t* p, const size_t n) {
+	if (n < 12) return 0;
+	if (p[0] != 0x1F || p[1] != 0x8B || p[2] != Z_DEFLATED || !(p[3] & 0x04))
+	    throw bgzfException("not a BGZF block");
+	const size_t header = header_size(p, n);
+	if (n < header) return 0;
+	for (size_t i = 12; i + 4 <= header; ) {
+	    const size_t len = (size_t)p[i + 2] | ((size_t)p[i + 3] << 8);
+	    if (i + 4 + len > header) break;
+	    if (p[i] == 'B' && p[i + 1] == 'C' && len == 2) {
+		const size_t size = ((size_t)p[i + 4] | ((size_t)p[i + 5] << 8)) + 1;
+		if (size < header + 8) break;
+		return size;
+	    }
+	    i += 4 + len;
+	}
+	throw bgzfException("gzip member without a BGZF block size");
+    }
+
+  private:
+    bool is_input;
+    bool verify;
+    bool finished;
+    bool ended;
+
+    const uint8_t* nextIn;
+    size_t availIn;
+    uint8_t* nextOut;
+    size_t availOut;
+
+    params prm;
+    bgzf_block_codec codec;
+    // Decodes the gzip member without the BC field that the stream ends with
+    std::unique_ptr<z_stream_wrapper> plain;
+    // Decoder: a member split between input buffers. Encoder: the input of the current block.
+    std::vector<uint8_t> member;
+    std::vector<uint8_t> block;
+    // Output that did not fit in the caller's buffer
+    std::vector<uint8_t> pending;
+    size_t pending_pos;
+
+    // gzip header with the BC extra field, without BSIZE
+    static size_t header_size(const uint8_t* p, const size_t n) {
+	return (n < 12 ? 12 : 12 + ((size_t)p[10] | ((size_t)p[11] << 8)));
+    }
+    static uint32_t load32(const uint8_t* p) {
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+    // True if the `n` bytes at `p` start a gzip member that has no
+    // BC extra field. Needs the whole header if there are extra fields.
+    static bool plain_member(const uint8_t* p, const size_t n) {
+	if (n < 12 || p[0] != 0x1F || p[1] != 0x8B || p[2] != Z_DEFLATED) return false;
+	if (!(p[3] & 0x04)) return true;
+	const size_t header = header_size(p, n);
+	if (n < header) return false;
+	for (size_t i = 12; i + 4 <= header; ) {
+	    const size_t len = (size_t)p[i + 2] | ((size_t)p[i + 3] << 8);
+	    if (i + 4 + len > header) break;
+	    if (p[i] == 'B' && p[i + 1] == 'C' && len == 2) return false;
+	    i += 4 + len;
+	}
+	return true;
+    }
+    // Runs `plain` on the buffered start of the member, then on the input.
+    void inflate_plain(const int flags) {
+	if (availOut == 0) return;
+	plain->set_next_out(nextOut);
+	plain->set_avail_out(availOut);
+	if (!member.empty()) {
+	    plain->set_next_in(member.data());
+	    plain->set_avail_in(member.size());
+	    plain->decompress(flags);
+	    member.erase(member.begin(), member.end() - plain->avail_in());
+	}
+	if (member.empty() && availIn > 0 && !plain->stream_end() && plain->avail_out() > 0) {
+	    plain->set_next_in(nextIn);
+	    plain->set_avail_in(availIn);
+	    plain->decompress(flags);
+	    nextIn = plain->next_in();
+	    availIn = plain->avail_in();
+	}
+	nextOut = plain->next_out();
+	availOut = plain->avail_out();
+	finished = plain->stream_end();
+    }
+    static void store16(uint8_t* p, const size_t v) {
+	p[0] = (uint8_t)(v & 0xFF);
+	p[1] = (uint8_t)((v >> 8) & 0xFF);
+    }
+    static void store32(uint8_t* p, const uint32_t v) {
+	store16(p, v & 0xFFFF);
+	store16(p + 2, v >> 16);
+    }
+    void consume(const size_t n) {
+	nextIn += n;
+	availIn -= n;
+    }
+    void produce(const size_t n) {
+	nextOut += n;
+	availOut -= n;
+    }
+    // Copies pending output to the output buffer. Returns true when
+    // nothing is pending.
+    bool drain() {
+	if (pending.empty()) return true;
+	size_t n = pending.size() - pending_pos;
+	if (n > availOut) n = availOut;
+	std::memcpy(nextOut, pending.data() + pending_pos, n);
+	produce(n);
+	pending_pos += n;
+	if (pending_pos < pending.size()) return false;
+	pending.clear();
+	pending_pos = 0;
+	return true;
+    }
+    void decode(const uint8_t* p, const size_t size) {
+	const size_t isize = load32(p + size - 4);
+	if (isize > max_block_size) throw bgzfException("block is larger than 64 KiB");
+	if (isize == 0) {
+	    // end-of-file marker, or an empty block
+	    finished = true;
+	    return;
+	}
+	uint8_t* out = nextOut;
+	if (availOut < isize) {
+	    pending.resize(isize);
+	    pending_pos = 0;
+	    out = pending.data();
+	}
+	codec.inflate_block(p, size, header_size(p, size), out, isize, verify);
+	if (out == nextOut) produce(isize);
+	else drain();
+    }
+    void encode() {
+	uint8_t* out = nextOut;
+	if (availOut < max_block_size) {
+	    pending.resize(max_block_size);
+	    pending_pos = 0;
+	    out = pending.data();
+	}
+	static const uint8_t header[16] = { 0x1F, 0x8B, Z_DEFLATED, 0x04, 0, 0, 0, 0, 0, 0xFF, 6, 0, 'B', 'C', 2, 0 };
+	std::memcpy(out, header, sizeof(header));
+	const size_t n = codec.deflate_block(block.data(), block.size(), out + 18, max_block_size - 18 - 8);
+	if (n == 0) throw bgzfException("compressed block does not fit in 64 KiB");
+	store16(out + 16, 18 + n + 8 - 1);
+	store32(out + 18 + n, codec.crc32(block.data(), block.size()));
+	store32(out + 18 + n + 4, (uint32_t)block.size());
+	block.clear();
+	if (out == nextOut) {
+	    produce(18 + n + 8);
+	} else {
+	    pending.resize(18 + n + 8);
+	    drain();
+	}
+    }
+}; // class bgzf_stream_wrapper
+} // namespace detail
+} // namespace bxz
+
+#endif
+#endif
@@ -0,0 +1,137 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#if defined(BXZSTR_BROTLI_SUPPORT) && (BXZSTR_BROTLI_SUPPORT) == 1
+
+#ifndef BXZSTR_BROTLI_STREAM_WRAPPER_HPP
+#define BXZSTR_BROTLI_STREAM_WRAPPER_HPP
+
+#include <brotli/decode.h>
+#include <brotli/encode.h>
+
+#include <string>
+#include <exception>
+
+#include "stream_wrapper.hpp"
+#include "params.hpp"
+
+namespace bxz {
+/// Exception class thrown by failed brotli operations.
+class brotliException : public std::exception {
+  public:
+    brotliException(const BrotliDecoderErrorCode err) : msg("brotli error: ") {
+	this->msg += "[" + std::to_string((int)err) + "]: ";
+        this->msg += BrotliDecoderErrorString(err);
+    }
+    brotliException(const std::string _msg) : msg(_msg) {}
+
+    const char * what() const noexcept { return this->msg.c_str(); }
+
+  private:
+    std::string msg;
+
+}; // class brotliException
+
+namespace detail {
+// Brotli streams have no magic bytes, so bxz::brotli is only used when
+// it is passed explicitly or read from a file ending in ".br".
+class brotli_stream_wrapper final : public stream_wrapper {
+  public:
+    brotli_stream_wrapper(const bool _isInput = true, const int level = BROTLI_DEFAULT_QUALITY)
+	    : brotli_stream_wrapper(_isInput, params(level)) {}
+    brotli_stream_wrapper(const bool _isInput, const params &p)
+	    : isInput(_isInput), finished(false), level(p.level),
+	      window_log(p.brotli_window_log > 0 ? p.brotli_window_log : BROTLI_DEFAULT_WINDOW),
+	      nextIn(nullptr), availIn(0), nextOut(nullptr), availOut(0),
+	      dstate(nullptr), estate(nullptr) {
+	if (this->isInput) {
+	    this->dstate = BrotliDecoderCreateInstance(NULL, NULL, NULL);
+	    if (this->dstate == NULL) throw brotliException("BrotliDecoderCreateInstance() failed!");
+	} else {
+	    // BrotliEncoderSetParameter() clamps values that are out of range
+	    if (p.level < BROTLI_MIN_QUALITY || p.level > BROTLI_MAX_QUALITY)
+		throw brotliException("brotli error: invalid quality " + std::to_string(p.level));
+	    if (this->window_log < BROTLI_MIN_WINDOW_BITS || this->window_log > BROTLI_MAX_WINDOW_BITS)
+		throw brotliException("brotli error: invalid window size " + std::to_string(this->window_log));
+	    this->estate = BrotliEncoderCreateInstance(NULL, NULL, NULL);
+	    if (this->estate == NULL) throw brotliException("BrotliEncoderCreateInstance() failed!");
+	    this->set_parameter(BROTLI_PARAM_QUALITY, p.level);
+	    this->set_parameter(BROTLI_PARAM_LGWIN, this->window_log);
+	    this->set_parameter(BROTLI_PARAM_MODE, p.brotli_mode);
+	}
+    }
+
+    ~brotli_stream_wrapper() {
+	if (this->isInput) {
+	    BrotliDecoderDestroyInstance(this->dstate);
+	} else {
+	    BrotliEncoderDestroyInstance(this->estate);
+	}
+    }
+
+    int decompress(const int = 0) override {
+	const BrotliDecoderResult ret = BrotliDecoderDecompressStream(this->dstate, &this->availIn, &this->nextIn,
+								      &this->availOut, &this->nextOut, NULL);
+	if (ret == BROTLI_DECODER_RESULT_ERROR) throw brotliException(BrotliDecoderGetErrorCode(this->dstate));
+	this->finished = (ret == BROTLI_DECODER_RESULT_SUCCESS);
+	return (int)ret;
+    }
+
+    int compress(const int op) override {
+	if (!BrotliEncoderCompressStream(this->estate, (BrotliEncoderOperation)op, &this->availIn, &this->nextIn,
+					 &this->availOut, &this->nextOut, NULL))
+	    throw brotliException("BrotliEncoderCompressStream() failed!");
+	this->finished = BrotliEncoderIsFinished(this->estate);
+	return (int)this->finished;
+    }
+
+    bool stream_end() const override { return this->finished; }
+    bool done() const override { return this->stream_end(); }
+    std::size_t memory_usage() const override {
+	// Rough estimates: the decoder keeps a window of up to 16 MiB, and
+	// the encoder a ring buffer and hash tables that grow with the
+	// window and quality.
+	if (this->isInput) return (std::size_t)1 << BROTLI_MAX_WINDOW_BITS;
+	return (this->level < 10 ? 3 : 8)*((std::size_t)1 << this->window_log);
+    }
+
+    const unsigned char* next_in() const override { return this->nextIn; }
+    long avail_in() const override { return this->availIn; }
+    unsigned char* next_out() const override { return this->nextOut; }
+    long avail_out() const override { return this->availOut; }
+
+    void set_next_in(const unsigned char* in) override { this->nextIn = in; }
+    void set_avail_in(long in) override { this->availIn = (size_t)in; }
+    void set_next_out(const unsigned char* in) override { this->nextOut = const_cast<unsigned char*>(in); }
+    void set_avail_out(long in) override { this->availOut = (size_t)in; }
+
+  private:
+    bool isInput;
+    bool finished;
+    int level;
+    int window_log;
+
+    const uint8_t* nextIn;
+    size_t availIn;
+    uint8_t* nextOut;
+    size_t availOut;
+
+    BrotliDecoderState* dstate;
+    BrotliEncoderState* estate;
+
+    void set_parameter(const BrotliEncoderParameter param, const int value) {
+	if (!BrotliEncoderSetParameter(this->estate, param, (uint32_t)value))
+	    throw brotliException("brotli error: invalid value " + std::to_string(value)
+				  + " for parameter " + std::to_string((int)param));
+    }
+
+}; // class brotli_stream_wrapper
+} // namespace detail
+} // namespace bxz
+
+#endif
+#endif
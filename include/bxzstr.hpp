@@ -15,58 +15,147 @@
 #include <fstream>
 #include <memory>
 #include <stdexcept>
+#include <algorithm>
+#include <vector>
+#include <chrono>
 
 #include "stream_wrapper.hpp"
 #include "strict_fstream.hpp"
+#include "params.hpp"
+#include "memory.hpp"
+#include "stream_stats.hpp"
 #include "compression_types.hpp"
+#include "content_size.hpp"
+#include "mapped_file.hpp"
+#include "one_shot.hpp"
+#include "batch.hpp"
+#include "chunk.hpp"
+#include "line_reader.hpp"
+#include "z_inflate_back.hpp"
+#include "rsyncable.hpp"
+#include "adaptive_level.hpp"
+#include "probes.hpp"
 
 namespace bxz {
-class istreambuf : public std::streambuf {
+// Decompressing stream buffer. `Codec` is detail::stream_wrapper for
+// the type-erased buffer that detects the format at runtime (see
+// bxz::istreambuf), or one of the concrete stream wrappers when the
+// format is known at compile time (see bxz::zstd_istreambuf, ...).
+template <typename Codec>
+class basic_istreambuf : public std::streambuf {
   public:
-    istreambuf(std::streambuf * _sbuf_p, std::size_t _buff_size = default_buff_size,
-	       bool _auto_detect = true)
+    basic_istreambuf(std::streambuf * _sbuf_p, std::size_t _buff_size = default_buff_size,
+		     bool _auto_detect = true)
+            : basic_istreambuf(_sbuf_p, params(), _buff_size, _auto_detect) {}
+    basic_istreambuf(std::streambuf * _sbuf_p, const params &_prm,
+		     std::size_t _buff_size = default_buff_size, bool _auto_detect = true)
             : sbuf_p(_sbuf_p),
 	      strm_p(nullptr),
 	      buff_size(_buff_size),
-	      auto_detect(_auto_detect),
-	      auto_detect_run(false) {
+	      auto_detect(_auto_detect && detail::codec_traits<Codec>::auto_detect()),
+	      auto_detect_run(false),
+	      initial_read_size(_buff_size < default_initial_read_size ? _buff_size : default_initial_read_size),
+	      read_size(initial_read_size),
+	      type(detail::codec_traits<Codec>::type(none)),
+	      prm(_prm),
+	      content_size_read(false),
+	      content_size_value(-1) {
         assert(sbuf_p);
+        reservation.reserve(2*buff_size);
         in_buff = new char [buff_size];
         in_buff_start = in_buff;
         in_buff_end = in_buff;
         out_buff = new char [buff_size];
         setg(out_buff, out_buff, out_buff);
+        if (prm.collect_stats || prm.on_stats) stats_p.reset(new detail::stats_collector(prm.on_stats));
+        BXZSTR_PROBE3(buffer_alloc, this, (int)this->type, 2*buff_size);
     }
-    istreambuf(std::streambuf * _sbuf_p, Compression type, std::size_t _buff_size = default_buff_size)
+    basic_istreambuf(std::streambuf * _sbuf_p, Compression type,
+		     std::size_t _buff_size = default_buff_size)
+            : basic_istreambuf(_sbuf_p, type, params(), _buff_size) {}
+    basic_istreambuf(std::streambuf * _sbuf_p, Compression type, const params &_prm,
+		     std::size_t _buff_size = default_buff_size)
             : sbuf_p(_sbuf_p),
 	      strm_p(nullptr),
 	      buff_size(_buff_size),
 	      auto_detect(false),
 	      auto_detect_run(false),
-        type(type) {
+	      initial_read_size(_buff_size < default_initial_read_size ? _buff_size : default_initial_read_size),
+	      read_size(initial_read_size),
+	      type(detail::codec_traits<Codec>::type(type)),
+	      prm(_prm),
+	      content_size_read(false),
+	      content_size_value(-1) {
         assert(sbuf_p);
+        reservation.reserve(2*buff_size);
         in_buff = new char [buff_size];
         in_buff_start = in_buff;
         in_buff_end = in_buff;
         out_buff = new char [buff_size];
         setg(out_buff, out_buff, out_buff);
+        if (prm.collect_stats || prm.on_stats) stats_p.reset(new detail::stats_collector(prm.on_stats));
+        BXZSTR_PROBE3(buffer_alloc, this, (int)this->type, 2*buff_size);
     }
-    istreambuf(const istreambuf &) = delete;
-    istreambuf(istreambuf &&) = default;
-    istreambuf & operator = (const istreambuf &) = delete;
-    istreambuf & operator = (istreambuf &&) = default;
-    virtual ~istreambuf() {
+    basic_istreambuf(const basic_istreambuf &) = delete;
+    basic_istreambuf(basic_istreambuf &&) = default;
+    basic_istreambuf & operator = (const basic_istreambuf &) = delete;
+    basic_istreambuf & operator = (basic_istreambuf &&) = default;
+    virtual ~basic_istreambuf() {
         delete [] in_buff;
         delete [] out_buff;
     }
 
+    // Reads start at `_initial_read_size` bytes and double on every
+    // underflow() until they reach the buffer size. Small first reads
+    // let callers that only peek at the start of a file see data
+    // without waiting for a full buffer to be read and decompressed.
+    void set_initial_read_size(std::size_t _initial_read_size) {
+        initial_read_size = std::max((std::size_t)1, std::min(_initial_read_size, buff_size));
+        read_size = initial_read_size;
+    }
+
+    // Bytes used by the buffers and the decompressor.
+    std::size_t memory_usage() const {
+        return 2*buff_size + (strm_p ? strm_p->memory_usage() : 0);
+    }
+    // Counters collected with params::collect_stats, zero otherwise.
+    stream_stats stats() const { return stats_p ? stats_p->stats : stream_stats(); }
+
+    // Uncompressed size of the input read with bxz::stat() from the
+    // underlying stream buffer, or -1 if the size is not known exactly
+    // or the underlying stream buffer cannot seek.
+    std::streamoff content_size() {
+        if (!content_size_read) {
+            content_info info;
+            const Compression known_type = (auto_detect && !auto_detect_run ? none : this->type);
+            content_size_value = (detail::stat_streambuf(sbuf_p, known_type, &info) && info.size_exact
+                                  ? (std::streamoff)info.content_size : -1);
+            content_size_read = true;
+        }
+        return content_size_value;
+    }
+
+    // Returns the decompressed data buffered after the read position,
+    // decompressing more if there is none, and moves the read position
+    // past it, so that parsers can scan the output buffer in place. The
+    // chunk is empty at the end of the input.
+    chunk next_chunk() {
+        if (this->gptr() == this->egptr() && this->underflow() == traits_type::eof()) return chunk();
+        const chunk buffered(this->gptr(), this->egptr() - this->gptr());
+        this->setg(this->eback(), this->egptr(), this->egptr());
+        return buffered;
+    }
+
     virtual std::streampos seekoff(std::streamoff off, std::ios_base::seekdir way, std::ios_base::openmode which = std::ios_base::in | std::ios_base::out){
         std::streampos pos;
 
         if (way == std::ios_base::cur)
             pos = get_cursor() + off;
-        else if (way == std::ios_base::end)
-            throw std::runtime_error("Cannot seek from the end position on a compressed stream (the size is not known in advance).");
+        else if (way == std::ios_base::end) {
+            if (content_size() < 0)
+                throw std::runtime_error("Cannot seek from the end position on a compressed stream (the size is not known in advance).");
+            pos = content_size() + off;
+        }
         else if (way == std::ios_base::beg)
             pos = off;
         
@@ -82,7 +171,8 @@ class istreambuf : public std::streambuf {
         }
 
         while(pos != get_cursor()){
-            underflow();
+            if (underflow() == traits_type::eof() && pos > get_cursor())
+                return std::streampos(std::streamoff(-1)); // past the end of the input
             std::streamoff relOff = pos-get_cursor();
             if(relOff < 0) {              
                 if(eback() <= gptr()+relOff) { // if it is buffered just rewind to the position
@@ -101,16 +191,27 @@ class istreambuf : public std::streambuf {
 
     virtual std::streambuf::int_type underflow() {
         if (this->gptr() == this->egptr()) {
+            BXZSTR_PROBE2(underflow_entry, this, (int)this->type);
+            if (stats_p) stats_p->begin_call();
             // pointers for free region in output buffer
             char * out_buff_free_start = out_buff;
+            char * out_buff_free_end = out_buff + read_size;
             do {
                 // read more input if none available
                 if (in_buff_start == in_buff_end) {
                     // empty input buffer: refill from the start
                     in_buff_start = in_buff;
-                    std::streamsize sz = sbuf_p->sgetn(in_buff, buff_size);
+                    std::streamsize sz = sbuf_p->sgetn(in_buff, read_size);
+                    if (stats_p) {
+                        stats_p->io_done();
+                        stats_p->stats.compressed_bytes += sz;
+                    }
                     in_buff_end = in_buff + sz;
-                    if (in_buff_end == in_buff_start) break; // end of input
+                    // end of input, unless the codec filled the output on
+                    // the last call and may still hold some (e.g. brotli,
+                    // or a BGZF block without the end-of-file block after
+                    // it); decompress() is then called without input
+                    if (in_buff_end == in_buff_start && !(strm_p && strm_p->avail_out() == 0)) break;
                 }
                 // auto detect if the stream contains text or deflate data
                 if (auto_detect && ! auto_detect_run) {
@@ -126,27 +227,47 @@ class istreambuf : public std::streambuf {
                     in_buff_end = in_buff;
                 } else {
                     // run inflate() on input
-		    if (! strm_p) init_stream(this->type, true, &strm_p);
+		    if (! strm_p) {
+			detail::codec_traits<Codec>::init(this->type, true, this->prm, &strm_p);
+			reservation.update(this->memory_usage());
+			if (stats_p) stats_p->add_memory(this->memory_usage());
+		    }
 		    strm_p->set_next_in(reinterpret_cast< decltype(strm_p->next_in()) >(in_buff_start));
 		    strm_p->set_avail_in(in_buff_end - in_buff_start);
 		    strm_p->set_next_out(reinterpret_cast< decltype(strm_p->next_out()) >(out_buff_free_start));
-		    strm_p->set_avail_out((out_buff + buff_size) - out_buff_free_start);
+		    strm_p->set_avail_out(out_buff_free_end - out_buff_free_start);
+		    BXZSTR_PROBE3(decompress_begin, this, (int)this->type, in_buff_end - in_buff_start);
 		    strm_p->decompress();
+		    if (stats_p) stats_p->codec_done();
+		    BXZSTR_PROBE4(decompress_end, this, (int)this->type,
+				  strm_p->avail_in(),
+				  reinterpret_cast< char* >(strm_p->next_out()) - out_buff_free_start);
                     // update in&out pointers following inflate()
 		    auto tmp = const_cast< unsigned char* >(strm_p->next_in()); // cast away const qualifiers
                     in_buff_start = reinterpret_cast< decltype(in_buff_start) >(tmp);
                     in_buff_end = in_buff_start + strm_p->avail_in();
                     out_buff_free_start = reinterpret_cast< decltype(out_buff_free_start) >(strm_p->next_out());
-                    assert(out_buff_free_start + strm_p->avail_out() == out_buff + buff_size);
+                    assert(out_buff_free_start + strm_p->avail_out() == out_buff_free_end);
                     // if stream ended, deallocate inflator
-                    if (strm_p->stream_end()) strm_p.reset();
+                    if (strm_p->stream_end()) {
+                        BXZSTR_PROBE3(stream_end, this, (int)this->type, 1);
+                        if (stats_p) ++stats_p->stats.streams;
+                        strm_p.reset();
+                    }
                 }
             } while (out_buff_free_start == out_buff);
             // 2 exit conditions:
             // - end of input: there might or might not be output available
             // - out_buff_free_start != out_buff: output available
             out_buff_end_abs += out_buff_free_start-out_buff;
+            if (stats_p) {
+                stats_p->stats.uncompressed_bytes += out_buff_free_start-out_buff;
+                stats_p->end_call(this->memory_usage(), out_buff_free_start != out_buff);
+            }
+            BXZSTR_PROBE3(underflow_return, this, (int)this->type, out_buff_free_start - out_buff);
             this->setg(out_buff, out_buff, out_buff_free_start);
+            // grow the next read towards buff_size
+            read_size = std::min(read_size*2, buff_size);
         }
         return this->gptr() == this->egptr()
 	    ? traits_type::eof() : traits_type::to_int_type(*this->gptr());
@@ -158,11 +279,13 @@ class istreambuf : public std::streambuf {
     }
 
     void seek_to_zero(){
+        BXZSTR_PROBE2(seek_to_zero, this, (int)this->type);
         in_buff_start = in_buff;
         in_buff_end = in_buff;
         setg(out_buff, out_buff, out_buff);
         if(sbuf_p->pubseekpos(0) != 0) throw std::runtime_error("could not seek underlying stream.");
         out_buff_end_abs = 0;
+        read_size = initial_read_size;
         strm_p.reset(); // new one will be created on underflow
     }
 
@@ -171,42 +294,100 @@ class istreambuf : public std::streambuf {
     char* in_buff_start;
     char* in_buff_end;
     char* out_buff;
-    std::unique_ptr<detail::stream_wrapper> strm_p;
+    std::unique_ptr<Codec> strm_p;
     std::size_t buff_size;
     bool auto_detect;
     bool auto_detect_run;
+    std::size_t initial_read_size;
+    std::size_t read_size;
     Compression type;
+    params prm;
     std::streampos out_buff_end_abs;
+    detail::memory_reservation reservation;
+    std::unique_ptr<detail::stats_collector> stats_p;
+    bool content_size_read;
+    std::streamoff content_size_value;
 
     static const std::size_t default_buff_size = (std::size_t)1 << 20;
-}; // class istreambuf
+    static const std::size_t default_initial_read_size = (std::size_t)1 << 14;
+}; // class basic_istreambuf
+
+typedef basic_istreambuf<detail::stream_wrapper> istreambuf;
 
-class ostreambuf : public std::streambuf {
+// Compressing stream buffer, see basic_istreambuf for `Codec`. The
+// constructors without a Compression type write gzip when `Codec` is
+// the type-erased detail::stream_wrapper.
+template <typename Codec>
+class basic_ostreambuf : public std::streambuf {
   public:
-    ostreambuf(std::streambuf * _sbuf_p, Compression type, int _level = 6,
-               std::size_t _buff_size = default_buff_size)
+    basic_ostreambuf(std::streambuf * _sbuf_p, int _level = 6,
+		     std::size_t _buff_size = default_buff_size)
+            : basic_ostreambuf(_sbuf_p, z, params(_level), _buff_size) {}
+    basic_ostreambuf(std::streambuf * _sbuf_p, const params &_prm,
+		     std::size_t _buff_size = default_buff_size)
+            : basic_ostreambuf(_sbuf_p, z, _prm, _buff_size) {}
+    basic_ostreambuf(std::streambuf * _sbuf_p, Compression type, int _level = 6,
+		     std::size_t _buff_size = default_buff_size)
+            : basic_ostreambuf(_sbuf_p, type, params(_level), _buff_size) {}
+    basic_ostreambuf(std::streambuf * _sbuf_p, Compression type, int _level, FlushMode _flush,
+		     std::size_t _buff_size = default_buff_size)
+            : basic_ostreambuf(_sbuf_p, type, params(_level, _flush), _buff_size) {}
+    basic_ostreambuf(std::streambuf * _sbuf_p, Compression type, const params &_prm,
+		     std::size_t _buff_size = default_buff_size)
             : sbuf_p(_sbuf_p),
-              buff_size(_buff_size),
-              type(type),
-              level(_level) {
+              buff_size(_prm.flush == low_latency && _buff_size > low_latency_buff_size
+			? low_latency_buff_size : _buff_size),
+              type(detail::codec_traits<Codec>::type(type)),
+              run_action(bxz_run(this->type)),
+              finish_action(bxz_finish(this->type)),
+              flush_action(bxz_flush(this->type)),
+              rsync_action(_prm.rsyncable ? bxz_rsync(this->type, _prm) : -1),
+              prm(_prm) {
         assert(sbuf_p);
+        if (rsync_action >= 0) {
+            rsync.reset(new detail::rsync_boundaries(rsync_action == finish_action
+                                                     ? detail::rsync_frame_mask : detail::rsync_flush_mask));
+        }
+        if (prm.collect_stats || prm.on_stats) stats_p.reset(new detail::stats_collector(prm.on_stats));
+        const int max_level = (_prm.adaptive_level ? bxz_max_level(this->type) : 0);
+        if (max_level > 0) {
+            adapt.reset(new detail::adaptive_level(_prm.level, _prm.adaptive_min_level,
+                                                   _prm.adaptive_max_level > 0 ? std::min(_prm.adaptive_max_level, max_level) : max_level));
+            prm.level = adapt->level();
+        }
+        reservation.reserve(2*buff_size);
         in_buff = new char [buff_size];
         out_buff = new char [buff_size];
         setp(in_buff, in_buff + buff_size);
-	init_stream(this->type, false, this->level, &strm_p);
+	detail::codec_traits<Codec>::init(this->type, false, this->prm, &strm_p);
+        reservation.update(this->memory_usage());
+        if (stats_p) stats_p->add_memory(this->memory_usage());
+        BXZSTR_PROBE3(buffer_alloc, this, (int)this->type, 2*buff_size);
     }
-    ostreambuf(const ostreambuf &) = delete;
-    ostreambuf(ostreambuf &&) = default;
-    ostreambuf & operator = (const ostreambuf &) = delete;
-    ostreambuf & operator = (ostreambuf &&) = default;
+    basic_ostreambuf(const basic_ostreambuf &) = delete;
+    basic_ostreambuf(basic_ostreambuf &&) = default;
+    basic_ostreambuf & operator = (const basic_ostreambuf &) = delete;
+    basic_ostreambuf & operator = (basic_ostreambuf &&) = default;
 
     int deflate_loop(const int action) {
         while (true) {
             strm_p->set_next_out(reinterpret_cast< decltype(strm_p->next_out()) >(out_buff));
             strm_p->set_avail_out(buff_size);
+            std::chrono::steady_clock::time_point start, compressed;
+            BXZSTR_PROBE3(compress_begin, this, (int)this->type, strm_p->avail_in());
+            if (adapt) start = std::chrono::steady_clock::now();
 	    strm_p->compress(action);
+            if (adapt) compressed = std::chrono::steady_clock::now();
+            if (stats_p) stats_p->codec_done();
+            BXZSTR_PROBE4(compress_end, this, (int)this->type, strm_p->avail_in(),
+                          reinterpret_cast< decltype(out_buff) >(strm_p->next_out()) - out_buff);
 
             std::streamsize sz = sbuf_p->sputn(out_buff, reinterpret_cast< decltype(out_buff) >(strm_p->next_out()) - out_buff);
+            if (adapt) adapt->record(compressed - start, std::chrono::steady_clock::now() - compressed);
+            if (stats_p) {
+                stats_p->io_done();
+                stats_p->stats.compressed_bytes += sz;
+            }
             if (sz != reinterpret_cast< decltype(out_buff) >(strm_p->next_out()) - out_buff) {
                 // there was an error in the sink stream
                 return -1;
@@ -216,55 +397,156 @@ class ostreambuf : public std::streambuf {
         return 0;
     }
 
-    virtual ~ostreambuf() {
-        // flush the lzma stream
+    virtual ~basic_ostreambuf() {
+        // finish the compressed stream
         //
-        // NOTE: Errors here (sync() return value not 0) are ignored, because we
+        // NOTE: Errors here (close() return value not 0) are ignored, because we
         // cannot throw in a destructor. This mirrors the behaviour of
         // std::basic_filebuf::~basic_filebuf(). To see an exception on error,
         // close the ofstream with an explicit call to close(), and do not rely
         // on the implicit call in the destructor.
         //
-        sync();
+        close();
         delete [] in_buff;
         delete [] out_buff;
     }
     virtual std::streambuf::int_type overflow(std::streambuf::int_type c = traits_type::eof()) {
-        strm_p->set_next_in(reinterpret_cast< decltype(strm_p->next_in()) >(pbase()));
-        strm_p->set_avail_in(pptr() - pbase());
-        while (strm_p->avail_in() > 0) {
-            int r = deflate_loop(bxz_run(this->type));
+	if (! strm_p) detail::codec_traits<Codec>::init(this->type, false, this->prm, &strm_p);
+        BXZSTR_PROBE3(overflow_entry, this, (int)this->type, pptr() - pbase());
+        if (stats_p) {
+            stats_p->begin_call();
+            stats_p->stats.uncompressed_bytes += pptr() - pbase();
+        }
+        for (char *p = pbase(); p < pptr(); ) {
+            std::size_t n = pptr() - p;
+            const bool cut = (rsync && rsync->scan(reinterpret_cast<unsigned char*>(p), &n));
+            strm_p->set_next_in(reinterpret_cast< decltype(strm_p->next_in()) >(p));
+            strm_p->set_avail_in(n);
+            int r = 0;
+            while (r == 0 && strm_p->avail_in() > 0) r = deflate_loop(run_action);
+            if (r == 0 && cut) r = rsync_cut();
             if (r != 0) {
                 setp(nullptr, nullptr);
                 return traits_type::eof();
             }
+            p += n;
+        }
+        int level;
+        if (adapt && pptr() > pbase() && adapt->update(&level) && change_level(level) != 0) {
+            setp(nullptr, nullptr);
+            return traits_type::eof();
         }
+        if (stats_p) stats_p->end_call(this->memory_usage(), pptr() > pbase());
+        BXZSTR_PROBE2(overflow_return, this, (int)this->type);
         setp(in_buff, in_buff + buff_size);
         return traits_type::eq_int_type(c, traits_type::eof()) ? traits_type::eof() : sputc(c);
     }
     virtual int sync() {
+        BXZSTR_PROBE2(sync, this, (int)this->type);
+        if (this->prm.flush == finish_on_sync) {
+            // end the current stream and start a new one
+            if (close() != 0) return -1;
+	    detail::codec_traits<Codec>::init(this->type, false, this->prm, &strm_p);
+            return 0;
+        }
+        // first, call overflow to clear in_buff
+        overflow();
+        if (! pptr()) return -1;
+        // then, flush the pending output without ending the stream
+        strm_p->set_next_in(nullptr);
+        strm_p->set_avail_in(0);
+        if (deflate_loop(flush_action) != 0) return -1;
+        return sbuf_p->pubsync() == 0 ? 0 : -1;
+    }
+    // Current compression level, which changes with params::adaptive_level.
+    int level() const { return this->prm.level; }
+    // Counters collected with params::collect_stats, zero otherwise.
+    stream_stats stats() const { return stats_p ? stats_p->stats : stream_stats(); }
+    // Bytes used by the buffers and the compressor.
+    std::size_t memory_usage() const {
+        return 2*buff_size + (strm_p ? strm_p->memory_usage() : 0);
+    }
+    // Ends the compressed stream. Writing after close() starts a new
+    // stream (gzip member, zstd frame, ...).
+    int close() {
+        if (! strm_p) {
+            if (! (pptr() > pbase())) return 0;
+            // written after the last close()
+	    detail::codec_traits<Codec>::init(this->type, false, this->prm, &strm_p);
+        }
         // first, call overflow to clear in_buff
         overflow();
         if (! pptr()) return -1;
         // then, call deflate asking to finish the zlib stream
         strm_p->set_next_in(nullptr);
         strm_p->set_avail_in(0);
-        if (deflate_loop(bxz_finish(this->type)) != 0) return -1;
-	init_stream(this->type, false, this->level, &strm_p);
-        return 0;
+        int r = deflate_loop(finish_action);
+        strm_p.reset();
+        BXZSTR_PROBE3(stream_end, this, (int)this->type, 0);
+        if (stats_p) {
+            ++stats_p->stats.streams;
+            stats_p->end_call(this->memory_usage(), true);
+        }
+        return r;
     }
 
   private:
+    // Changes the level between blocks. The new level also applies to
+    // the streams started after this one. The old level is kept if the
+    // codec cannot change now.
+    int change_level(const int level) {
+        strm_p->set_next_in(nullptr);
+        strm_p->set_avail_in(0);
+        bool changed = false;
+        while (! changed) {
+            strm_p->set_next_out(reinterpret_cast< decltype(strm_p->next_out()) >(out_buff));
+            strm_p->set_avail_out(buff_size);
+            changed = strm_p->set_level(level);
+            const std::streamsize n = reinterpret_cast< decltype(out_buff) >(strm_p->next_out()) - out_buff;
+            if (sbuf_p->sputn(out_buff, n) != n) return -1;
+            if (n == 0) break; // no progress, keep the old level
+        }
+        if (changed) {
+            this->prm.level = level;
+            adapt->set_level(level);
+        }
+        return 0;
+    }
+    // Resets the compressor at a boundary of rsyncable output.
+    int rsync_cut() {
+        strm_p->set_next_in(nullptr);
+        strm_p->set_avail_in(0);
+        if (rsync_action != finish_action) return deflate_loop(rsync_action);
+        // end the frame and start a new one
+        int r = deflate_loop(finish_action);
+        BXZSTR_PROBE3(stream_end, this, (int)this->type, 0);
+        if (stats_p) ++stats_p->stats.streams;
+	detail::codec_traits<Codec>::init(this->type, false, this->prm, &strm_p);
+        return r;
+    }
+
     std::streambuf* sbuf_p;
     char* in_buff;
     char* out_buff;
-    std::unique_ptr<detail::stream_wrapper> strm_p;
+    std::unique_ptr<Codec> strm_p;
     std::size_t buff_size;
     Compression type;
-    int level;
+    // bxz_run/bxz_finish/bxz_flush for `type`, looked up once
+    int run_action;
+    int finish_action;
+    int flush_action;
+    int rsync_action;
+    std::unique_ptr<detail::rsync_boundaries> rsync;
+    std::unique_ptr<detail::adaptive_level> adapt;
+    params prm;
+    detail::memory_reservation reservation;
+    std::unique_ptr<detail::stats_collector> stats_p;
 
     static const std::size_t default_buff_size = (std::size_t)1 << 20;
-}; // class ostreambuf
+    static const std::size_t low_latency_buff_size = (std::size_t)1 << 14;
+}; // class basic_ostreambuf
+
+typedef basic_ostreambuf<detail::stream_wrapper> ostreambuf;
 
 class istream : public std::istream {
   public:
@@ -280,17 +562,41 @@ class istream : public std::istream {
     explicit istream(std::streambuf * sbuf_p, Compression type) : std::istream(new istreambuf(sbuf_p, type)) {
         exceptions(std::ios_base::badbit);
     }
+    istream(std::istream & is, const params &prm) : std::istream(new istreambuf(is.rdbuf(), prm)) {
+        exceptions(std::ios_base::badbit);
+    }
+    explicit istream(std::streambuf * sbuf_p, const params &prm) : std::istream(new istreambuf(sbuf_p, prm)) {
+        exceptions(std::ios_base::badbit);
+    }
+    istream(std::istream & is, Compression type, const params &prm)
+	    : std::istream(new istreambuf(is.rdbuf(), type, prm)) {
+        exceptions(std::ios_base::badbit);
+    }
+    explicit istream(std::streambuf * sbuf_p, Compression type, const params &prm)
+	    : std::istream(new istreambuf(sbuf_p, type, prm)) {
+        exceptions(std::ios_base::badbit);
+    }
     virtual ~istream() { delete rdbuf(); }
 }; // class istream
 
 class ostream : public std::ostream {
   public:
-    ostream(std::ostream & os, Compression type = plaintext, int level = 6)
-	    : std::ostream(new ostreambuf(os.rdbuf(), type, level)) {
+    ostream(std::ostream & os, Compression type = plaintext, int level = 6,
+	    FlushMode flush = finish_on_sync)
+	    : std::ostream(new ostreambuf(os.rdbuf(), type, level, flush)) {
+	exceptions(std::ios_base::badbit);
+    }
+    explicit ostream(std::streambuf * sbuf_p, Compression type = z, int level = 6,
+		     FlushMode flush = finish_on_sync)
+	    : std::ostream(new ostreambuf(sbuf_p, type, level, flush)) {
 	exceptions(std::ios_base::badbit);
     }
-    explicit ostream(std::streambuf * sbuf_p, Compression type = z, int level = 6)
-	    : std::ostream(new ostreambuf(sbuf_p, type, level)) {
+    ostream(std::ostream & os, Compression type, const params &prm)
+	    : std::ostream(new ostreambuf(os.rdbuf(), type, prm)) {
+	exceptions(std::ios_base::badbit);
+    }
+    explicit ostream(std::streambuf * sbuf_p, Compression type, const params &prm)
+	    : std::ostream(new ostreambuf(sbuf_p, type, prm)) {
 	exceptions(std::ios_base::badbit);
     }
     virtual ~ostream() {
@@ -313,84 +619,247 @@ class strict_fstream_holder {
 
 } // namespace detail
 
-class ifstream : public detail::strict_fstream_holder< strict_fstream::ifstream >,
-		 public std::istream {
+// File stream reading through basic_istreambuf<Codec>. The
+// Compression type is ignored for the concrete codecs.
+template <typename Codec>
+class basic_ifstream : public detail::strict_fstream_holder< strict_fstream::ifstream >,
+		       public std::istream {
   public:
-    ifstream(Compression type = none) : std::istream(type == none ?
-        new istreambuf(_fs.rdbuf()) : new istreambuf(_fs.rdbuf(), type)) {}
-    explicit ifstream(const std::string& filename,
-		      std::ios_base::openmode mode = std::ios_base::in, Compression type = none)
+    typedef basic_istreambuf<Codec> streambuf_type;
+
+    basic_ifstream(Compression type = none) : std::istream(type == none ?
+        new streambuf_type(_fs.rdbuf()) : new streambuf_type(_fs.rdbuf(), type)) {}
+    explicit basic_ifstream(const std::string& filename,
+			    std::ios_base::openmode mode = std::ios_base::in, Compression type = none)
+            : basic_ifstream(filename, params(), mode, type) {}
+    basic_ifstream(const std::string& filename, const params &prm,
+		   std::ios_base::openmode mode = std::ios_base::in, Compression type = none)
             : detail::strict_fstream_holder< strict_fstream::ifstream >(filename, mode),
-            std::istream(type == none ? new istreambuf(_fs.rdbuf()) : new istreambuf(_fs.rdbuf(), type)),
+            std::istream(make_streambuf(_fs.rdbuf(), type == none ? detect_type_from_extension(filename) : type, prm)),
 	    filename(filename),
 	    mode(mode),
-      type(type) {
+      type(type),
+	    prm(prm) {
         this->setstate(_fs.rdstate());
         exceptions(std::ios_base::badbit);
     }
-    ifstream(const ifstream& other) : ifstream(other.filename, other.mode, other.type) {}
-    virtual ~ifstream() { if (rdbuf()) delete rdbuf(); }
+    basic_ifstream(const basic_ifstream& other)
+            : basic_ifstream(other.filename, other.prm, other.mode, other.type) {}
+    virtual ~basic_ifstream() { if (rdbuf()) delete rdbuf(); }
 
 
+    // Reopens the stream with the params it was made with.
     void open(const std::string &filename,
 	      std::ios_base::openmode mode = std::ios_base::in, Compression type = none) {
-	this->~ifstream();
-	new (this) ifstream(filename, mode, type);
+	this->open(filename, this->prm, mode, type);
     }
     void open(const char* filename,
 	      std::ios_base::openmode mode = std::ios_base::in, Compression type = none) {
-	this->~ifstream();
-	new (this) ifstream(filename, mode, type);
+	this->open(std::string(filename), this->prm, mode, type);
+    }
+    void open(const std::string &filename, const params &prm,
+	      std::ios_base::openmode mode = std::ios_base::in, Compression type = none) {
+	// `prm` may be this->prm
+	const params reopen_prm(prm);
+	this->~basic_ifstream();
+	new (this) basic_ifstream(filename, reopen_prm, mode, type);
     }
     bool is_open() const { return _fs.is_open(); }
     void close() { _fs.close(); }
+    // Counters collected with params::collect_stats.
+    stream_stats stats() const { return static_cast<streambuf_type*>(rdbuf())->stats(); }
+    // See basic_istreambuf::next_chunk(). The stream state is not
+    // updated, and an empty chunk marks the end of the file.
+    chunk next_chunk() { return static_cast<streambuf_type*>(rdbuf())->next_chunk(); }
 
   private:
     std::string filename;
     std::ios_base::openmode mode;
     Compression type;
-}; // class ifstream
+    params prm;
 
-class ofstream : public detail::strict_fstream_holder< strict_fstream::ofstream >,
-		 public std::ostream {
+    // Formats without magic bytes (brotli) are taken from the file
+    // extension, the others are detected from the data.
+    static streambuf_type* make_streambuf(std::streambuf *sbuf_p, const Compression type, const params &prm) {
+	return type == none ? new streambuf_type(sbuf_p, prm) : new streambuf_type(sbuf_p, type, prm);
+    }
+}; // class basic_ifstream
+
+typedef basic_ifstream<detail::stream_wrapper> ifstream;
+
+// File stream writing through basic_ostreambuf<Codec>. The
+// Compression type is ignored for the concrete codecs.
+template <typename Codec>
+class basic_ofstream : public detail::strict_fstream_holder< strict_fstream::ofstream >,
+		       public std::ostream {
   public:
-    explicit ofstream(const std::string& filename,
-		      std::ios_base::openmode mode = std::ios_base::out,
-		      Compression type = z, int level = 6)
+    typedef basic_ostreambuf<Codec> streambuf_type;
+
+    explicit basic_ofstream(const std::string& filename,
+			    std::ios_base::openmode mode = std::ios_base::out,
+			    Compression type = z, int level = 6,
+			    FlushMode flush = finish_on_sync)
+              : basic_ofstream(filename, mode, type, params(level, flush)) {}
+    basic_ofstream(const std::string& filename, std::ios_base::openmode mode,
+		   Compression type, const params &prm)
             : detail::strict_fstream_holder< strict_fstream::ofstream >(filename, mode | std::ios_base::binary),
-            std::ostream(new ostreambuf(_fs.rdbuf(), type, level)),
+            std::ostream(new streambuf_type(_fs.rdbuf(), type, prm)),
             filename(filename),
             mode(mode),
-            level(level) {
+            type(type),
+            prm(prm) {
         exceptions(std::ios_base::badbit);
     }
-    explicit ofstream(const std::string& filename, Compression type, int level = 6)
-              : ofstream(filename, std::ios_base::out, type, level) {}
-    ofstream(const ofstream& other)
-            : ofstream(other.filename,
+    explicit basic_ofstream(const std::string& filename, Compression type, int level = 6,
+			    FlushMode flush = finish_on_sync)
+              : basic_ofstream(filename, std::ios_base::out, type, level, flush) {}
+    basic_ofstream(const std::string& filename, Compression type, const params &prm)
+              : basic_ofstream(filename, std::ios_base::out, type, prm) {}
+    basic_ofstream(const std::string& filename, const params &prm)
+              : basic_ofstream(filename, std::ios_base::out, z, prm) {}
+    basic_ofstream(const basic_ofstream& other)
+            : basic_ofstream(other.filename,
 	    other.mode,
             other.type,
-	    other.level) {}
-    virtual ~ofstream() { if (rdbuf()) delete rdbuf(); }
+	    other.prm) {}
+    virtual ~basic_ofstream() { if (rdbuf()) delete rdbuf(); }
+    // Reopens the stream with the type and params it was made with.
     void open(const std::string &filename,
 	      std::ios_base::openmode mode = std::ios_base::in) {
-	this->~ofstream();
-	new (this) ofstream(filename, mode);
+	this->open(filename, mode, this->type, this->prm);
     }
     void open(const char* filename,
 	      std::ios_base::openmode mode = std::ios_base::in) {
-	this->~ofstream();
-	new (this) ofstream(filename, mode);
+	this->open(std::string(filename), mode, this->type, this->prm);
+    }
+    void open(const std::string &filename, std::ios_base::openmode mode,
+	      Compression type, const params &prm) {
+	// `prm` may be this->prm
+	const params reopen_prm(prm);
+	this->~basic_ofstream();
+	new (this) basic_ofstream(filename, mode, type, reopen_prm);
     }
     bool is_open() const { return _fs.is_open(); }
-    void close() { _fs.close(); }
+    void close() {
+	// finish the compressed stream before closing the file
+	if (rdbuf() && static_cast<streambuf_type*>(rdbuf())->close() != 0)
+	    setstate(std::ios_base::badbit);
+	_fs.close();
+    }
+    // Counters collected with params::collect_stats.
+    stream_stats stats() const { return static_cast<streambuf_type*>(rdbuf())->stats(); }
 
   private:
     std::string filename;
     std::ios_base::openmode mode;
     Compression type;
-    int level;
-}; // class ofstream
+    params prm;
+}; // class basic_ofstream
+
+typedef basic_ofstream<detail::stream_wrapper> ofstream;
+
+// Decompresses everything in `src` to `dst` and returns the number of
+// bytes written. Reads the input sequentially, so gzip input is
+// decoded with inflateBack() when `prm.z_inflate_back` is set (see
+// z_inflate_back.hpp). Throws if `dst` does not take all of the output.
+inline uint64_t decompress_to(std::streambuf *src, std::streambuf *dst, const params &prm = params()) {
+#ifdef BXZSTR_Z_INFLATE_BACK_HPP
+    if (prm.z_inflate_back && detail::resolve_gzip_backend(prm.z_backend) == gzip_backend_zlib
+	&& src->sgetc() == 0x1F) {
+	detail::z_inflate_back inflater(prm);
+	return inflater.run(src, dst);
+    }
+#endif
+    istreambuf ibuf(src, prm);
+    std::vector<char> buff((std::size_t)1 << 16);
+    uint64_t total = 0;
+    while (true) {
+	const std::streamsize n = ibuf.sgetn(buff.data(), (std::streamsize)buff.size());
+	if (n <= 0) break;
+	if (dst->sputn(buff.data(), n) != n) throw std::runtime_error("bxzstr: could not write to the output stream.");
+	total += (uint64_t)n;
+    }
+    return total;
+}
+
+// Decompresses the whole file at `path` into a string. The string is
+// sized from the metadata read by bxz::stat(), and the memory mapped
+// file is decompressed straight into it in calls of up to 1 GiB, instead
+// of a buffer at a time through an istreambuf. Files that cannot be
+// mapped, such as pipes or those in /proc, are read into memory first
+// and their size is guessed. The format is detected as in bxz::ifstream
+// when `type` is none. Throws if the file is truncated.
+inline std::string read_all(const std::string &path, const params &prm = params(), const Compression type = none) {
+    const detail::mapped_file compressed(path);
+    content_info info;
+    if (compressed.mapped()) {
+	info = stat(path, type);
+    } else {
+	info.type = (type == none ? detect_type_from_extension(path) : type);
+	if (info.type == none) info.type = detail::detect_buffer_type(compressed.data(), compressed.size());
+    }
+    if (info.type == plaintext) return std::string(compressed.data(), compressed.size());
+    // one spare byte lets the codecs read the trailer after the last
+    // byte of output; the sizes in the file are only a hint
+    std::string out((std::size_t)(info.size_known ? detail::initial_output_size(info.content_size, compressed.size()) + 1
+				  : std::max<uint64_t>(4*(uint64_t)compressed.size(), (uint64_t)1 << 16)), '\0');
+    detail::buffer_decompressor decompressor(info.type, prm, compressed.data(), compressed.size());
+    uint64_t total = 0;
+    while (true) {
+	total += decompressor.run(&out[(std::size_t)total], out.size() - total);
+	if (decompressor.finished()) break;
+	out.resize(2*out.size());
+    }
+    if (decompressor.truncated()) throw std::runtime_error("bxzstr: truncated input.");
+    out.resize((std::size_t)total);
+    if (out.capacity() - out.size() > out.size()/4) out.shrink_to_fit();
+    return out;
+}
+
+// Streams for a format known at compile time. These skip format
+// detection and call the codec without virtual dispatch.
+#ifdef BXZSTR_LZMA_STREAM_WRAPPER_HPP
+typedef basic_istreambuf<detail::lzma_stream_wrapper> lzma_istreambuf;
+typedef basic_ostreambuf<detail::lzma_stream_wrapper> lzma_ostreambuf;
+typedef basic_ifstream<detail::lzma_stream_wrapper> lzma_ifstream;
+typedef basic_ofstream<detail::lzma_stream_wrapper> lzma_ofstream;
+#endif
+#ifdef BXZSTR_BZ_STREAM_WRAPPER_HPP
+typedef basic_istreambuf<detail::bz_stream_wrapper> bz2_istreambuf;
+typedef basic_ostreambuf<detail::bz_stream_wrapper> bz2_ostreambuf;
+typedef basic_ifstream<detail::bz_stream_wrapper> bz2_ifstream;
+typedef basic_ofstream<detail::bz_stream_wrapper> bz2_ofstream;
+#endif
+#ifdef BXZSTR_Z_STREAM_WRAPPER_HPP
+typedef basic_istreambuf<detail::z_stream_wrapper> z_istreambuf;
+typedef basic_ostreambuf<detail::z_stream_wrapper> z_ostreambuf;
+typedef basic_ifstream<detail::z_stream_wrapper> z_ifstream;
+typedef basic_ofstream<detail::z_stream_wrapper> z_ofstream;
+#endif
+#ifdef BXZSTR_BGZF_STREAM_WRAPPER_HPP
+typedef basic_istreambuf<detail::bgzf_stream_wrapper> bgzf_istreambuf;
+typedef basic_ostreambuf<detail::bgzf_stream_wrapper> bgzf_ostreambuf;
+typedef basic_ifstream<detail::bgzf_stream_wrapper> bgzf_ifstream;
+typedef basic_ofstream<detail::bgzf_stream_wrapper> bgzf_ofstream;
+#endif
+#ifdef BXZSTR_ZSTD_STREAM_WRAPPER_HPP
+typedef basic_istreambuf<detail::zstd_stream_wrapper> zstd_istreambuf;
+typedef basic_ostreambuf<detail::zstd_stream_wrapper> zstd_ostreambuf;
+typedef basic_ifstream<detail::zstd_stream_wrapper> zstd_ifstream;
+typedef basic_ofstream<detail::zstd_stream_wrapper> zstd_ofstream;
+#endif
+#ifdef BXZSTR_LZ4_STREAM_WRAPPER_HPP
+typedef basic_istreambuf<detail::lz4_stream_wrapper> lz4_istreambuf;
+typedef basic_ostreambuf<detail::lz4_stream_wrapper> lz4_ostreambuf;
+typedef basic_ifstream<detail::lz4_stream_wrapper> lz4_ifstream;
+typedef basic_ofstream<detail::lz4_stream_wrapper> lz4_ofstream;
+#endif
+#ifdef BXZSTR_BROTLI_STREAM_WRAPPER_HPP
+typedef basic_istreambuf<detail::brotli_stream_wrapper> brotli_istreambuf;
+typedef basic_ostreambuf<detail::brotli_stream_wrapper> brotli_ostreambuf;
+typedef basic_ifstream<detail::brotli_stream_wrapper> brotli_ifstream;
+typedef basic_ofstream<detail::brotli_stream_wrapper> brotli_ofstream;
+#endif
 } // namespace bxz
 
 #endif
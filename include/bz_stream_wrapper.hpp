@@ -17,6 +17,7 @@
 #include <exception>
 
 #include "stream_wrapper.hpp"
+#include "params.hpp"
 
 namespace bxz {
 /// Exception class thrown by failed bzlib operations.
@@ -68,19 +69,23 @@ class bzException : public std::exception {
 }; // class bzException
 
 namespace detail {
-class bz_stream_wrapper : public bz_stream, public stream_wrapper {
+class bz_stream_wrapper final : public bz_stream, public stream_wrapper {
   public:
     bz_stream_wrapper(const bool _is_input = true, const int _level = 9, const int _wf = 30)
-            : is_input(_is_input) {
+            : bz_stream_wrapper(_is_input, make_params(_level, _wf)) {}
+    bz_stream_wrapper(const bool _is_input, const params &p)
+            : is_input(_is_input),
+	      level(p.level),
+	      small(p.bz2_small || (p.memory_limit > 0 && p.memory_limit < decompress_memory_usage(false))) {
 	this->bzalloc = NULL;
 	this->bzfree = NULL;
 	this->opaque = NULL;
 	if (is_input) {
 	    bz_stream::avail_in = 0;
 	    bz_stream::next_in = NULL;
-	    ret = BZ2_bzDecompressInit(this, 0, 0);
+	    ret = BZ2_bzDecompressInit(this, 0, small);
 	} else {
-	    ret = BZ2_bzCompressInit(this, _level, 0, _wf);
+	    ret = BZ2_bzCompressInit(this, p.level, 0, p.bz2_work_factor);
 	}
 	if (ret != BZ_OK) throw bzException(ret);
     }
@@ -93,6 +98,7 @@ class bz_stream_wrapper : public bz_stream, public stream_wrapper {
     }
 
     int decompress(const int = 0) override {
+	// returns BZ_OK when no progress is possible
 	ret = BZ2_bzDecompress(this);
 	if (ret != BZ_OK && ret != BZ_STREAM_END) throw bzException(ret);
 	return ret;
@@ -104,6 +110,10 @@ class bz_stream_wrapper : public bz_stream, public stream_wrapper {
     }
     bool stream_end() const override { return this->ret == BZ_STREAM_END; }
     bool done() const override { return this->stream_end(); }
+    std::size_t memory_usage() const override {
+	// estimates from the bzip2 documentation
+	return is_input ? decompress_memory_usage(small) : 400000 + 8*100000*(std::size_t)level;
+    }
 
     const uint8_t* next_in() const override { return (uint8_t*)bz_stream::next_in; }
     long avail_in() const override { return bz_stream::avail_in; }
@@ -118,6 +128,19 @@ class bz_stream_wrapper : public bz_stream, public stream_wrapper {
   private:
     bool is_input;
     int ret;
+    int level;
+    bool small;
+
+    // The block size is not known before decompressing, so assume the
+    // largest (900k).
+    static std::size_t decompress_memory_usage(const bool _small) {
+	return _small ? 100000 + 2250000 : 100000 + 3600000;
+    }
+    static params make_params(const int _level, const int _wf) {
+	params p(_level);
+	p.bz2_work_factor = _wf;
+	return p;
+    }
 }; // class bz_stream_wrapper
 } // namespace detail
 } // namespace bxz
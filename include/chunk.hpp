@@ -0,0 +1,89 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_CHUNK_HPP
+#define BXZSTR_CHUNK_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+namespace bxz {
+// Decompressed data in the output buffer of an istreambuf, returned by
+// next_chunk(). The data stays valid until the next read from the
+// stream buffer.
+struct chunk {
+    chunk() : data(nullptr), size(0) {}
+    chunk(const char *_data, const std::size_t _size) : data(_data), size(_size) {}
+
+    const char *data;
+    std::size_t size;
+
+    bool empty() const { return this->size == 0; }
+    const char* begin() const { return this->data; }
+    const char* end() const { return this->data + this->size; }
+    std::string str() const { return std::string(this->data, this->size); }
+#if __cplusplus >= 201703L
+    operator std::string_view() const { return std::string_view(this->data, this->size); }
+#endif
+};
+
+// The chunks of a stream buffer or file stream that has next_chunk(),
+// for range-based for loops:
+//   for (const bxz::chunk &c : bxz::chunks(ibuf)) parse(c.data, c.size);
+// Each increment calls next_chunk(), so the range is read once.
+template <typename Source>
+class chunk_range {
+  public:
+    class iterator {
+      public:
+	typedef std::input_iterator_tag iterator_category;
+	typedef chunk value_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef const chunk* pointer;
+	typedef const chunk& reference;
+
+	iterator() : source(nullptr), current() {}
+	explicit iterator(Source *_source) : source(_source), current(_source->next_chunk()) {
+	    if (this->current.empty()) this->source = nullptr;
+	}
+
+	reference operator*() const { return this->current; }
+	pointer operator->() const { return &this->current; }
+	iterator& operator++() {
+	    this->current = this->source->next_chunk();
+	    if (this->current.empty()) this->source = nullptr;
+	    return *this;
+	}
+	// Only the end of the range compares equal to itself.
+	bool operator==(const iterator &other) const { return this->source == other.source; }
+	bool operator!=(const iterator &other) const { return this->source != other.source; }
+
+      private:
+	Source *source;
+	chunk current;
+    };
+
+    explicit chunk_range(Source &_source) : source(&_source) {}
+    iterator begin() const { return iterator(this->source); }
+    iterator end() const { return iterator(); }
+
+  private:
+    Source *source;
+}; // class chunk_range
+
+template <typename Source>
+chunk_range<Source> chunks(Source &source) {
+    return chunk_range<Source>(source);
+}
+} // namespace bxz
+
+#endif
@@ -9,20 +9,36 @@
 #define BXZSTR_COMPRESSION_TYPES_HPP
 
 #include <exception>
+#include <string>
+#include <cstring>
 
 #include "stream_wrapper.hpp"
+#include "params.hpp"
+#include "memory.hpp"
 #include "bz_stream_wrapper.hpp"
 #include "lzma_stream_wrapper.hpp"
 #include "z_stream_wrapper.hpp"
+#include "isal_stream_wrapper.hpp"
+#include "bgzf_stream_wrapper.hpp"
 #include "zstd_stream_wrapper.hpp"
+#include "lz4_stream_wrapper.hpp"
+#include "brotli_stream_wrapper.hpp"
 
 namespace bxz {
-    enum Compression { z, bz2, lzma, zstd, plaintext, none };
+    // New types are appended so that the values stay the same.
+    enum Compression { z, bz2, lzma, zstd, plaintext, none, lz4, brotli, bgzf };
 inline Compression detect_type(const char* in_buff_start,const  char* in_buff_end) {
     const unsigned char b0 = *reinterpret_cast<const  unsigned char * >(in_buff_start);
     const unsigned char b1 = *reinterpret_cast<const  unsigned char * >(in_buff_start + 1);
     bool gzip_header = (b0 == 0x1F && b1 == 0x8B);
     bool zlib_header = (b0 == 0x78 && (b1 == 0x01 || b1 == 0x9C || b1 == 0xDA));
+#ifdef BXZSTR_BGZF_STREAM_WRAPPER_HPP
+    // gzip with the BC extra field (FEXTRA, XLEN 6, SI1 'B', SI2 'C', SLEN 2)
+    static const unsigned char bgzf_header[16] = { 0x1F, 0x8B, 0x08, 0x04, 0, 0, 0, 0, 0, 0, 6, 0, 'B', 'C', 2, 0 };
+    const unsigned char *in = reinterpret_cast<const unsigned char *>(in_buff_start);
+    if (in_buff_end - in_buff_start >= 16 && (in[3] & 0x04) && std::memcmp(in, bgzf_header, 3) == 0
+	&& std::memcmp(in + 10, bgzf_header + 10, 6) == 0) return bgzf;
+#endif
     if (in_buff_start + 1 <= in_buff_end && (gzip_header || zlib_header)) return z;
     const unsigned char b2 = *reinterpret_cast<const  unsigned char * >(in_buff_start + 2);
     bool bz2_header = (b0 == 0x42 && b1 == 0x5a && b2 == 0x68);
@@ -35,36 +51,89 @@ inline Compression detect_type(const char* in_buff_start,const  char* in_buff_en
     if (in_buff_start + 5 <= in_buff_end && lzma_header) return lzma;
     bool zstd_header = (b0 == 0x28 && b1 == 0xB5 && b2 == 0x2F && b3 == 0xFD);
     if (in_buff_start + 3 <= in_buff_end && zstd_header) return zstd;
+    bool lz4_header = (b0 == 0x04 && b1 == 0x22 && b2 == 0x4D && b3 == 0x18);
+    if (in_buff_start + 3 <= in_buff_end && lz4_header) return lz4;
     return plaintext;
 }
+// Compression types that have no magic bytes are recognized from the
+// file extension instead. Returns none for the other files.
+inline Compression detect_type_from_extension(const std::string &filename) {
+#ifdef BXZSTR_BROTLI_STREAM_WRAPPER_HPP
+    const std::string br = ".br";
+    if (filename.size() > br.size()
+	&& filename.compare(filename.size() - br.size(), br.size(), br) == 0) return brotli;
+#else
+    (void)filename;
+#endif
+    return none;
+}
 
-#if defined(BXZSTR_LZMA_STREAM_WRAPPER_HPP) || defined(BXZSTR_BZ_STREAM_WRAPPER_HPP) || defined(BXZSTR_Z_STREAM_WRAPPER_HPP) || defined(BXZSTR_ZSTD_STREAM_WRAPPER_HPP)
-inline void init_stream(const Compression &type, const bool is_input, const int level,
+#ifdef BXZSTR_Z_STREAM_WRAPPER_HPP
+namespace detail {
+// Creates the bxz::z codec of the backend selected in `p` (see
+// gzip_backend.hpp).
+inline stream_wrapper* new_z_stream_wrapper(const bool is_input, const params &p) {
+    const GzipBackend backend = resolve_gzip_backend(p.z_backend);
+#ifdef BXZSTR_ISAL_STREAM_WRAPPER_HPP
+    // the ISA-L decoder always verifies the checksums
+    if (backend == gzip_backend_isal && (!is_input || p.verify_checksums))
+	return new isal_stream_wrapper(is_input, p);
+#endif
+#if defined(BXZSTR_ZLIB_NG_SUPPORT) && (BXZSTR_ZLIB_NG_SUPPORT) == 1
+    if (backend != gzip_backend_zlib) return new zng_stream_wrapper(is_input, p);
+#endif
+    (void)backend;
+    return new z_stream_wrapper(is_input, p);
+}
+} // namespace detail
+#endif
+
+#if defined(BXZSTR_LZMA_STREAM_WRAPPER_HPP) || defined(BXZSTR_BZ_STREAM_WRAPPER_HPP) || defined(BXZSTR_Z_STREAM_WRAPPER_HPP) || defined(BXZSTR_ZSTD_STREAM_WRAPPER_HPP) || defined(BXZSTR_LZ4_STREAM_WRAPPER_HPP) || defined(BXZSTR_BROTLI_STREAM_WRAPPER_HPP) || defined(BXZSTR_BGZF_STREAM_WRAPPER_HPP)
+inline void init_stream(const Compression &type, const bool is_input, const params &prm,
 			std::unique_ptr<detail::stream_wrapper> *strm_p) {
+    // limit the stream to what is left of the global memory budget
+    params p(prm);
+    p.memory_limit = detail::effective_memory_limit(prm.memory_limit);
 #else
-inline void init_stream(const Compression &type, const bool, const int,
+inline void init_stream(const Compression &type, const bool, const params &,
 			std::unique_ptr<detail::stream_wrapper> *) {
 #endif
     switch (type) {
 #ifdef BXZSTR_LZMA_STREAM_WRAPPER_HPP
-        case lzma : strm_p->reset(new detail::lzma_stream_wrapper(is_input, level));
+        case lzma : strm_p->reset(new detail::lzma_stream_wrapper(is_input, p));
 	break;
 #endif
 #ifdef BXZSTR_BZ_STREAM_WRAPPER_HPP
-        case bz2 : strm_p->reset(new detail::bz_stream_wrapper(is_input, level));
+        case bz2 : strm_p->reset(new detail::bz_stream_wrapper(is_input, p));
 	break;
 #endif
 #ifdef BXZSTR_Z_STREAM_WRAPPER_HPP
-        case z : strm_p->reset(new detail::z_stream_wrapper(is_input, level));
+        case z : strm_p->reset(detail::new_z_stream_wrapper(is_input, p));
 	break;
 #endif
 #ifdef BXZSTR_ZSTD_STREAM_WRAPPER_HPP
-        case zstd : strm_p->reset(new detail::zstd_stream_wrapper(is_input, level));
+        case zstd : strm_p->reset(new detail::zstd_stream_wrapper(is_input, p));
+	break;
+#endif
+#ifdef BXZSTR_LZ4_STREAM_WRAPPER_HPP
+        case lz4 : strm_p->reset(new detail::lz4_stream_wrapper(is_input, p));
+	break;
+#endif
+#ifdef BXZSTR_BROTLI_STREAM_WRAPPER_HPP
+        case brotli : strm_p->reset(new detail::brotli_stream_wrapper(is_input, p));
+	break;
+#endif
+#ifdef BXZSTR_BGZF_STREAM_WRAPPER_HPP
+        case bgzf : strm_p->reset(new detail::bgzf_stream_wrapper(is_input, p));
 	break;
 #endif
 	default : throw std::runtime_error("Unrecognized compression type.");
     }
 }
+inline void init_stream(const Compression &type, const bool is_input, const int level,
+			std::unique_ptr<detail::stream_wrapper> *strm_p) {
+    init_stream(type, is_input, params(level), strm_p);
+}
 inline void init_stream(const Compression &type, const bool is_input,
 			std::unique_ptr<detail::stream_wrapper> *strm_p) {
     init_stream(type, is_input, 6, strm_p);
@@ -87,6 +156,18 @@ inline int bxz_run(const Compression &type) {
 #ifdef BXZSTR_ZSTD_STREAM_WRAPPER_HPP
         case zstd: return 0;
 	break;// ZSTD_NO_FLUSH
+#endif
+#ifdef BXZSTR_LZ4_STREAM_WRAPPER_HPP
+        case lz4: return 0;
+	break;// LZ4F_compressUpdate
+#endif
+#ifdef BXZSTR_BROTLI_STREAM_WRAPPER_HPP
+        case brotli: return 0;
+	break;// BROTLI_OPERATION_PROCESS
+#endif
+#ifdef BXZSTR_BGZF_STREAM_WRAPPER_HPP
+        case bgzf: return 0;
+	break;// Z_NO_FLUSH
 #endif
 	default: throw std::runtime_error("Unrecognized compression type.");
     }
@@ -108,10 +189,159 @@ inline int bxz_finish(const Compression &type) {
 #ifdef BXZSTR_ZSTD_STREAM_WRAPPER_HPP
         case zstd: return 1;
 	break; // endStream == true
+#endif
+#ifdef BXZSTR_LZ4_STREAM_WRAPPER_HPP
+        case lz4: return 1;
+	break; // LZ4F_compressEnd
+#endif
+#ifdef BXZSTR_BROTLI_STREAM_WRAPPER_HPP
+        case brotli: return 2;
+	break; // BROTLI_OPERATION_FINISH
+#endif
+#ifdef BXZSTR_BGZF_STREAM_WRAPPER_HPP
+        case bgzf: return 4;
+	break; // Z_FINISH
 #endif
 	default: throw std::runtime_error("Unrecognized compression type.");
     }
 }
+inline int bxz_flush(const Compression &type) {
+    switch(type){
+#ifdef BXZSTR_LZMA_STREAM_WRAPPER_HPP
+	case lzma: return 1;
+	break; // LZMA_SYNC_FLUSH
+#endif
+#ifdef BXZSTR_BZ_STREAM_WRAPPER_HPP
+        case bz2: return 1;
+	break; // BZ_FLUSH
+#endif
+#ifdef BXZSTR_Z_STREAM_WRAPPER_HPP
+        case z: return 2;
+	break; // Z_SYNC_FLUSH
+#endif
+#ifdef BXZSTR_ZSTD_STREAM_WRAPPER_HPP
+        case zstd: return 2;
+	break; // ZSTD_e_flush
+#endif
+#ifdef BXZSTR_LZ4_STREAM_WRAPPER_HPP
+        case lz4: return 2;
+	break; // LZ4F_flush
+#endif
+#ifdef BXZSTR_BROTLI_STREAM_WRAPPER_HPP
+        case brotli: return 1;
+	break; // BROTLI_OPERATION_FLUSH
+#endif
+#ifdef BXZSTR_BGZF_STREAM_WRAPPER_HPP
+        case bgzf: return 2;
+	break; // Z_SYNC_FLUSH, ends the current block
+#endif
+	default: throw std::runtime_error("Unrecognized compression type.");
+    }
+}
+
+// Action that basic_ostreambuf runs at the boundaries of rsyncable
+// output (params::rsyncable), or -1 if it does not cut `type` output.
+// gzip is reset with a full flush; zstd ends the frame unless the
+// workers of ZSTD_c_rsyncable find the boundaries themselves.
+inline int bxz_rsync(const Compression &type, const params &p) {
+    switch(type){
+#ifdef BXZSTR_Z_STREAM_WRAPPER_HPP
+        case z: return 3;
+	break; // Z_FULL_FLUSH
+#endif
+#ifdef BXZSTR_ZSTD_STREAM_WRAPPER_HPP
+        case zstd: return (p.zstd_workers > 0 ? -1 : bxz_finish(type));
+	break;
+#endif
+	default: (void)p; return -1;
+    }
+}
+
+// Highest level that params::adaptive_level can pick for `type`, or 0
+// if the level of `type` cannot be changed while compressing.
+inline int bxz_max_level(const Compression &type) {
+    switch(type){
+#ifdef BXZSTR_Z_STREAM_WRAPPER_HPP
+        case z: return 9;
+	break;
+#endif
+#ifdef BXZSTR_ZSTD_STREAM_WRAPPER_HPP
+        case zstd: return ZSTD_maxCLevel();
+	break;
+#endif
+	default: return 0;
+    }
+}
+
+namespace detail {
+// Codec policies for basic_istreambuf and basic_ostreambuf. The
+// type-erased stream_wrapper picks the codec from the Compression
+// type at runtime and supports auto-detection; the concrete wrappers
+// are fixed at compile time, which lets the compiler devirtualize and
+// inline the calls in the buffer loops.
+template <typename Codec>
+struct codec_traits;
+
+template <>
+struct codec_traits<stream_wrapper> {
+    static bool auto_detect() { return true; }
+    static Compression type(const Compression requested) { return requested; }
+    static void init(const Compression &type, const bool is_input, const params &prm,
+		     std::unique_ptr<stream_wrapper> *strm_p) {
+	init_stream(type, is_input, prm, strm_p);
+    }
+};
+
+template <typename Codec, Compression Type>
+struct fixed_codec_traits {
+    static bool auto_detect() { return false; }
+    static Compression type(const Compression) { return Type; }
+    static void init(const Compression &, const bool is_input, const params &prm,
+		     std::unique_ptr<Codec> *strm_p) {
+	// limit the stream to what is left of the global memory budget
+	params p(prm);
+	p.memory_limit = effective_memory_limit(prm.memory_limit);
+	strm_p->reset(new Codec(is_input, p));
+    }
+};
+
+#ifdef BXZSTR_LZMA_STREAM_WRAPPER_HPP
+template <>
+struct codec_traits<lzma_stream_wrapper> : fixed_codec_traits<lzma_stream_wrapper, lzma> {};
+#endif
+#ifdef BXZSTR_BZ_STREAM_WRAPPER_HPP
+template <>
+struct codec_traits<bz_stream_wrapper> : fixed_codec_traits<bz_stream_wrapper, bz2> {};
+#endif
+#ifdef BXZSTR_Z_STREAM_WRAPPER_HPP
+template <>
+struct codec_traits<z_stream_wrapper> : fixed_codec_traits<z_stream_wrapper, z> {};
+#if defined(BXZSTR_ZLIB_NG_SUPPORT) && (BXZSTR_ZLIB_NG_SUPPORT) == 1
+template <>
+struct codec_traits<zng_stream_wrapper> : fixed_codec_traits<zng_stream_wrapper, z> {};
+#endif
+#endif
+#ifdef BXZSTR_ISAL_STREAM_WRAPPER_HPP
+template <>
+struct codec_traits<isal_stream_wrapper> : fixed_codec_traits<isal_stream_wrapper, z> {};
+#endif
+#ifdef BXZSTR_BGZF_STREAM_WRAPPER_HPP
+template <>
+struct codec_traits<bgzf_stream_wrapper> : fixed_codec_traits<bgzf_stream_wrapper, bgzf> {};
+#endif
+#ifdef BXZSTR_ZSTD_STREAM_WRAPPER_HPP
+template <>
+struct codec_traits<zstd_stream_wrapper> : fixed_codec_traits<zstd_stream_wrapper, zstd> {};
+#endif
+#ifdef BXZSTR_LZ4_STREAM_WRAPPER_HPP
+template <>
+struct codec_traits<lz4_stream_wrapper> : fixed_codec_traits<lz4_stream_wrapper, lz4> {};
+#endif
+#ifdef BXZSTR_BROTLI_STREAM_WRAPPER_HPP
+template <>
+struct codec_traits<brotli_stream_wrapper> : fixed_codec_traits<brotli_stream_wrapper, brotli> {};
+#endif
+} // namespace detail
 }
 
 #endif
@@ -5,5 +5,10 @@
 #define BXZSTR_BZ2_SUPPORT 1
 #define BXZSTR_LZMA_SUPPORT 1
 #define BXZSTR_ZSTD_SUPPORT 0
+#define BXZSTR_LZ4_SUPPORT 0
+#define BXZSTR_BROTLI_SUPPORT 0
+#define BXZSTR_ZLIB_NG_SUPPORT 0
+#define BXZSTR_ISAL_SUPPORT 0
+#define BXZSTR_LIBDEFLATE_SUPPORT 0
 
 #endif
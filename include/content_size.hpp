@@ -0,0 +1,262 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_CONTENT_SIZE_HPP
+#define BXZSTR_CONTENT_SIZE_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <ios>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "compression_types.hpp"
+
+namespace bxz {
+// What bxz::stat() reads about compressed data without decompressing it.
+struct content_info {
+    content_info() : type(none), compressed_size(0), size_known(false), size_exact(false), content_size(0) {}
+
+    Compression type;
+    uint64_t compressed_size;
+    // The uncompressed size is exact when read from the zstd frame
+    // headers or seek table, the xz index, the BGZF block trailers, or
+    // from the size of a plaintext file. The ISIZE trailer of other
+    // gzip files holds the size of the last member modulo 2^32, so
+    // `content_size` is the uncompressed size only if the file is a
+    // single member of less than 4 GiB, and `size_exact` is false.
+    // bzip2, lz4 and brotli do not record the size.
+    bool size_known;
+    bool size_exact;
+    uint64_t content_size;
+};
+
+namespace detail {
+inline uint32_t load_le16(const unsigned char *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+inline uint32_t load_le32(const unsigned char *p) {
+    return load_le16(p) | (load_le16(p + 2) << 16);
+}
+
+inline bool read_at(std::streambuf *sbuf, const uint64_t pos, unsigned char *buf, const std::size_t n) {
+    if (sbuf->pubseekpos((std::streamoff)pos, std::ios_base::in) != std::streampos((std::streamoff)pos)) return false;
+    return sbuf->sgetn(reinterpret_cast<char*>(buf), (std::streamsize)n) == (std::streamsize)n;
+}
+
+#ifdef BXZSTR_ZSTD_STREAM_WRAPPER_HPP
+// Sums the decompressed sizes in the seek table of the zstd seekable
+// format, a skippable frame at the end of the file.
+inline bool zstd_seek_table_size(std::streambuf *sbuf, const uint64_t file_size, uint64_t *size) {
+    static const uint32_t seekable_magic = 0x8F92EAB1;
+    static const uint32_t skippable_magic = 0x184D2A5E;
+    unsigned char footer[9];
+    if (file_size < 17 || !read_at(sbuf, file_size - 9, footer, 9) || load_le32(footer + 5) != seekable_magic)
+	return false;
+    const uint64_t entry_size = (footer[4] & 0x80) ? 12 : 8;
+    const uint64_t table_size = load_le32(footer)*entry_size;
+    unsigned char header[8];
+    if (table_size + 17 > file_size || !read_at(sbuf, file_size - table_size - 17, header, 8)
+	|| load_le32(header) != skippable_magic || load_le32(header + 4) != table_size + 9) return false;
+    std::vector<unsigned char> table((std::size_t)table_size);
+    if (table_size > 0 && !read_at(sbuf, file_size - table_size - 9, table.data(), table.size())) return false;
+    uint64_t total = 0;
+    for (std::size_t i = 0; i < table.size(); i += entry_size) total += load_le32(&table[i + 4]);
+    *size = total;
+    return true;
+}
+
+// Sums the content sizes in the frame headers. Only the frame and block
+// headers are read, to find where the next frame starts.
+inline bool zstd_frames_size(std::streambuf *sbuf, const uint64_t file_size, uint64_t *size) {
+    static const std::size_t dict_id_size[4] = { 0, 1, 2, 4 };
+    static const std::size_t content_size_size[4] = { 0, 2, 4, 8 };
+    uint64_t pos = 0;
+    uint64_t total = 0;
+    while (pos < file_size) {
+	unsigned char header[18];
+	const std::size_t n = (std::size_t)std::min<uint64_t>(sizeof(header), file_size - pos);
+	if (n < 8 || !read_at(sbuf, pos, header, n)) return false;
+	const uint32_t magic = load_le32(header);
+	if ((magic & 0xFFFFFFF0) == ZSTD_MAGIC_SKIPPABLE_START) {
+	    pos += 8 + (uint64_t)load_le32(header + 4);
+	    continue;
+	}
+	if (magic != ZSTD_MAGICNUMBER) return false;
+	const unsigned char descriptor = header[4];
+	const bool single_segment = (descriptor & 0x20) != 0;
+	const std::size_t header_size = 5 + (single_segment ? 0 : 1) + dict_id_size[descriptor & 3]
+	    + (single_segment && (descriptor >> 6) == 0 ? 1 : content_size_size[descriptor >> 6]);
+	if (header_size > n) return false;
+	const unsigned long long frame_size = ZSTD_getFrameContentSize(header, header_size);
+	if (frame_size == ZSTD_CONTENTSIZE_UNKNOWN || frame_size == ZSTD_CONTENTSIZE_ERROR) return false;
+	total += frame_size;
+	pos += header_size;
+	bool last_block = false;
+	while (!last_block) {
+	    unsigned char block[3];
+	    if (!read_at(sbuf, pos, block, 3)) return false;
+	    const uint32_t block_header = load_le16(block) | ((uint32_t)block[2] << 16);
+	    const uint32_t block_type = (block_header >> 1) & 3;
+	    if (block_type == 3) return false;
+	    last_block = (block_header & 1) != 0;
+	    // RLE blocks store one byte, whatever their size
+	    pos += 3 + (block_type == 1 ? 1 : (block_header >> 3));
+	}
+	if (descriptor & 0x04) pos += 4;
+    }
+    if (pos != file_size) return false;
+    *size = total;
+    return true;
+}
+#endif
+
+#ifdef BXZSTR_LZMA_STREAM_WRAPPER_HPP
+// Sums the uncompressed sizes in the indexes of the xz streams,
+// reading the streams backwards from the end of the file.
+inline bool xz_index_size(std::streambuf *sbuf, const uint64_t file_size, uint64_t *size) {
+    uint64_t end = file_size;
+    uint64_t total = 0;
+    while (end > 0) {
+	unsigned char footer[LZMA_STREAM_HEADER_SIZE];
+	if (end < 2*LZMA_STREAM_HEADER_SIZE || !read_at(sbuf, end - LZMA_STREAM_HEADER_SIZE, footer, sizeof(footer)))
+	    return false;
+	if (load_le32(footer + 8) == 0) {
+	    // stream padding
+	    end -= 4;
+	    continue;
+	}
+	lzma_stream_flags flags;
+	if (lzma_stream_footer_decode(&flags, footer) != LZMA_OK
+	    || flags.backward_size + 2*LZMA_STREAM_HEADER_SIZE > end) return false;
+	std::vector<uint8_t> index((std::size_t)flags.backward_size);
+	if (!read_at(sbuf, end - LZMA_STREAM_HEADER_SIZE - flags.backward_size, index.data(), index.size()))
+	    return false;
+	lzma_index *idx = nullptr;
+	uint64_t memlimit = UINT64_MAX;
+	std::size_t in_pos = 0;
+	if (lzma_index_buffer_decode(&idx, &memlimit, nullptr, index.data(), &in_pos, index.size()) != LZMA_OK)
+	    return false;
+	total += lzma_index_uncompressed_size(idx);
+	const uint64_t stream_size = lzma_index_stream_size(idx);
+	lzma_index_end(idx, nullptr);
+	if (stream_size > end) return false;
+	end -= stream_size;
+    }
+    *size = total;
+    return true;
+}
+#endif
+
+#ifdef BXZSTR_Z_STREAM_WRAPPER_HPP
+// Sums the ISIZE trailers of the BGZF blocks. The block size is taken
+// from the BC field of each block header.
+inline bool bgzf_blocks_size(std::streambuf *sbuf, const uint64_t file_size, uint64_t *size) {
+    uint64_t pos = 0;
+    uint64_t total = 0;
+    while (pos < file_size) {
+	unsigned char header[12];
+	if (!read_at(sbuf, pos, header, sizeof(header)) || header[0] != 0x1F || header[1] != 0x8B
+	    || !(header[3] & 0x04)) return false;
+	std::vector<unsigned char> extra(load_le16(header + 10));
+	if (!read_at(sbuf, pos + 12, extra.data(), extra.size())) return false;
+	uint64_t block_size = 0;
+	for (std::size_t i = 0; i + 4 <= extra.size(); i += 4 + load_le16(&extra[i + 2])) {
+	    if (extra[i] == 'B' && extra[i + 1] == 'C' && load_le16(&extra[i + 2]) == 2 && i + 6 <= extra.size())
+		block_size = (uint64_t)load_le16(&extra[i + 4]) + 1;
+	}
+	unsigned char isize[4];
+	if (block_size < 12 + extra.size() + 8 || !read_at(sbuf, pos + block_size - 4, isize, 4)) return false;
+	total += load_le32(isize);
+	pos += block_size;
+    }
+    *size = total;
+    return true;
+}
+#endif
+
+// Fills `info` from the data at the start of `sbuf` and restores the
+// position of `sbuf`. Returns false if `sbuf` cannot seek.
+inline bool stat_streambuf(std::streambuf *sbuf, Compression type, content_info *info) {
+    const std::streampos start = sbuf->pubseekoff(0, std::ios_base::cur, std::ios_base::in);
+    const std::streampos end = sbuf->pubseekoff(0, std::ios_base::end, std::ios_base::in);
+    if (start == std::streampos(std::streamoff(-1)) || end == std::streampos(std::streamoff(-1))) return false;
+    const uint64_t file_size = (uint64_t)(std::streamoff)end;
+    info->compressed_size = file_size;
+    if (type == none) {
+	char magic[18] = { 0 };
+	const std::size_t n = (std::size_t)std::min<uint64_t>(sizeof(magic), file_size);
+	type = (n == 0 || !read_at(sbuf, 0, reinterpret_cast<unsigned char*>(magic), n)
+		? plaintext : detect_type(magic, magic + n));
+    }
+    info->type = type;
+    uint64_t size = 0;
+    switch (type) {
+	case plaintext:
+	    info->size_known = info->size_exact = true;
+	    size = file_size;
+	    break;
+#ifdef BXZSTR_ZSTD_STREAM_WRAPPER_HPP
+	case zstd:
+	    info->size_known = info->size_exact = zstd_seek_table_size(sbuf, file_size, &size)
+		|| zstd_frames_size(sbuf, file_size, &size);
+	    break;
+#endif
+#ifdef BXZSTR_LZMA_STREAM_WRAPPER_HPP
+	case lzma:
+	    info->size_known = info->size_exact = xz_index_size(sbuf, file_size, &size);
+	    break;
+#endif
+#ifdef BXZSTR_Z_STREAM_WRAPPER_HPP
+	case bgzf:
+	    info->size_known = info->size_exact = bgzf_blocks_size(sbuf, file_size, &size);
+	    break;
+	case z: {
+	    unsigned char header[2];
+	    unsigned char isize[4];
+	    if (file_size >= 18 && read_at(sbuf, 0, header, 2) && header[0] == 0x1F && header[1] == 0x8B
+		&& read_at(sbuf, file_size - 4, isize, 4)) {
+		info->size_known = true;
+		size = load_le32(isize);
+	    }
+	    break;
+	}
+#endif
+	default:
+	    break;
+    }
+    info->content_size = (info->size_known ? size : 0);
+    sbuf->pubseekpos(start, std::ios_base::in);
+    return true;
+}
+} // namespace detail
+
+// Reads the uncompressed size of the data in `sbuf`, which must be
+// seekable, from the headers, trailers or index of its format instead
+// of decompressing it. The format is detected from the data when
+// `type` is none. The position of `sbuf` is restored.
+inline content_info stat(std::streambuf *sbuf, const Compression type = none) {
+    content_info info;
+    if (!detail::stat_streambuf(sbuf, type, &info))
+	throw std::runtime_error("bxzstr: stat() needs a seekable stream.");
+    return info;
+}
+
+// As above for the file at `path`. Brotli is recognized from the file
+// extension when `type` is none.
+inline content_info stat(const std::string &path, const Compression type = none) {
+    std::filebuf file;
+    if (!file.open(path, std::ios_base::in | std::ios_base::binary))
+	throw std::runtime_error("bxzstr: could not open " + path + ".");
+    return stat(&file, type == none ? detect_type_from_extension(path) : type);
+}
+} // namespace bxz
+
+#endif
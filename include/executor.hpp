@@ -0,0 +1,211 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_EXECUTOR_HPP
+#define BXZSTR_EXECUTOR_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bxz {
+// Runs the parallel work of bxzstr, e.g. the items of
+// compress_batch(). Implement submit() to run the work on an existing
+// thread pool, and pass the executor in params::executor_p or to
+// set_default_executor().
+class executor {
+  public:
+    virtual ~executor() {}
+    // Runs `task` on some thread, eventually. Tasks do not throw.
+    virtual void submit(std::function<void()> task) = 0;
+    // Number of tasks that run at the same time.
+    virtual unsigned concurrency() const = 0;
+};
+
+// A work-stealing thread pool: each worker has a queue, tasks submitted
+// from a worker go to its own queue and the others are spread over the
+// queues in turn. A worker runs the newest task of its own queue, and
+// takes the oldest task of another queue when its own is empty.
+class thread_pool_executor : public executor {
+  public:
+    // `threads` workers, or one per core if 0.
+    explicit thread_pool_executor(unsigned threads = 0)
+	    : pending(0), stopping(false), next_queue(0) {
+	if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+	for (unsigned i = 0; i < threads; ++i) this->queues.emplace_back(new worker_queue());
+	for (unsigned i = 0; i < threads; ++i) this->workers.emplace_back(&thread_pool_executor::run, this, i);
+    }
+    // Runs the tasks left in the queues and joins the workers.
+    ~thread_pool_executor() {
+	{
+	    std::lock_guard<std::mutex> lock(this->mutex);
+	    this->stopping = true;
+	}
+	this->wake.notify_all();
+	for (std::thread &worker : this->workers) worker.join();
+    }
+    thread_pool_executor(const thread_pool_executor &) = delete;
+    thread_pool_executor & operator = (const thread_pool_executor &) = delete;
+
+    void submit(std::function<void()> task) override {
+	const worker_slot &slot = current_worker();
+	const std::size_t i = (slot.pool == this ? slot.index : this->next_queue++ % this->queues.size());
+	{
+	    std::lock_guard<std::mutex> lock(this->queues[i]->mutex);
+	    this->queues[i]->tasks.push_back(std::move(task));
+	}
+	{
+	    std::lock_guard<std::mutex> lock(this->mutex);
+	    ++this->pending;
+	}
+	this->wake.notify_one();
+    }
+    unsigned concurrency() const override { return (unsigned)this->workers.size(); }
+
+  private:
+    struct worker_queue {
+	std::mutex mutex;
+	std::deque<std::function<void()>> tasks;
+    };
+    struct worker_slot {
+	const thread_pool_executor *pool;
+	std::size_t index;
+    };
+
+    std::vector<std::unique_ptr<worker_queue>> queues;
+    std::vector<std::thread> workers;
+    // Tasks in the queues, guarded by `mutex`.
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::size_t pending;
+    bool stopping;
+    std::atomic<std::size_t> next_queue;
+
+    // The pool and queue of the worker running on this thread.
+    static worker_slot& current_worker() {
+	thread_local worker_slot slot = { nullptr, 0 };
+	return slot;
+    }
+    bool take(const std::size_t i, std::function<void()> *task) {
+	for (std::size_t k = 0; k < this->queues.size(); ++k) {
+	    worker_queue &queue = *this->queues[(i + k) % this->queues.size()];
+	    std::lock_guard<std::mutex> lock(queue.mutex);
+	    if (queue.tasks.empty()) continue;
+	    if (k == 0) {
+		*task = std::move(queue.tasks.back());
+		queue.tasks.pop_back();
+	    } else {
+		*task = std::move(queue.tasks.front());
+		queue.tasks.pop_front();
+	    }
+	    return true;
+	}
+	return false;
+    }
+    void run(const std::size_t i) {
+	current_worker().pool = this;
+	current_worker().index = i;
+	while (true) {
+	    {
+		std::unique_lock<std::mutex> lock(this->mutex);
+		this->wake.wait(lock, [this]() { return this->pending > 0 || this->stopping; });
+		if (this->pending == 0) return;
+		--this->pending;
+	    }
+	    // a task is in some queue for each count taken from `pending`
+	    std::function<void()> task;
+	    while (!this->take(i, &task)) std::this_thread::yield();
+	    task();
+	}
+    }
+}; // class thread_pool_executor
+
+namespace detail {
+struct default_executor_slot {
+    std::mutex mutex;
+    std::shared_ptr<executor> executor_p;
+};
+inline default_executor_slot& default_executor_slot_instance() {
+    static default_executor_slot slot;
+    return slot;
+}
+} // namespace detail
+
+// The executor used when params::executor_p is not set, a
+// thread_pool_executor with one thread per core that is started on
+// first use.
+inline std::shared_ptr<executor> default_executor() {
+    detail::default_executor_slot &slot = detail::default_executor_slot_instance();
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    if (!slot.executor_p) slot.executor_p = std::make_shared<thread_pool_executor>();
+    return slot.executor_p;
+}
+// Replaces the default executor, e.g. with a thread_pool_executor of
+// another size or an adapter to the thread pool of the application.
+// Work already submitted keeps the previous executor alive until done.
+// nullptr restores the default.
+inline void set_default_executor(const std::shared_ptr<executor> &executor_p) {
+    detail::default_executor_slot &slot = detail::default_executor_slot_instance();
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    slot.executor_p = executor_p;
+}
+
+namespace detail {
+// Calls `item` for 0, ..., n_items - 1 on the calling thread and at most
+// `max_threads` - 1 tasks submitted to `pool` (0 for as many as
+// `pool` runs at once), which take the next index when done with one.
+// Returns when all items are done. The calling thread works through the
+// items too, so nested calls from the tasks of `pool` finish even when
+// all its workers are busy; tasks that start after the items ran out
+// return at once.
+inline void parallel_for(const std::shared_ptr<executor> &pool, const std::size_t n_items, unsigned max_threads,
+			 const std::function<void(std::size_t)> &item) {
+    struct shared_state {
+	std::mutex mutex;
+	std::condition_variable done;
+	std::atomic<std::size_t> next;
+	std::size_t n_items;
+	unsigned running;
+	const std::function<void(std::size_t)> *item;
+    };
+    if (max_threads == 0) max_threads = pool->concurrency();
+    const std::size_t helpers = std::min<std::size_t>(std::max(1u, max_threads) - 1, n_items > 0 ? n_items - 1 : 0);
+    std::shared_ptr<shared_state> state = std::make_shared<shared_state>();
+    state->next = 0;
+    state->n_items = n_items;
+    state->running = 0;
+    state->item = &item;
+    const auto work = [](shared_state &s) {
+	for (std::size_t i = s.next++; i < s.n_items; i = s.next++) (*s.item)(i);
+    };
+    for (std::size_t i = 0; i < helpers; ++i) {
+	pool->submit([state, work]() {
+	    {
+		std::lock_guard<std::mutex> lock(state->mutex);
+		if (state->next >= state->n_items) return;
+		++state->running;
+	    }
+	    work(*state);
+	    std::lock_guard<std::mutex> lock(state->mutex);
+	    if (--state->running == 0) state->done.notify_all();
+	});
+    }
+    work(*state);
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&state]() { return state->running == 0; });
+}
+} // namespace detail
+} // namespace bxz
+
+#endif
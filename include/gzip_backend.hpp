@@ -0,0 +1,71 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "config.hpp"
+
+#ifndef BXZSTR_GZIP_BACKEND_HPP
+#define BXZSTR_GZIP_BACKEND_HPP
+
+#include <atomic>
+#include <stdexcept>
+
+namespace bxz {
+// Libraries that can read and write bxz::z streams. zlib-ng (native
+// API) and ISA-L are used when bxzstr is configured with
+// BXZSTR_ZLIB_NG_SUPPORT or BXZSTR_ISAL_SUPPORT, on top of zlib.
+// gzip_backend_default picks the backend set with set_gzip_backend(),
+// or zlib-ng if it is available and zlib otherwise.
+enum GzipBackend { gzip_backend_default, gzip_backend_zlib, gzip_backend_zlib_ng, gzip_backend_isal };
+
+inline bool gzip_backend_available(const GzipBackend backend) {
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+    switch (backend) {
+	case gzip_backend_default: return true;
+	case gzip_backend_zlib: return true;
+#if defined(BXZSTR_ZLIB_NG_SUPPORT) && (BXZSTR_ZLIB_NG_SUPPORT) == 1
+	case gzip_backend_zlib_ng: return true;
+#endif
+#if defined(BXZSTR_ISAL_SUPPORT) && (BXZSTR_ISAL_SUPPORT) == 1
+	case gzip_backend_isal: return true;
+#endif
+	default: return false;
+    }
+#else
+    (void)backend;
+    return false;
+#endif
+}
+
+namespace detail {
+inline std::atomic<int>& default_gzip_backend() {
+    static std::atomic<int> backend(gzip_backend_default);
+    return backend;
+}
+
+// The backend used for a stream that requested `backend`.
+inline GzipBackend resolve_gzip_backend(const GzipBackend backend) {
+    GzipBackend resolved = (backend != gzip_backend_default
+			    ? backend : (GzipBackend)default_gzip_backend().load());
+    if (resolved == gzip_backend_default)
+	resolved = (gzip_backend_available(gzip_backend_zlib_ng) ? gzip_backend_zlib_ng : gzip_backend_zlib);
+    if (!gzip_backend_available(resolved))
+	throw std::runtime_error("bxzstr: the requested gzip backend is not available in this build.");
+    return resolved;
+}
+} // namespace detail
+
+// Sets the backend used by bxz::z streams that do not request one in
+// their params. Throws if the backend was not compiled in.
+inline void set_gzip_backend(const GzipBackend backend) {
+    if (!gzip_backend_available(backend))
+	throw std::runtime_error("bxzstr: the requested gzip backend is not available in this build.");
+    detail::default_gzip_backend() = backend;
+}
+inline GzipBackend gzip_backend() { return detail::resolve_gzip_backend(gzip_backend_default); }
+} // namespace bxz
+
+#endif
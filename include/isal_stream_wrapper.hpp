@@ -0,0 +1,130 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1 && defined(BXZSTR_ISAL_SUPPORT) && (BXZSTR_ISAL_SUPPORT) == 1
+
+#ifndef BXZSTR_ISAL_STREAM_WRAPPER_HPP
+#define BXZSTR_ISAL_STREAM_WRAPPER_HPP
+
+#include <isa-l/igzip_lib.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "stream_wrapper.hpp"
+#include "z_stream_wrapper.hpp"
+#include "params.hpp"
+
+namespace bxz {
+/// Exception class thrown by failed ISA-L operations. Derives from
+/// zException, since ISA-L is a backend for bxz::z.
+class isalException : public zException {
+  public:
+    isalException(const std::string &msg, const int ret)
+	    : zException("isa-l: [" + std::to_string(ret) + "]: " + msg) {}
+}; // class isalException
+
+namespace detail {
+// bxz::z backend using the igzip streaming API of ISA-L. Takes the
+// zlib flush values that bxz_run, bxz_flush and bxz_finish return for
+// bxz::z.
+class isal_stream_wrapper final : public stream_wrapper {
+  public:
+    isal_stream_wrapper(const bool _is_input = true, const int _level = Z_DEFAULT_COMPRESSION)
+	    : isal_stream_wrapper(_is_input, params(_level)) {}
+    isal_stream_wrapper(const bool _is_input, const params &p)
+	    : is_input(_is_input), started(false), finished(false), ret(0) {
+	if (is_input) {
+	    istate.reset(new inflate_state());
+	    isal_inflate_init(istate.get());
+	} else {
+	    zstate.reset(new isal_zstream());
+	    isal_deflate_init(zstate.get());
+	    zstate->gzip_flag = IGZIP_GZIP;
+	    zstate->level = isal_level(p.level);
+	    level_buf.resize(level_buf_size(zstate->level));
+	    zstate->level_buf = level_buf.data();
+	    zstate->level_buf_size = level_buf.size();
+	}
+    }
+
+    int decompress(const int = Z_NO_FLUSH) override {
+	if (!started) {
+	    if (istate->avail_in == 0) return ISAL_DECOMP_OK;
+	    // ISA-L does not tell gzip and zlib apart, and bxz::z is both
+	    istate->crc_flag = (istate->next_in[0] == 0x1F ? ISAL_GZIP : ISAL_ZLIB);
+	    started = true;
+	}
+	ret = isal_inflate(istate.get());
+	if (ret < 0) throw isalException("isal_inflate() failed", ret);
+	finished = (istate->block_state == ISAL_BLOCK_FINISH);
+	return ret;
+    }
+    int compress(const int _flags = Z_NO_FLUSH) override {
+	zstate->end_of_stream = (_flags == Z_FINISH);
+	zstate->flush = (_flags == Z_SYNC_FLUSH ? SYNC_FLUSH : (_flags == Z_FULL_FLUSH ? FULL_FLUSH : NO_FLUSH));
+	ret = isal_deflate(zstate.get());
+	if (ret != COMP_OK) throw isalException("isal_deflate() failed", ret);
+	finished = (zstate->internal_state.state == ZSTATE_END);
+	return ret;
+    }
+    bool stream_end() const override { return finished; }
+    bool done() const override { return stream_end(); }
+    std::size_t memory_usage() const override {
+	return is_input ? sizeof(inflate_state) : sizeof(isal_zstream) + level_buf.size();
+    }
+
+    const uint8_t* next_in() const override { return is_input ? istate->next_in : zstate->next_in; }
+    long avail_in() const override { return is_input ? istate->avail_in : zstate->avail_in; }
+    uint8_t* next_out() const override { return is_input ? istate->next_out : zstate->next_out; }
+    long avail_out() const override { return is_input ? istate->avail_out : zstate->avail_out; }
+
+    void set_next_in(const unsigned char* in) override {
+	if (is_input) istate->next_in = const_cast<uint8_t*>(in); else zstate->next_in = const_cast<uint8_t*>(in);
+    }
+    void set_avail_in(long in) override {
+	if (is_input) istate->avail_in = (uint32_t)in; else zstate->avail_in = (uint32_t)in;
+    }
+    void set_next_out(const uint8_t* in) override {
+	if (is_input) istate->next_out = const_cast<uint8_t*>(in); else zstate->next_out = const_cast<uint8_t*>(in);
+    }
+    void set_avail_out(long in) override {
+	if (is_input) istate->avail_out = (uint32_t)in; else zstate->avail_out = (uint32_t)in;
+    }
+
+  private:
+    bool is_input;
+    bool started;
+    bool finished;
+    int ret;
+
+    std::unique_ptr<inflate_state> istate;
+    std::unique_ptr<isal_zstream> zstate;
+    std::vector<uint8_t> level_buf;
+
+    // zlib levels 1-9 to the ISA-L levels 0-3
+    static uint32_t isal_level(const int level) {
+	if (level < 0) return 2; // Z_DEFAULT_COMPRESSION
+	if (level <= 2) return 0;
+	if (level <= 5) return 1;
+	return (level <= 8 ? 2 : 3);
+    }
+    static std::size_t level_buf_size(const uint32_t level) {
+	switch (level) {
+	    case 0: return ISAL_DEF_LVL0_DEFAULT;
+	    case 1: return ISAL_DEF_LVL1_DEFAULT;
+	    case 2: return ISAL_DEF_LVL2_DEFAULT;
+	    default: return ISAL_DEF_LVL3_DEFAULT;
+	}
+    }
+}; // class isal_stream_wrapper
+} // namespace detail
+} // namespace bxz
+
+#endif
+#endif
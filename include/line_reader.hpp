@@ -0,0 +1,106 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_LINE_READER_HPP
+#define BXZSTR_LINE_READER_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <string>
+
+#include "chunk.hpp"
+
+namespace bxz {
+// Splits the decompressed data of an istreambuf or ifstream into lines,
+// a faster std::getline(). The delimiter is found with memchr() in the
+// chunks of the output buffer (see next_chunk()), and lines are
+// returned as chunks that point into the buffer. Only a line that
+// continues past the end of a chunk is copied, into a carry buffer
+// that is reused for all lines. A line is valid until the next line is
+// read, and does not include the delimiter.
+//   bxz::ifstream in("reads.fastq.gz");
+//   for (const bxz::chunk &line : bxz::line_reader(in)) ...
+class line_reader {
+  public:
+    template <typename Source>
+    explicit line_reader(Source &source, const char _delim = '\n')
+	    : next_chunk([&source]() { return source.next_chunk(); }), delim(_delim), buffered(), carry() {}
+
+    // Reads the next line into `line`. Returns false at the end of the
+    // input. The last line need not end with the delimiter.
+    bool next(chunk *line) {
+	bool carrying = false;
+	while (true) {
+	    if (this->buffered.empty()) {
+		this->buffered = this->next_chunk();
+		if (this->buffered.empty()) {
+		    if (carrying) *line = chunk(this->carry.data(), this->carry.size());
+		    return carrying;
+		}
+	    }
+	    const char *end = static_cast<const char*>(std::memchr(this->buffered.data, this->delim,
+								   this->buffered.size));
+	    if (end != nullptr) {
+		const std::size_t size = end - this->buffered.data;
+		if (carrying) {
+		    this->carry.append(this->buffered.data, size);
+		    *line = chunk(this->carry.data(), this->carry.size());
+		} else {
+		    *line = chunk(this->buffered.data, size);
+		}
+		this->buffered = chunk(end + 1, this->buffered.size - size - 1);
+		return true;
+	    }
+	    if (!carrying) this->carry.clear();
+	    this->carry.append(this->buffered.data, this->buffered.size);
+	    this->buffered = chunk();
+	    carrying = true;
+	}
+    }
+
+    class iterator {
+      public:
+	typedef std::input_iterator_tag iterator_category;
+	typedef chunk value_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef const chunk* pointer;
+	typedef const chunk& reference;
+
+	iterator() : reader(nullptr), current() {}
+	explicit iterator(line_reader *_reader) : reader(_reader), current() { ++*this; }
+
+	reference operator*() const { return this->current; }
+	pointer operator->() const { return &this->current; }
+	iterator& operator++() {
+	    if (!this->reader->next(&this->current)) this->reader = nullptr;
+	    return *this;
+	}
+	// Only the end of the lines compares equal to itself.
+	bool operator==(const iterator &other) const { return this->reader == other.reader; }
+	bool operator!=(const iterator &other) const { return this->reader != other.reader; }
+
+      private:
+	line_reader *reader;
+	chunk current;
+    };
+    // The lines that are left, read once.
+    iterator begin() { return iterator(this); }
+    iterator end() { return iterator(); }
+
+  private:
+    std::function<chunk()> next_chunk;
+    char delim;
+    // The part of the last chunk after the last line
+    chunk buffered;
+    // A line that continues past the end of a chunk
+    std::string carry;
+}; // class line_reader
+} // namespace bxz
+
+#endif
@@ -0,0 +1,232 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#if defined(BXZSTR_LZ4_SUPPORT) && (BXZSTR_LZ4_SUPPORT) == 1
+
+#ifndef BXZSTR_LZ4_STREAM_WRAPPER_HPP
+#define BXZSTR_LZ4_STREAM_WRAPPER_HPP
+
+#include <lz4.h>
+#include <lz4hc.h>
+#include <lz4frame.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <exception>
+
+#include "stream_wrapper.hpp"
+#include "params.hpp"
+
+namespace bxz {
+/// Exception class thrown by failed lz4 operations.
+class lz4Exception : public std::exception {
+  public:
+    lz4Exception(const size_t err) : msg("lz4 error: ") {
+	this->msg += "[" + std::to_string(err) + "]: ";
+        this->msg += LZ4F_getErrorName(err);
+    }
+    lz4Exception(const std::string _msg) : msg(_msg) {}
+
+    const char * what() const noexcept { return this->msg.c_str(); }
+
+  private:
+    std::string msg;
+
+}; // class lz4Exception
+
+namespace detail {
+// LZ4F compression level for `p`. The fast compressor is used unless
+// params::lz4_hc is set, so that the default level 6 of the streams
+// compresses at memory speed: levels of 1 and above use the default
+// acceleration, and a level -n the acceleration n. With lz4_hc, the
+// level is the HC level (3-12).
+inline int lz4_frame_level(const params &p) {
+    if (p.lz4_hc) return std::max(LZ4HC_CLEVEL_MIN, std::min(p.level, LZ4HC_CLEVEL_MAX));
+    return std::min(p.level, 0);
+}
+
+// Wraps the LZ4 frame API, with the level from lz4_frame_level().
+//
+// LZ4F_compressUpdate(), LZ4F_flush() and LZ4F_compressEnd() need room
+// for their worst case output. When the caller's output buffer is
+// smaller than that, the output is written to a staging buffer and
+// handed out over the following calls to compress().
+class lz4_stream_wrapper final : public stream_wrapper {
+  public:
+    lz4_stream_wrapper(const bool _isInput = true, const int level = 0)
+	    : lz4_stream_wrapper(_isInput, params(level)) {}
+    lz4_stream_wrapper(const bool _isInput, const params &p)
+	    : isInput(_isInput), ret(1), begun(false), ended(false),
+	      buffInSize(0), buffIn(nullptr), buffOutSize(0), buffOut(nullptr),
+	      dctx(nullptr), cctx(nullptr), staged_pos(0) {
+	std::memset(&this->prefs, 0, sizeof(this->prefs));
+	std::memset(&this->dopts, 0, sizeof(this->dopts));
+	if (this->isInput) {
+	    this->check(LZ4F_createDecompressionContext(&this->dctx, LZ4F_VERSION));
+#if LZ4_VERSION_NUMBER >= 10904
+	    if (!p.verify_checksums) this->dopts.skipChecksums = 1;
+#endif
+	} else {
+	    if (p.lz4_block_size_id != 0 && (p.lz4_block_size_id < LZ4F_max64KB || p.lz4_block_size_id > LZ4F_max4MB))
+		throw lz4Exception("lz4 error: invalid block size id " + std::to_string(p.lz4_block_size_id));
+	    this->check(LZ4F_createCompressionContext(&this->cctx, LZ4F_VERSION));
+	    this->prefs.compressionLevel = lz4_frame_level(p);
+	    this->prefs.frameInfo.blockSizeID = (LZ4F_blockSizeID_t)p.lz4_block_size_id;
+	    this->prefs.frameInfo.blockMode = (p.lz4_block_independent ? LZ4F_blockIndependent : LZ4F_blockLinked);
+	    this->prefs.frameInfo.contentSize = p.lz4_content_size;
+	    this->prefs.frameInfo.contentChecksumFlag = (p.checksum == checksum_on
+							 ? LZ4F_contentChecksumEnabled : LZ4F_noContentChecksum);
+	}
+    }
+
+    ~lz4_stream_wrapper() {
+	if (this->isInput) {
+	    LZ4F_freeDecompressionContext(this->dctx);
+	} else {
+	    LZ4F_freeCompressionContext(this->cctx);
+	}
+    }
+
+    int decompress(const int = 0) override {
+	size_t out_size = this->buffOutSize;
+	size_t in_size = this->buffInSize;
+	this->ret = this->check(LZ4F_decompress(this->dctx, this->buffOut, &out_size,
+						this->buffIn, &in_size, &this->dopts));
+	this->advance(in_size, out_size);
+
+	return (int)(this->ret > 0);
+    }
+
+    int compress(const int endStream) override {
+	if (!this->drain()) return 0;
+	if (!this->begun) {
+	    this->emit(LZ4F_HEADER_SIZE_MAX, [this](void *dst, size_t cap) {
+		    return LZ4F_compressBegin(this->cctx, dst, cap, &this->prefs);
+		});
+	    this->begun = true;
+	}
+	while (this->buffInSize > 0 && this->staged.empty()) {
+	    const size_t block = this->block_size();
+	    const size_t chunk = (this->buffInSize < block ? this->buffInSize : block);
+	    this->emit(LZ4F_compressBound(chunk, &this->prefs), [this, chunk](void *dst, size_t cap) {
+		    return LZ4F_compressUpdate(this->cctx, dst, cap, this->buffIn, chunk, nullptr);
+		});
+	    this->advance(chunk, 0);
+	}
+	if (this->buffInSize > 0 || !this->staged.empty()) return 0;
+
+	if (endStream == 2) {
+	    // flush the buffered input but keep the frame open
+	    this->emit(LZ4F_compressBound(0, &this->prefs), [this](void *dst, size_t cap) {
+		    return LZ4F_flush(this->cctx, dst, cap, nullptr);
+		});
+	} else if (endStream && !this->ended) {
+	    this->emit(LZ4F_compressBound(0, &this->prefs), [this](void *dst, size_t cap) {
+		    return LZ4F_compressEnd(this->cctx, dst, cap, nullptr);
+		});
+	    this->ended = true;
+	}
+	this->ret = (this->ended && this->staged.empty() ? 0 : 1);
+
+	return (int)ret;
+    }
+
+    bool stream_end() const override { return this->ret == 0; }
+    bool done() const override { return this->stream_end(); }
+    std::size_t memory_usage() const override {
+	// LZ4F_decompress() keeps up to one block and the 64 KiB window
+	// of linked blocks; the compressor keeps one block and the match
+	// finder state.
+	const size_t block = (size_t)4 << 20; // largest block
+	if (this->isInput) return 2*block + ((size_t)64 << 10);
+	return this->block_size() + ((size_t)64 << 10) + this->staged.capacity()
+	    + (this->prefs.compressionLevel < LZ4HC_CLEVEL_MIN ? sizeof(LZ4_stream_t) : sizeof(LZ4_streamHC_t));
+    }
+
+    const unsigned char* next_in() const override { return static_cast<unsigned char*>(this->buffIn); }
+    long avail_in() const override { return this->buffInSize; }
+    unsigned char* next_out() const override { return static_cast<unsigned char*>(this->buffOut); }
+    long avail_out() const override { return this->buffOutSize; }
+
+    void set_next_in(const unsigned char* in) override { this->buffIn = (void*)in; }
+    void set_avail_in(long in) override { this->buffInSize = (size_t)in; }
+    void set_next_out(const unsigned char* in) override { this->buffOut = (void*)in; }
+    void set_avail_out(long in) override { this->buffOutSize = (size_t)in; }
+
+  private:
+    bool isInput;
+    size_t ret;
+    bool begun;
+    bool ended;
+
+    size_t buffInSize;
+    void* buffIn;
+    size_t buffOutSize;
+    void* buffOut;
+
+    LZ4F_dctx* dctx;
+    LZ4F_cctx* cctx;
+    LZ4F_preferences_t prefs;
+    LZ4F_decompressOptions_t dopts;
+
+    std::vector<char> staged;
+    size_t staged_pos;
+
+    size_t check(const size_t code) const {
+	if (LZ4F_isError(code)) throw lz4Exception(code);
+	return code;
+    }
+    size_t block_size() const {
+	switch (this->prefs.frameInfo.blockSizeID) {
+	    case LZ4F_max256KB: return (size_t)256 << 10;
+	    case LZ4F_max1MB: return (size_t)1 << 20;
+	    case LZ4F_max4MB: return (size_t)4 << 20;
+	    default: return (size_t)64 << 10;
+	}
+    }
+    void advance(const size_t in, const size_t out) {
+	this->buffIn = static_cast<char*>(this->buffIn) + in;
+	this->buffInSize -= in;
+	this->buffOut = static_cast<char*>(this->buffOut) + out;
+	this->buffOutSize -= out;
+    }
+    // Runs `op` directly on the output buffer if `bound` bytes fit
+    // there, and on the staging buffer otherwise.
+    template <typename Op>
+    void emit(const size_t bound, Op op) {
+	if (this->buffOutSize >= bound) {
+	    this->advance(0, this->check(op(this->buffOut, this->buffOutSize)));
+	} else {
+	    this->staged.resize(bound);
+	    this->staged.resize(this->check(op(this->staged.data(), bound)));
+	    this->staged_pos = 0;
+	    this->drain();
+	}
+    }
+    // Copies staged output to the output buffer. Returns true when
+    // the staging buffer is empty.
+    bool drain() {
+	if (this->staged.empty()) return true;
+	size_t n = this->staged.size() - this->staged_pos;
+	if (n > this->buffOutSize) n = this->buffOutSize;
+	std::memcpy(this->buffOut, this->staged.data() + this->staged_pos, n);
+	this->advance(0, n);
+	this->staged_pos += n;
+	if (this->staged_pos < this->staged.size()) return false;
+	this->staged.clear();
+	this->staged_pos = 0;
+	return true;
+    }
+
+}; // class lz4_stream_wrapper
+} // namespace detail
+} // namespace bxz
+
+#endif
+#endif
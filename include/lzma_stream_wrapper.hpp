@@ -17,6 +17,7 @@
 #include <exception>
 
 #include "stream_wrapper.hpp"
+#include "params.hpp"
 
 namespace bxz {
 /// Exception class thrown by failed liblzma operations.
@@ -68,17 +69,22 @@ class lzmaException : public std::exception {
 }; // class lzmaException
 
 namespace detail {
-class lzma_stream_wrapper : public lzma_stream, public stream_wrapper {
+class lzma_stream_wrapper final : public lzma_stream, public stream_wrapper {
   public:
     lzma_stream_wrapper(const bool _is_input = true, const int _level = 2, const int _flags = 0)
-	    : lzma_stream(LZMA_STREAM_INIT), is_input(_is_input) {
+	    : lzma_stream_wrapper(_is_input, params(_level), _flags) {}
+    lzma_stream_wrapper(const bool _is_input, const params &p, const int _flags = 0)
+	    : lzma_stream(LZMA_STREAM_INIT), is_input(_is_input),
+	      preset((uint32_t)p.level | p.lzma_preset_flags) {
 	lzma_ret ret;
 	if (is_input) {
 	    lzma_stream::avail_in = 0;
 	    lzma_stream::next_in = NULL;
-	    ret = lzma_auto_decoder(this, UINT64_MAX, _flags);
+	    const uint32_t flags = (uint32_t)_flags | (p.verify_checksums ? 0 : LZMA_IGNORE_CHECK);
+	    ret = lzma_auto_decoder(this, (p.memory_limit > 0 ? p.memory_limit : UINT64_MAX), flags);
 	} else {
-	    ret = lzma_easy_encoder(this, _level, LZMA_CHECK_CRC64);
+	    const lzma_check check = (p.checksum == checksum_off ? LZMA_CHECK_NONE : LZMA_CHECK_CRC64);
+	    ret = lzma_easy_encoder(this, preset, check);
 	}
 	if (ret != LZMA_OK) throw lzmaException(ret);
     }
@@ -86,7 +92,8 @@ class lzma_stream_wrapper : public lzma_stream, public stream_wrapper {
 
     int decompress(const int = 0) override {
 	ret = lzma_code(this, LZMA_RUN);
-	if (ret != LZMA_OK && ret != LZMA_STREAM_END && ret) throw lzmaException(ret);
+	// LZMA_BUF_ERROR: no progress in two calls, as in zlib
+	if (ret != LZMA_OK && ret != LZMA_STREAM_END && ret != LZMA_BUF_ERROR) throw lzmaException(ret);
 	return (int)ret;
     }
     int compress(const int _flags = LZMA_RUN) override {
@@ -97,6 +104,9 @@ class lzma_stream_wrapper : public lzma_stream, public stream_wrapper {
     }
     bool stream_end() const override { return this->ret == LZMA_STREAM_END; }
     bool done() const override { return (this->ret == LZMA_BUF_ERROR || this->stream_end()); }
+    std::size_t memory_usage() const override {
+	return is_input ? lzma_memusage(this) : lzma_easy_encoder_memusage(preset);
+    }
 
     const uint8_t* next_in() const override { return lzma_stream::next_in; }
     long avail_in() const override { return lzma_stream::avail_in; }
@@ -111,6 +121,7 @@ class lzma_stream_wrapper : public lzma_stream, public stream_wrapper {
   private:
     bool is_input;
     lzma_ret ret;
+    uint32_t preset;
 }; // class lzma_stream_wrapper
 } // namespace detail
 } // namespace bxz
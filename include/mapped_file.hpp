@@ -0,0 +1,97 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_MAPPED_FILE_HPP
+#define BXZSTR_MAPPED_FILE_HPP
+
+#include <string>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <fstream>
+#include <sstream>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace bxz {
+namespace detail {
+// A read-only view of a whole file, memory mapped where mmap() is
+// available. Files that cannot be mapped, such as pipes, files in /proc
+// that report a size of 0, or files on file systems without mmap(), are
+// read into memory instead.
+class mapped_file {
+  public:
+    explicit mapped_file(const std::string &path) : addr(nullptr), length(0), is_mapped(false) {
+#if defined(_WIN32)
+	std::ifstream in(path, std::ios_base::in | std::ios_base::binary);
+	if (!in) throw std::runtime_error("bxzstr: could not open " + path + ".");
+	std::ostringstream oss;
+	oss << in.rdbuf();
+	this->contents = oss.str();
+#else
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) throw std::runtime_error("bxzstr: could not open " + path + ".");
+	struct stat st;
+	if (::fstat(fd, &st) != 0) {
+	    ::close(fd);
+	    throw std::runtime_error("bxzstr: could not stat " + path + ".");
+	}
+	if (S_ISREG(st.st_mode) && st.st_size > 0) {
+	    void *p = ::mmap(nullptr, (std::size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	    if (p != MAP_FAILED) {
+		::madvise(p, (std::size_t)st.st_size, MADV_SEQUENTIAL);
+		::close(fd);
+		this->addr = static_cast<const char*>(p);
+		this->length = (std::size_t)st.st_size;
+		this->is_mapped = true;
+		return;
+	    }
+	}
+	char buff[1 << 16];
+	while (true) {
+	    const ssize_t n = ::read(fd, buff, sizeof(buff));
+	    if (n == 0) break;
+	    if (n < 0 && errno == EINTR) continue;
+	    if (n < 0) {
+		::close(fd);
+		throw std::runtime_error("bxzstr: could not read " + path + ".");
+	    }
+	    this->contents.append(buff, (std::size_t)n);
+	}
+	::close(fd);
+#endif
+	this->addr = this->contents.data();
+	this->length = this->contents.size();
+    }
+    ~mapped_file() {
+#if !defined(_WIN32)
+	if (this->is_mapped) ::munmap(const_cast<char*>(this->addr), this->length);
+#endif
+    }
+    mapped_file(const mapped_file &) = delete;
+    mapped_file & operator = (const mapped_file &) = delete;
+
+    const char* data() const { return this->addr; }
+    std::size_t size() const { return this->length; }
+    // False if the file was read into memory.
+    bool mapped() const { return this->is_mapped; }
+
+  private:
+    const char* addr;
+    std::size_t length;
+    bool is_mapped;
+    std::string contents;
+}; // class mapped_file
+} // namespace detail
+} // namespace bxz
+
+#endif
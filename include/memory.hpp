@@ -0,0 +1,81 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_MEMORY_HPP
+#define BXZSTR_MEMORY_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+
+namespace bxz {
+namespace detail {
+inline std::atomic<uint64_t>& global_memory_budget() {
+    static std::atomic<uint64_t> budget(0);
+    return budget;
+}
+inline std::atomic<uint64_t>& global_memory_in_use() {
+    static std::atomic<uint64_t> in_use(0);
+    return in_use;
+}
+
+// Memory limit for a codec given the limit of its stream (0 for no
+// limit) and what is left of the global budget.
+inline uint64_t effective_memory_limit(const uint64_t stream_limit) {
+    uint64_t limit = stream_limit;
+    const uint64_t budget = global_memory_budget().load();
+    if (budget > 0) {
+	const uint64_t in_use = global_memory_in_use().load();
+	const uint64_t left = (in_use < budget ? budget - in_use : 1);
+	if (limit == 0 || left < limit) limit = left;
+    }
+    return limit;
+}
+
+// Registers the memory used by a stream in the global accounting.
+class memory_reservation {
+  public:
+    memory_reservation() : reserved(0) {}
+    memory_reservation(const memory_reservation &) = delete;
+    memory_reservation & operator = (const memory_reservation &) = delete;
+    ~memory_reservation() { global_memory_in_use() -= reserved; }
+
+    // Throws if the new amount does not fit in the global budget.
+    void reserve(const uint64_t bytes) {
+	const uint64_t budget = global_memory_budget().load();
+	const uint64_t in_use = (global_memory_in_use() += bytes);
+	if (budget > 0 && bytes > 0 && in_use > budget) {
+	    global_memory_in_use() -= bytes;
+	    throw std::runtime_error("bxzstr: global memory budget exceeded.");
+	}
+	reserved += bytes;
+    }
+    // Updates the amount without checking the budget.
+    void update(const uint64_t bytes) {
+	global_memory_in_use() += bytes;
+	global_memory_in_use() -= reserved;
+	reserved = bytes;
+    }
+    uint64_t size() const { return reserved; }
+
+  private:
+    uint64_t reserved;
+}; // class memory_reservation
+} // namespace detail
+
+// Total memory that all bxzstr streams in the process may use (0 for
+// no limit). Streams that would exceed the budget throw on
+// construction, and the decoders of new streams are limited to what
+// is left of it.
+inline void set_memory_budget(const uint64_t bytes) { detail::global_memory_budget() = bytes; }
+inline uint64_t memory_budget() { return detail::global_memory_budget().load(); }
+
+// Memory currently used by all bxzstr streams in the process.
+inline uint64_t memory_in_use() { return detail::global_memory_in_use().load(); }
+} // namespace bxz
+
+#endif
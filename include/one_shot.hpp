@@ -0,0 +1,500 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_ONE_SHOT_HPP
+#define BXZSTR_ONE_SHOT_HPP
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "compression_types.hpp"
+#include "content_size.hpp"
+
+#ifdef BXZSTR_ZSTD_STREAM_WRAPPER_HPP
+#include <zstd_errors.h>
+#endif
+
+namespace bxz {
+namespace detail {
+// Largest input or output handed to a codec in one call.
+static const uint64_t max_call_size = (uint64_t)1 << 30;
+
+// Decompresses a buffer in memory through the stream wrappers,
+// starting a new codec at each member or frame end.
+class buffer_decompressor {
+  public:
+    buffer_decompressor(const Compression _type, const params &_prm, const char *in, const uint64_t in_size)
+	    : type(_type), prm(_prm), next_in(reinterpret_cast<const unsigned char*>(in)), in_left(in_size),
+	      stalled(false) {}
+
+    // Decompresses into the `out_size` bytes at `out` until they are
+    // full or the input has been decompressed. Returns the number of
+    // bytes written.
+    uint64_t run(char *out, const uint64_t out_size) {
+	uint64_t total = 0;
+	while (!this->finished() && total < out_size) {
+	    if (!this->strm_p) init_stream(this->type, true, this->prm, &this->strm_p);
+	    const long in_size = (long)std::min(this->in_left, max_call_size);
+	    const long avail = (long)std::min(out_size - total, max_call_size);
+	    this->strm_p->set_next_in(this->next_in);
+	    this->strm_p->set_avail_in(in_size);
+	    this->strm_p->set_next_out(reinterpret_cast<uint8_t*>(out + total));
+	    this->strm_p->set_avail_out(avail);
+	    this->strm_p->decompress();
+	    const long consumed = in_size - this->strm_p->avail_in();
+	    const long produced = avail - this->strm_p->avail_out();
+	    this->next_in += consumed;
+	    this->in_left -= (uint64_t)consumed;
+	    total += (uint64_t)produced;
+	    if (this->strm_p->stream_end()) this->strm_p.reset();
+	    else if (consumed == 0 && produced < avail) this->stalled = true;
+	}
+	return total;
+    }
+    bool finished() const { return this->stalled || (!this->strm_p && this->in_left == 0); }
+    // The input ended in the middle of a member or frame.
+    bool truncated() const { return this->stalled; }
+
+  private:
+    Compression type;
+    params prm;
+    const unsigned char *next_in;
+    uint64_t in_left;
+    bool stalled;
+    std::unique_ptr<stream_wrapper> strm_p;
+}; // class buffer_decompressor
+
+#ifdef BXZSTR_ZSTD_STREAM_WRAPPER_HPP
+// zstd contexts that the one-shot functions reuse within a thread.
+class zstd_thread_contexts {
+  public:
+    zstd_thread_contexts() : cctx_p(nullptr), dctx_p(nullptr) {}
+    ~zstd_thread_contexts() {
+	ZSTD_freeCCtx(this->cctx_p);
+	ZSTD_freeDCtx(this->dctx_p);
+    }
+    zstd_thread_contexts(const zstd_thread_contexts &) = delete;
+    zstd_thread_contexts & operator = (const zstd_thread_contexts &) = delete;
+
+    ZSTD_CCtx* cctx() {
+	if (this->cctx_p == nullptr && (this->cctx_p = ZSTD_createCCtx()) == nullptr)
+	    throw zstdException("ZSTD_createCCtx() failed!");
+	return this->cctx_p;
+    }
+    ZSTD_DCtx* dctx() {
+	if (this->dctx_p == nullptr && (this->dctx_p = ZSTD_createDCtx()) == nullptr)
+	    throw zstdException("ZSTD_createDCtx() failed!");
+	return this->dctx_p;
+    }
+
+  private:
+    ZSTD_CCtx *cctx_p;
+    ZSTD_DCtx *dctx_p;
+}; // class zstd_thread_contexts
+
+inline zstd_thread_contexts& thread_zstd_contexts() {
+    thread_local zstd_thread_contexts contexts;
+    return contexts;
+}
+
+inline std::shared_ptr<const zstd_dictionary> one_shot_dictionary(const uint32_t id) {
+    std::shared_ptr<const zstd_dictionary> dict = find_zstd_dictionary(id);
+    if (!dict) throw zstdException("zstd error: dictionary " + std::to_string(id) + " is not registered");
+    return dict;
+}
+#endif
+
+#ifdef BXZSTR_Z_STREAM_WRAPPER_HPP
+// zlib streams that the one-shot functions reset and reuse within a
+// thread instead of allocating the state and window on every call.
+class z_thread_streams {
+  public:
+    z_thread_streams() : deflater_init(false), inflater_init(false), deflater_level(0),
+			 deflater_strm(z_stream()), inflater_strm(z_stream()) {}
+    ~z_thread_streams() {
+	if (this->deflater_init) deflateEnd(&this->deflater_strm);
+	if (this->inflater_init) inflateEnd(&this->inflater_strm);
+    }
+    z_thread_streams(const z_thread_streams &) = delete;
+    z_thread_streams & operator = (const z_thread_streams &) = delete;
+
+    // A gzip deflate stream at `level`. The stream is made anew when the
+    // level changes: before zlib 1.2.12, deflateParams() on a reset
+    // stream could flush a block into the output buffer of the last call.
+    z_stream* deflater(const int level) {
+	int ret = Z_OK;
+	if (this->deflater_init && level != this->deflater_level) {
+	    deflateEnd(&this->deflater_strm);
+	    this->deflater_init = false;
+	}
+	if (!this->deflater_init) {
+	    ret = deflateInit2(&this->deflater_strm, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+	    this->deflater_init = (ret == Z_OK);
+	} else {
+	    deflateReset(&this->deflater_strm);
+	}
+	if (ret != Z_OK) throw zException("deflate one-shot", ret);
+	this->deflater_level = level;
+	return &this->deflater_strm;
+    }
+    // An inflate stream that reads gzip and zlib headers.
+    z_stream* inflater() {
+	if (!this->inflater_init) {
+	    const int ret = inflateInit2(&this->inflater_strm, 15 + 32);
+	    if (ret != Z_OK) throw zException("inflate one-shot", ret);
+	    this->inflater_init = true;
+	} else {
+	    inflateReset(&this->inflater_strm);
+	}
+	return &this->inflater_strm;
+    }
+
+  private:
+    bool deflater_init;
+    bool inflater_init;
+    int deflater_level;
+    z_stream deflater_strm;
+    z_stream inflater_strm;
+}; // class z_thread_streams
+
+inline z_thread_streams& thread_z_streams() {
+    thread_local z_thread_streams streams;
+    return streams;
+}
+
+// Runs `strm` over the whole input and output, which zlib takes in
+// pieces of up to 4 GiB. Returns false if the output ran out.
+inline bool z_run_buffer(z_stream *strm, const bool is_input, const char *src, const uint64_t src_size,
+			 char *dst, const uint64_t dst_capacity, uint64_t *written) {
+    strm->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(src));
+    strm->next_out = reinterpret_cast<Bytef*>(dst);
+    uint64_t in_left = src_size;
+    uint64_t out_left = dst_capacity;
+    while (true) {
+	const uInt avail_in = (uInt)std::min<uint64_t>(in_left, UINT_MAX);
+	const uInt avail_out = (uInt)std::min<uint64_t>(out_left, UINT_MAX);
+	strm->avail_in = avail_in;
+	strm->avail_out = avail_out;
+	const int ret = (is_input ? inflate(strm, Z_NO_FLUSH)
+			 : deflate(strm, avail_in == in_left ? Z_FINISH : Z_NO_FLUSH));
+	in_left -= avail_in - strm->avail_in;
+	out_left -= avail_out - strm->avail_out;
+	if (ret == Z_STREAM_END) {
+	    if (!is_input || in_left == 0) break;
+	    inflateReset(strm); // next member
+	    continue;
+	}
+	if (ret == Z_BUF_ERROR && out_left == 0) return false;
+	if (ret == Z_BUF_ERROR) throw zException("truncated input", ret);
+	if (ret != Z_OK) throw zException(is_input ? "inflate one-shot" : "deflate one-shot", ret);
+    }
+    *written = dst_capacity - out_left;
+    return true;
+}
+#endif
+} // namespace detail
+
+// Upper bound of the size of `src_size` bytes compressed with
+// bxz::compress() in `type`.
+inline std::size_t compress_bound(const Compression type, const std::size_t src_size) {
+    switch (type) {
+	case plaintext:
+	    return src_size;
+#ifdef BXZSTR_Z_STREAM_WRAPPER_HPP
+	case z:
+	    // compressBound() counts the 6 bytes of the zlib wrapper, gzip has 18
+	    return (std::size_t)compressBound((uLong)src_size) + 12;
+#endif
+#ifdef BXZSTR_BGZF_STREAM_WRAPPER_HPP
+	case bgzf:
+	    // blocks of up to 0xff00 input bytes and 64 KiB output, and the EOF block
+	    return (src_size/0xff00 + 1)*((std::size_t)1 << 16) + 28;
+#endif
+#ifdef BXZSTR_BZ_STREAM_WRAPPER_HPP
+	case bz2:
+	    return src_size + src_size/100 + 600;
+#endif
+#ifdef BXZSTR_LZMA_STREAM_WRAPPER_HPP
+	case lzma:
+	    return lzma_stream_buffer_bound(src_size);
+#endif
+#ifdef BXZSTR_ZSTD_STREAM_WRAPPER_HPP
+	case zstd:
+	    return ZSTD_compressBound(src_size);
+#endif
+#ifdef BXZSTR_LZ4_STREAM_WRAPPER_HPP
+	case lz4:
+	    return LZ4F_compressFrameBound(src_size, nullptr);
+#endif
+#ifdef BXZSTR_BROTLI_STREAM_WRAPPER_HPP
+	case brotli:
+	    return BrotliEncoderMaxCompressedSize(src_size);
+#endif
+	default:
+	    throw std::runtime_error("Unrecognized compression type.");
+    }
+}
+
+// Compresses the `src_size` bytes at `src` into the `dst_capacity`
+// bytes at `dst` in one call, and returns the compressed size. Throws
+// if `dst` is too small, which compress_bound() bytes never are. gzip
+// and zstd reuse a compressor cached in the calling thread, and the
+// other formats call the one-shot function of their library; unlike
+// the streams, no buffers are allocated. Of `prm`, the level,
+// zstd_dict_id and lz4_hc are used.
+inline std::size_t compress(const Compression type, const void *src, const std::size_t src_size,
+			    void *dst, const std::size_t dst_capacity, const params &prm) {
+    const int level = prm.level;
+    const char *in = static_cast<const char*>(src);
+    char *out = static_cast<char*>(dst);
+    bool fits = true;
+    std::size_t written = 0;
+    switch (type) {
+	case plaintext:
+	    fits = (src_size <= dst_capacity);
+	    if (fits && src_size > 0) std::memcpy(out, in, src_size);
+	    written = src_size;
+	    break;
+#ifdef BXZSTR_Z_STREAM_WRAPPER_HPP
+	case z: {
+	    uint64_t n = 0;
+	    fits = detail::z_run_buffer(detail::thread_z_streams().deflater(level), false, in, src_size,
+					out, dst_capacity, &n);
+	    written = (std::size_t)n;
+	    break;
+	}
+#endif
+#ifdef BXZSTR_BGZF_STREAM_WRAPPER_HPP
+	case bgzf: {
+	    // BGZF is written a block at a time by the stream wrapper anyway
+	    std::unique_ptr<detail::stream_wrapper> strm_p;
+	    init_stream(bgzf, false, params(level), &strm_p);
+	    strm_p->set_next_in(reinterpret_cast<const unsigned char*>(in));
+	    strm_p->set_avail_in((long)src_size);
+	    strm_p->set_next_out(reinterpret_cast<uint8_t*>(out));
+	    strm_p->set_avail_out((long)dst_capacity);
+	    while (!strm_p->done() && strm_p->avail_out() > 0) strm_p->compress(bxz_finish(bgzf));
+	    fits = strm_p->done();
+	    written = dst_capacity - (std::size_t)strm_p->avail_out();
+	    break;
+	}
+#endif
+#ifdef BXZSTR_BZ_STREAM_WRAPPER_HPP
+	case bz2: {
+	    unsigned int n = (unsigned int)std::min<std::size_t>(dst_capacity, UINT_MAX);
+	    const int ret = BZ2_bzBuffToBuffCompress(out, &n, const_cast<char*>(in), (unsigned int)src_size,
+						     std::max(1, std::min(level, 9)), 0, 30);
+	    if (ret != BZ_OK && ret != BZ_OUTBUFF_FULL) throw bzException(ret);
+	    fits = (ret == BZ_OK);
+	    written = n;
+	    break;
+	}
+#endif
+#ifdef BXZSTR_LZMA_STREAM_WRAPPER_HPP
+	case lzma: {
+	    std::size_t n = 0;
+	    const lzma_ret ret = lzma_easy_buffer_encode((uint32_t)level, LZMA_CHECK_CRC64, nullptr,
+							 reinterpret_cast<const uint8_t*>(in), src_size,
+							 reinterpret_cast<uint8_t*>(out), &n, dst_capacity);
+	    if (ret != LZMA_OK && ret != LZMA_BUF_ERROR) throw lzmaException(ret);
+	    fits = (ret == LZMA_OK);
+	    written = n;
+	    break;
+	}
+#endif
+#ifdef BXZSTR_ZSTD_STREAM_WRAPPER_HPP
+	case zstd: {
+	    ZSTD_CCtx *cctx = detail::thread_zstd_contexts().cctx();
+	    ZSTD_CCtx_reset(cctx, ZSTD_reset_session_and_parameters);
+	    size_t ret = 0;
+	    if (prm.zstd_dict_id != 0) {
+		ret = ZSTD_compress_usingCDict(cctx, out, dst_capacity, in, src_size,
+					       detail::one_shot_dictionary(prm.zstd_dict_id)->cdict(level));
+	    } else {
+		ret = ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level);
+		if (!ZSTD_isError(ret)) ret = ZSTD_compress2(cctx, out, dst_capacity, in, src_size);
+	    }
+	    fits = !(ZSTD_isError(ret) && ZSTD_getErrorCode(ret) == ZSTD_error_dstSize_tooSmall);
+	    if (fits && ZSTD_isError(ret)) throw zstdException(ret);
+	    written = ret;
+	    break;
+	}
+#endif
+#ifdef BXZSTR_LZ4_STREAM_WRAPPER_HPP
+	case lz4: {
+	    LZ4F_preferences_t prefs = LZ4F_preferences_t();
+	    prefs.compressionLevel = detail::lz4_frame_level(prm);
+	    prefs.frameInfo.contentSize = src_size;
+	    fits = (dst_capacity >= LZ4F_compressFrameBound(src_size, &prefs));
+	    if (fits) {
+		const size_t ret = LZ4F_compressFrame(out, dst_capacity, in, src_size, &prefs);
+		if (LZ4F_isError(ret)) throw lz4Exception(ret);
+		written = ret;
+	    }
+	    break;
+	}
+#endif
+#ifdef BXZSTR_BROTLI_STREAM_WRAPPER_HPP
+	case brotli: {
+	    written = dst_capacity;
+	    fits = BrotliEncoderCompress(std::max(0, std::min(level, BROTLI_MAX_QUALITY)), BROTLI_DEFAULT_WINDOW,
+					 BROTLI_DEFAULT_MODE, src_size, reinterpret_cast<const uint8_t*>(in),
+					 &written, reinterpret_cast<uint8_t*>(out)) == BROTLI_TRUE;
+	    break;
+	}
+#endif
+	default:
+	    throw std::runtime_error("Unrecognized compression type.");
+    }
+    if (!fits) throw std::runtime_error("bxzstr: the output buffer is too small.");
+    return written;
+}
+inline std::size_t compress(const Compression type, const void *src, const std::size_t src_size,
+			    void *dst, const std::size_t dst_capacity, const int level = 6) {
+    return compress(type, src, src_size, dst, dst_capacity, params(level));
+}
+
+inline std::string compress(const Compression type, const std::string &src, const int level = 6) {
+    std::string out(compress_bound(type, src.size()), '\0');
+    out.resize(compress(type, src.data(), src.size(), &out[0], out.size(), level));
+    return out;
+}
+
+namespace detail {
+// Format of `n` bytes at `src` from their magic bytes.
+inline Compression detect_buffer_type(const char *src, const std::size_t n) {
+    char magic[18] = { 0 };
+    std::memcpy(magic, src, std::min(n, sizeof(magic)));
+    return (n == 0 ? plaintext : detect_type(magic, magic + std::min(n, sizeof(magic))));
+}
+
+// The first size of an output string for `compressed_size` bytes of
+// input whose headers claim `recorded` bytes of output. The claim is
+// not trusted past 32 times the input, so that a corrupt or forged size
+// costs no more memory than the data can fill, and the string grows
+// from there when the data does compress better.
+inline uint64_t initial_output_size(const uint64_t recorded, const uint64_t compressed_size) {
+    return std::min(recorded, std::max<uint64_t>(32*compressed_size, (uint64_t)1 << 16));
+}
+} // namespace detail
+
+// Decompresses the `src_size` bytes at `src` into the `dst_capacity`
+// bytes at `dst` and returns the decompressed size. The format is
+// detected from the magic bytes when `type` is none, so brotli needs
+// `type`. Throws if `dst` is too small or the input is truncated. gzip
+// and zstd reuse a decompressor cached in the calling thread, and the
+// other formats are decompressed through their stream wrapper. zstd
+// frames use the registered dictionary with the ID in their header,
+// or the dictionary `prm.zstd_dict_id` if they carry none.
+inline std::size_t decompress(const void *src, const std::size_t src_size, void *dst, const std::size_t dst_capacity,
+			      Compression type = none, const params &prm = params()) {
+    const char *in = static_cast<const char*>(src);
+    char *out = static_cast<char*>(dst);
+    if (type == none) type = detail::detect_buffer_type(in, src_size);
+    bool fits = true;
+    std::size_t written = 0;
+    switch (type) {
+	case plaintext:
+	    fits = (src_size <= dst_capacity);
+	    if (fits && src_size > 0) std::memcpy(out, in, src_size);
+	    written = src_size;
+	    break;
+#ifdef BXZSTR_Z_STREAM_WRAPPER_HPP
+	case z: {
+	    uint64_t n = 0;
+	    fits = detail::z_run_buffer(detail::thread_z_streams().inflater(), true, in, src_size,
+					out, dst_capacity, &n);
+	    written = (std::size_t)n;
+	    break;
+	}
+#endif
+#ifdef BXZSTR_ZSTD_STREAM_WRAPPER_HPP
+	case zstd: {
+	    ZSTD_DCtx *dctx = detail::thread_zstd_contexts().dctx();
+	    const uint32_t frame_dict_id = ZSTD_getDictID_fromFrame(in, src_size);
+	    const uint32_t dict_id = (frame_dict_id != 0 ? frame_dict_id : prm.zstd_dict_id);
+	    const size_t ret = (dict_id != 0
+				? ZSTD_decompress_usingDDict(dctx, out, dst_capacity, in, src_size,
+							     detail::one_shot_dictionary(dict_id)->ddict())
+				: ZSTD_decompressDCtx(dctx, out, dst_capacity, in, src_size));
+	    fits = !(ZSTD_isError(ret) && ZSTD_getErrorCode(ret) == ZSTD_error_dstSize_tooSmall);
+	    if (fits && ZSTD_isError(ret)) throw zstdException(ret);
+	    written = ret;
+	    break;
+	}
+#endif
+	default: {
+	    detail::buffer_decompressor decompressor(type, prm, in, src_size);
+	    written = (std::size_t)decompressor.run(out, dst_capacity);
+	    char extra;
+	    fits = decompressor.finished() || (decompressor.run(&extra, 1) == 0 && decompressor.finished());
+	    if (fits && decompressor.truncated()) throw std::runtime_error("bxzstr: truncated input.");
+	    break;
+	}
+    }
+    if (!fits) throw std::runtime_error("bxzstr: the output buffer is too small.");
+    return written;
+}
+
+// As above into a string. The size is taken from the zstd frame header
+// when there is one frame that records it, or the gzip ISIZE trailer,
+// up to a limit set by the size of `src`, and the string grows as
+// needed otherwise.
+inline std::string decompress(const std::string &src, Compression type = none) {
+    if (type == none) type = detail::detect_buffer_type(src.data(), src.size());
+    std::string out;
+#ifdef BXZSTR_ZSTD_STREAM_WRAPPER_HPP
+    if (type == zstd && ZSTD_findFrameCompressedSize(src.data(), src.size()) == src.size()) {
+	const unsigned long long size = ZSTD_getFrameContentSize(src.data(), src.size());
+	if (size != ZSTD_CONTENTSIZE_UNKNOWN && size != ZSTD_CONTENTSIZE_ERROR
+	    && detail::initial_output_size(size, src.size()) == size) {
+	    out.resize((std::size_t)size);
+	    out.resize(decompress(src.data(), src.size(), &out[0], out.size(), type));
+	    return out;
+	}
+    }
+#endif
+    if (type == plaintext) return src;
+#ifdef BXZSTR_Z_STREAM_WRAPPER_HPP
+    if (type == z) {
+	// sized from the ISIZE trailer, which is exact for a single member
+	// of less than 4 GiB, and retried with more room otherwise
+	const uint64_t isize = (src.size() >= 18 ? detail::load_le32(reinterpret_cast<const unsigned char*>(
+						&src[src.size() - 4])) : 0);
+	uint64_t size = std::max<uint64_t>(detail::initial_output_size(isize, src.size()), (uint64_t)1 << 12);
+	while (true) {
+	    out.resize((std::size_t)size);
+	    uint64_t n = 0;
+	    if (detail::z_run_buffer(detail::thread_z_streams().inflater(), true, src.data(), src.size(),
+				     &out[0], out.size(), &n)) {
+		out.resize((std::size_t)n);
+		return out;
+	    }
+	    size *= 2;
+	}
+    }
+#endif
+    out.resize(std::max<std::size_t>(4*src.size(), (std::size_t)1 << 12));
+    detail::buffer_decompressor decompressor(type, params(), src.data(), src.size());
+    uint64_t total = 0;
+    while (true) {
+	total += decompressor.run(&out[(std::size_t)total], out.size() - total);
+	if (decompressor.finished()) break;
+	out.resize(2*out.size());
+    }
+    if (decompressor.truncated()) throw std::runtime_error("bxzstr: truncated input.");
+    out.resize((std::size_t)total);
+    return out;
+}
+} // namespace bxz
+
+#endif
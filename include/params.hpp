@@ -0,0 +1,204 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_PARAMS_HPP
+#define BXZSTR_PARAMS_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "executor.hpp"
+#include "gzip_backend.hpp"
+#include "stream_stats.hpp"
+
+namespace bxz {
+// What ostreambuf::sync() does to the compressed stream:
+//   finish_on_sync: end the stream and start a new one (new gzip
+//                   member, zstd frame, ...) on every sync().
+//   sync_flush:     flush the pending output so that it can be
+//                   decompressed, but keep the stream open until
+//                   the ostreambuf is closed or destroyed.
+//   low_latency:    as sync_flush, with small buffers and small
+//                   zstd blocks for streaming over pipes.
+enum FlushMode { finish_on_sync, sync_flush, low_latency };
+
+// Whether checksums are written when compressing. checksum_default
+// uses the default of each library.
+enum ChecksumMode { checksum_default, checksum_on, checksum_off };
+
+// Parameters passed to the stream wrappers when a stream is
+// initialized. Each codec only reads the fields that apply to it, and
+// fields that are left at 0 use the library defaults.
+struct params {
+    explicit params(const int _level = 6, const FlushMode _flush = finish_on_sync)
+	    : level(_level),
+	      flush(_flush),
+	      checksum(checksum_default),
+	      verify_checksums(true),
+	      memory_limit(0),
+	      collect_stats(false),
+	      on_stats(),
+	      executor_p(),
+	      max_threads(0),
+	      rsyncable(false),
+	      adaptive_level(false),
+	      adaptive_min_level(1),
+	      adaptive_max_level(0),
+	      z_window_bits(15),
+	      z_mem_level(8),
+	      z_strategy(0),
+	      z_backend(gzip_backend_default),
+	      z_inflate_back(false),
+	      bz2_work_factor(30),
+	      bz2_small(false),
+	      lzma_preset_flags(0),
+	      zstd_window_log(0),
+	      zstd_long_distance_matching(false),
+	      zstd_strategy(0),
+	      zstd_target_block_size(0),
+	      zstd_workers(0),
+	      zstd_window_log_max(0),
+	      zstd_dict_id(0),
+	      zstd_patch_from(),
+	      zstd_pledged_size(0),
+	      lz4_block_size_id(0),
+	      lz4_block_independent(false),
+	      lz4_content_size(0),
+	      lz4_hc(false),
+	      brotli_window_log(0),
+	      brotli_mode(0) {}
+
+    // All codecs
+    int level;
+    FlushMode flush;
+
+    // Integrity checks. `checksum` applies to liblzma (CRC64 or none),
+    // zstd (ZSTD_c_checksumFlag) and lz4 (the content checksum, off
+    // unless checksum_on); gzip and bzip2 always write
+    // theirs. Setting `verify_checksums` to false skips verification
+    // when decompressing: gzip and zlib streams are then inflated raw
+    // with the header and trailer parsed by bxzstr.
+    ChecksumMode checksum;
+    bool verify_checksums;
+
+    // Memory limit in bytes for decompression (0 for no limit other
+    // than the global budget, see memory.hpp). Sets the liblzma
+    // memlimit and ZSTD_d_windowLogMax, and selects the bzip2 small
+    // mode if the normal mode does not fit.
+    uint64_t memory_limit;
+
+    // Collect the stream_stats returned by stats() of the stream
+    // buffers and file streams (see stream_stats.hpp). Setting
+    // `on_stats` also collects them, and calls it as the stream
+    // progresses. The stream does no timing when both are unset.
+    bool collect_stats;
+    stats_callback on_stats;
+
+    // Executor of the parallel work of the stream or call, e.g. the
+    // items of compress_batch(), or nullptr for default_executor().
+    // `max_threads` caps the threads that the work uses at a time, the
+    // calling thread included, so that one large job leaves the rest of
+    // a shared executor to the others; 0 allows all its threads.
+    std::shared_ptr<executor> executor_p;
+    unsigned max_threads;
+
+    // Cut gzip and zstd output at content-defined boundaries, like
+    // `gzip --rsyncable`, so that edits to the input only change the
+    // compressed output around them and the rest stays deduplicable.
+    // gzip is reset with Z_FULL_FLUSH. zstd uses ZSTD_c_rsyncable when
+    // zstd_workers is set and starts a new frame otherwise.
+    bool rsyncable;
+
+    // Adapt the gzip or zstd level to the sink, like `zstd --adapt`:
+    // ostreambuf raises the level while writes to the sink take longer
+    // than compressing, and lowers it when compressing takes longer,
+    // within [adaptive_min_level, adaptive_max_level] (0 for the
+    // highest level of the codec). zstd compresses in a worker thread
+    // when zstd_workers is 0, since levels only change within a frame
+    // with workers.
+    bool adaptive_level;
+    int adaptive_min_level;
+    int adaptive_max_level;
+
+    // zlib: deflateInit2()/inflateInit2() arguments. The gzip wrapper
+    // and header detection bits are added to z_window_bits by the
+    // stream wrapper. z_strategy takes e.g. Z_FILTERED or Z_RLE.
+    int z_window_bits;
+    int z_mem_level;
+    int z_strategy;
+
+    // Library used for the bxz::z stream, see gzip_backend.hpp. ISA-L
+    // ignores z_window_bits, z_mem_level and z_strategy, and streams
+    // that skip checksum verification are read with zlib-ng or zlib.
+    GzipBackend z_backend;
+
+    // Decode gzip input with zlib's inflateBack() in
+    // bxz::decompress_to() when the zlib backend is used. inflateBack()
+    // skips a copy per window but cannot be paused, so the streams
+    // always use inflate().
+    bool z_inflate_back;
+
+    // bzip2: workFactor for compression, and the small-memory mode of
+    // BZ2_bzDecompressInit() for decompression.
+    int bz2_work_factor;
+    bool bz2_small;
+
+    // liblzma: flags or'ed with the preset level, e.g. LZMA_PRESET_EXTREME.
+    uint32_t lzma_preset_flags;
+
+    // zstd compression: ZSTD_c_windowLog,
+    // ZSTD_c_enableLongDistanceMatching, ZSTD_c_strategy,
+    // ZSTD_c_targetCBlockSize and ZSTD_c_nbWorkers.
+    int zstd_window_log;
+    bool zstd_long_distance_matching;
+    int zstd_strategy;
+    int zstd_target_block_size;
+    int zstd_workers;
+
+    // zstd decompression: ZSTD_d_windowLogMax.
+    int zstd_window_log_max;
+
+    // zstd: ID of a dictionary registered with add_zstd_dictionary()
+    // (see zstd_dictionary.hpp) to compress with. Readers pick the
+    // dictionary from the frame header, and use this one for frames
+    // that do not record a dictionary ID.
+    uint32_t zstd_dict_id;
+
+    // zstd patch mode: path of a reference file (e.g. the previous
+    // version of the data) that is memory mapped and used as a prefix
+    // with ZSTD_CCtx_refPrefix()/ZSTD_DCtx_refPrefix(). Readers need the
+    // same reference. Writers enable long distance matching and a
+    // window that covers the reference, as `zstd --patch-from`.
+    std::string zstd_patch_from;
+
+    // zstd compression: the uncompressed size of the frame, if known,
+    // set with ZSTD_CCtx_setPledgedSrcSize() and recorded in the frame
+    // header where bxz::stat() finds it. 0 for unknown. A pledged size
+    // must match the number of bytes written to the frame.
+    uint64_t zstd_pledged_size;
+
+    // lz4 compression: the frame block size (LZ4F_max64KB to
+    // LZ4F_max4MB), independent instead of linked blocks, and the
+    // uncompressed size stored in the frame header. A content size
+    // must match the number of bytes written to the frame.
+    int lz4_block_size_id;
+    bool lz4_block_independent;
+    uint64_t lz4_content_size;
+    // Use the high compression (HC) compressor of lz4, with the level
+    // as the HC level, instead of the fast one.
+    bool lz4_hc;
+
+    // brotli compression: BROTLI_PARAM_LGWIN (10-24) and
+    // BROTLI_PARAM_MODE, e.g. BROTLI_MODE_TEXT. The level is the
+    // brotli quality (0-11).
+    int brotli_window_log;
+    int brotli_mode;
+};
+} // namespace bxz
+
+#endif
@@ -0,0 +1,34 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_PROBES_HPP
+#define BXZSTR_PROBES_HPP
+
+// USDT (SystemTap/DTrace) probes in the `bxzstr` provider, compiled in
+// when BXZSTR_USDT_PROBES is defined to 1 and <sys/sdt.h> is
+// available. The first argument is the address of the stream buffer,
+// which tells the streams apart, and the second the Compression type.
+//   buffer_alloc(buf, type, bytes)
+//   underflow_entry(buf, type)              underflow_return(buf, type, bytes out)
+//   overflow_entry(buf, type, bytes in)     overflow_return(buf, type)
+//   decompress_begin(buf, type, avail in)   decompress_end(buf, type, avail in, bytes out)
+//   compress_begin(buf, type, avail in)     compress_end(buf, type, avail in, bytes out)
+//   stream_end(buf, type, is input)         seek_to_zero(buf, type)
+//   sync(buf, type)
+// Without BXZSTR_USDT_PROBES, the probes compile to nothing.
+#if defined(BXZSTR_USDT_PROBES) && (BXZSTR_USDT_PROBES) == 1
+#include <sys/sdt.h>
+#define BXZSTR_PROBE2(name, a, b) DTRACE_PROBE2(bxzstr, name, a, b)
+#define BXZSTR_PROBE3(name, a, b, c) DTRACE_PROBE3(bxzstr, name, a, b, c)
+#define BXZSTR_PROBE4(name, a, b, c, d) DTRACE_PROBE4(bxzstr, name, a, b, c, d)
+#else
+#define BXZSTR_PROBE2(name, a, b) ((void)0)
+#define BXZSTR_PROBE3(name, a, b, c) ((void)0)
+#define BXZSTR_PROBE4(name, a, b, c, d) ((void)0)
+#endif
+
+#endif
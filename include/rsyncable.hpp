@@ -0,0 +1,74 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_RSYNCABLE_HPP
+#define BXZSTR_RSYNCABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bxz {
+namespace detail {
+// Average distance between the boundaries where gzip output is reset
+// with a full flush (as in `gzip --rsyncable`), and where zstd output
+// starts a new frame when ZSTD_c_rsyncable is not available.
+static const uint64_t rsync_flush_mask = ((uint64_t)1 << 13) - 1;
+static const uint64_t rsync_frame_mask = ((uint64_t)1 << 20) - 1;
+
+// Finds content-defined boundaries in the input with a polynomial
+// rolling hash over the last 32 bytes, built like the one zstd uses for
+// ZSTD_c_rsyncable but with another multiplier, so the boundaries are
+// not the same as zstd's. A boundary follows every byte where the masked
+// bits of the hash are all set, so an edit only moves the boundaries
+// next to it and the compressed output elsewhere stays the same.
+class rsync_boundaries {
+  public:
+    explicit rsync_boundaries(const uint64_t _mask) : mask(_mask), hash(0), pos(0), filled(0), prime_power(1) {
+	for (std::size_t i = 0; i < window_size; ++i) {
+	    this->prime_power *= prime;
+	    this->window[i] = 0;
+	}
+    }
+
+    // Scans up to `*n` bytes from `p`. Returns true and sets `*n` to the
+    // length up to and including the boundary if one is found.
+    bool scan(const unsigned char *p, std::size_t *n) {
+	for (std::size_t i = 0; i < *n; ++i) {
+	    const unsigned char out = this->window[this->pos];
+	    this->window[this->pos] = p[i];
+	    this->pos = (this->pos + 1) % window_size;
+	    this->hash = this->hash*prime + (p[i] + char_offset);
+	    if (this->filled < window_size) {
+		++this->filled;
+		continue;
+	    }
+	    this->hash -= (out + char_offset)*this->prime_power;
+	    if ((this->hash & this->mask) == this->mask) {
+		*n = i + 1;
+		return true;
+	    }
+	}
+	return false;
+    }
+
+  private:
+    static const std::size_t window_size = 32;
+    // PRIME64_1 of xxHash64
+    static const uint64_t prime = 0x9E3779B185EBCA87ULL;
+    static const uint64_t char_offset = 10;
+
+    uint64_t mask;
+    uint64_t hash;
+    std::size_t pos;
+    std::size_t filled;
+    uint64_t prime_power;
+    unsigned char window[window_size];
+}; // class rsync_boundaries
+} // namespace detail
+} // namespace bxz
+
+#endif
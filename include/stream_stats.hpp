@@ -0,0 +1,82 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_STREAM_STATS_HPP
+#define BXZSTR_STREAM_STATS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace bxz {
+// Counters of an istreambuf or ostreambuf, collected when
+// params::collect_stats is set. The times tell whether a stream is
+// bound by the underlying streambuf (io_ns), the codec (codec_ns) or
+// the code reading or writing the stream (caller_ns, the time between
+// calls to underflow() or overflow()).
+struct stream_stats {
+    stream_stats()
+	    : compressed_bytes(0), uncompressed_bytes(0), buffer_calls(0), streams(0),
+	      io_ns(0), codec_ns(0), caller_ns(0), peak_memory(0) {}
+
+    uint64_t compressed_bytes;
+    uint64_t uncompressed_bytes;
+    // underflow() calls of an istreambuf, overflow() calls of an ostreambuf
+    uint64_t buffer_calls;
+    // gzip members, zstd frames, ... that were ended
+    uint64_t streams;
+    // sgetn() on the source of an istreambuf, sputn() on the sink of an ostreambuf
+    uint64_t io_ns;
+    uint64_t codec_ns;
+    uint64_t caller_ns;
+    // peak of memory_usage()
+    uint64_t peak_memory;
+};
+
+// Called with the counters at the end of every underflow() or
+// overflow() that moved data, and when an ostreambuf is closed.
+typedef std::function<void(const stream_stats&)> stats_callback;
+
+namespace detail {
+// Collects the stream_stats of a stream buffer. Each call to one of the
+// timing functions adds the time since the previous one to a counter.
+class stats_collector {
+  public:
+    explicit stats_collector(const stats_callback &_callback)
+	    : callback(_callback), last(std::chrono::steady_clock::now()) {}
+
+    // Entry to underflow() or overflow(), after the caller's time.
+    void begin_call() { this->stats.caller_ns += this->lap(); ++this->stats.buffer_calls; }
+    void io_done() { this->stats.io_ns += this->lap(); }
+    void codec_done() { this->stats.codec_ns += this->lap(); }
+    // Exit from the buffer, counting the bookkeeping as codec time.
+    void end_call(const std::size_t memory_usage, const bool notify) {
+	this->codec_done();
+	this->add_memory(memory_usage);
+	if (notify && this->callback) this->callback(this->stats);
+    }
+    void add_memory(const std::size_t memory_usage) {
+	if (memory_usage > this->stats.peak_memory) this->stats.peak_memory = memory_usage;
+    }
+
+    stream_stats stats;
+
+  private:
+    stats_callback callback;
+    std::chrono::steady_clock::time_point last;
+
+    uint64_t lap() {
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	const uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(now - this->last).count();
+	this->last = now;
+	return ns;
+    }
+}; // class stats_collector
+} // namespace detail
+} // namespace bxz
+
+#endif
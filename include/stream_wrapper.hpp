@@ -8,6 +8,9 @@
 #ifndef BXZSTR_STREAM_WRAPPER_HPP
 #define BXZSTR_STREAM_WRAPPER_HPP
 
+#include <cstddef>
+#include <cstdint>
+
 namespace bxz {
 namespace detail {
 class stream_wrapper {
@@ -16,10 +19,19 @@ class stream_wrapper {
     stream_wrapper() {};
     stream_wrapper(const bool _isInput, const int _level, const int _flags);
     virtual ~stream_wrapper() = default;
+    // Decompresses from next_in to next_out. Called without input after
+    // a call that filled the output, to take output that the codec still
+    // holds; no progress on such a call is not an error.
     virtual int decompress(const int _flags = 0) =0;
     virtual int compress(const int _flags = 0) =0;
     virtual bool stream_end() const =0;
     virtual bool done() const =0;
+    virtual std::size_t memory_usage() const =0;
+    // Changes the level of a compressor between calls to compress(),
+    // for params::adaptive_level. Returns false if the output buffer
+    // ran out before the change, which is retried with more
+    // room. Codecs that cannot change the level ignore it.
+    virtual bool set_level(const int) { return true; }
 
     virtual const uint8_t* next_in() const =0;
     virtual long avail_in() const =0;
@@ -0,0 +1,148 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+
+#ifndef BXZSTR_Z_INFLATE_BACK_HPP
+#define BXZSTR_Z_INFLATE_BACK_HPP
+
+#include <zlib.h>
+
+#include <streambuf>
+#include <stdexcept>
+#include <vector>
+#include <cstring>
+
+#include "z_stream_wrapper.hpp"
+#include "params.hpp"
+
+namespace bxz {
+namespace detail {
+// Decodes gzip members from one streambuf to another with
+// inflateBack(), which writes straight from its window to the sink
+// instead of copying through a separate output buffer like inflate().
+// inflateBack() runs a deflate stream to the end in one call and
+// cannot be resumed, so this only serves callers that consume the
+// whole stream (bxz::decompress_to) and not istreambuf::underflow().
+// The gzip header and trailer are parsed here.
+class z_inflate_back {
+  public:
+    z_inflate_back(const params &p)
+	    : verify(p.verify_checksums), window((std::size_t)1 << 15), in_buff(in_buff_size),
+	      next(nullptr), avail(0), src(nullptr), dst(nullptr), sink_failed(false), crc(0), isize(0) {
+	std::memset(&strm, 0, sizeof(strm));
+	const int ret = inflateBackInit(&strm, 15, window.data());
+	if (ret != Z_OK) throw zException(strm.msg ? strm.msg : "inflateBackInit() failed", ret);
+    }
+    ~z_inflate_back() { inflateBackEnd(&strm); }
+    z_inflate_back(const z_inflate_back &) = delete;
+    z_inflate_back & operator = (const z_inflate_back &) = delete;
+
+    // Decompresses the gzip members in `_src` to `_dst`. Returns the
+    // number of bytes written.
+    uint64_t run(std::streambuf *_src, std::streambuf *_dst) {
+	src = _src;
+	dst = _dst;
+	uint64_t total = 0;
+	while (refill()) {
+	    parse_header();
+	    crc = crc32(0L, Z_NULL, 0);
+	    isize = 0;
+	    strm.next_in = const_cast<unsigned char*>(next);
+	    strm.avail_in = (uInt)avail;
+	    avail = 0; // handed to inflateBack()
+	    const int ret = inflateBack(&strm, read_input, this, write_output, this);
+	    if (sink_failed) throw std::runtime_error("bxzstr: could not write to the output stream.");
+	    if (ret != Z_STREAM_END) {
+		throw zException(strm.msg ? strm.msg : "unexpected end of file",
+				 ret == Z_BUF_ERROR ? Z_DATA_ERROR : ret);
+	    }
+	    next = strm.next_in;
+	    avail = strm.avail_in;
+	    // trailer: CRC32 and ISIZE
+	    uint32_t trailer[2] = { 0, 0 };
+	    for (int i = 0; i < 8; ++i) trailer[i/4] |= (uint32_t)read_byte() << (8*(i % 4));
+	    if (verify && trailer[0] != (uint32_t)crc) throw zException("incorrect data check", Z_DATA_ERROR);
+	    if (verify && trailer[1] != (uint32_t)isize) throw zException("incorrect length check", Z_DATA_ERROR);
+	    total += isize;
+	}
+	return total;
+    }
+
+  private:
+    bool verify;
+    z_stream strm;
+    std::vector<unsigned char> window;
+    std::vector<unsigned char> in_buff;
+    const unsigned char* next;
+    std::size_t avail;
+    std::streambuf* src;
+    std::streambuf* dst;
+    bool sink_failed;
+    uLong crc;
+    uint64_t isize;
+
+    static const std::size_t in_buff_size = (std::size_t)1 << 17;
+
+    // Reads more input if all of it has been used. Returns false at
+    // the end of the input.
+    bool refill() {
+	if (avail > 0) return true;
+	next = in_buff.data();
+	avail = (std::size_t)src->sgetn(reinterpret_cast<char*>(in_buff.data()), (std::streamsize)in_buff.size());
+	return avail > 0;
+    }
+    unsigned char read_byte() {
+	if (!refill()) throw zException("unexpected end of file", Z_DATA_ERROR);
+	--avail;
+	return *next++;
+    }
+    void skip(std::size_t n) {
+	while (n-- > 0) read_byte();
+    }
+    void parse_header() {
+	unsigned char header[10];
+	for (int i = 0; i < 10; ++i) header[i] = read_byte();
+	if (header[0] != 0x1F || header[1] != 0x8B || header[2] != Z_DEFLATED)
+	    throw zException("incorrect gzip header", Z_DATA_ERROR);
+	const int flags = header[3];
+	if (flags & 0x04) {
+	    // FEXTRA
+	    std::size_t xlen = read_byte();
+	    xlen |= (std::size_t)read_byte() << 8;
+	    skip(xlen);
+	}
+	if (flags & 0x08) while (read_byte() != 0) {} // FNAME
+	if (flags & 0x10) while (read_byte() != 0) {} // FCOMMENT
+	if (flags & 0x02) skip(2); // FHCRC
+    }
+
+    static unsigned read_input(void *desc, z_const unsigned char **buf) {
+	z_inflate_back *self = static_cast<z_inflate_back*>(desc);
+	if (!self->refill()) return 0;
+	*buf = const_cast<unsigned char*>(self->next);
+	const unsigned n = (unsigned)self->avail;
+	self->next += n;
+	self->avail = 0;
+	return n;
+    }
+    static int write_output(void *desc, unsigned char *buf, unsigned len) {
+	z_inflate_back *self = static_cast<z_inflate_back*>(desc);
+	if (self->verify) self->crc = crc32(self->crc, buf, len);
+	self->isize += len;
+	if (self->dst->sputn(reinterpret_cast<char*>(buf), len) != (std::streamsize)len) {
+	    self->sink_failed = true;
+	    return 1;
+	}
+	return 0;
+    }
+}; // class z_inflate_back
+} // namespace detail
+} // namespace bxz
+
+#endif
+#endif
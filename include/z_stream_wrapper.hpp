@@ -11,12 +11,17 @@
 #define BXZSTR_Z_STREAM_WRAPPER_HPP
 
 #include <zlib.h>
+#if defined(BXZSTR_ZLIB_NG_SUPPORT) && (BXZSTR_ZLIB_NG_SUPPORT) == 1
+#include <zlib-ng.h>
+#endif
 
 #include <string>
 #include <sstream>
 #include <exception>
+#include <algorithm>
 
 #include "stream_wrapper.hpp"
+#include "params.hpp"
 
 namespace bxz {
 /// Exception class thrown by failed zlib operations.
@@ -56,59 +61,239 @@ class zException : public std::exception {
 }; // class zException
 
 namespace detail {
-class z_stream_wrapper : public z_stream, public stream_wrapper {
+// The zlib API used by basic_z_stream_wrapper: classic zlib, or the
+// native (zng_ prefixed) API of zlib-ng, which can be linked next to
+// zlib.
+struct zlib_api {
+    typedef z_stream stream_type;
+    static int inflate_init(stream_type *strm, const int window_bits) { return inflateInit2(strm, window_bits); }
+    static int deflate_init(stream_type *strm, const int level, const int window_bits,
+			    const int mem_level, const int strategy) {
+	return deflateInit2(strm, level, Z_DEFLATED, window_bits, mem_level, strategy);
+    }
+    static int inflate(stream_type *strm, const int flush) { return ::inflate(strm, flush); }
+    static int deflate(stream_type *strm, const int flush) { return ::deflate(strm, flush); }
+    static int inflate_end(stream_type *strm) { return ::inflateEnd(strm); }
+    static int deflate_end(stream_type *strm) { return ::deflateEnd(strm); }
+    static int deflate_params(stream_type *strm, const int level, const int strategy) {
+	return ::deflateParams(strm, level, strategy);
+    }
+};
+
+#if defined(BXZSTR_ZLIB_NG_SUPPORT) && (BXZSTR_ZLIB_NG_SUPPORT) == 1
+struct zlib_ng_api {
+    typedef zng_stream stream_type;
+    static int inflate_init(stream_type *strm, const int window_bits) { return zng_inflateInit2(strm, window_bits); }
+    static int deflate_init(stream_type *strm, const int level, const int window_bits,
+			    const int mem_level, const int strategy) {
+	return zng_deflateInit2(strm, level, Z_DEFLATED, window_bits, mem_level, strategy);
+    }
+    static int inflate(stream_type *strm, const int flush) { return zng_inflate(strm, flush); }
+    static int deflate(stream_type *strm, const int flush) { return zng_deflate(strm, flush); }
+    static int inflate_end(stream_type *strm) { return zng_inflateEnd(strm); }
+    static int deflate_end(stream_type *strm) { return zng_deflateEnd(strm); }
+    static int deflate_params(stream_type *strm, const int level, const int strategy) {
+	return zng_deflateParams(strm, level, strategy);
+    }
+};
+#endif
+
+template <typename Api>
+class basic_z_stream_wrapper final : public Api::stream_type, public stream_wrapper {
+    typedef typename Api::stream_type zs;
+
   public:
-    z_stream_wrapper(const bool _is_input = true,
-		     const int _level = Z_DEFAULT_COMPRESSION, const int = 0)
-	    : is_input(_is_input) {
+    basic_z_stream_wrapper(const bool _is_input = true,
+			   const int _level = Z_DEFAULT_COMPRESSION, const int = 0)
+	    : basic_z_stream_wrapper(_is_input, params(_level)) {}
+    basic_z_stream_wrapper(const bool _is_input, const params &p)
+	    : is_input(_is_input),
+	      window_bits(p.z_window_bits),
+	      mem_level(p.z_mem_level),
+	      strategy(p.z_strategy),
+	      raw(_is_input && !p.verify_checksums),
+	      raw_state(header_start),
+	      raw_after_skip(body),
+	      raw_header_pos(0),
+	      raw_skip(0),
+	      raw_flags(0) {
 	this->zalloc = Z_NULL;
 	this->zfree = Z_NULL;
 	this->opaque = Z_NULL;
 	if (is_input) {
-	    z_stream::avail_in = 0;
-	    z_stream::next_in = Z_NULL;
-	    ret = inflateInit2(this, 15+32);
+	    zs::avail_in = 0;
+	    zs::next_in = Z_NULL;
+	    // raw inflate skips the CRC32/Adler-32 computations; the
+	    // header and trailer are handled in decompress_raw()
+	    ret = Api::inflate_init(this, raw ? -p.z_window_bits : p.z_window_bits+32);
 	} else {
-	    ret = deflateInit2(this, _level, Z_DEFLATED, 15+16, 8, Z_DEFAULT_STRATEGY);
+	    ret = Api::deflate_init(this, p.level, p.z_window_bits+16, p.z_mem_level, p.z_strategy);
 	}
-	if (ret != Z_OK) throw zException(this->msg, ret);
+	// msg is not set if the arguments are rejected before initialization
+	if (ret != Z_OK) throw zException(this->msg ? this->msg : "invalid parameters", ret);
     }
-    ~z_stream_wrapper() {
+    ~basic_z_stream_wrapper() {
 	if (is_input) {
-	    inflateEnd(this);
+	    Api::inflate_end(this);
 	} else {
-	    deflateEnd(this);
+	    Api::deflate_end(this);
 	}
     }
 
     int decompress(const int _flags = Z_NO_FLUSH) override {
-	ret = inflate(this, _flags);
-	if (ret != Z_OK && ret != Z_STREAM_END) throw zException(this->msg, ret);
+	if (raw) return decompress_raw(_flags);
+	ret = Api::inflate(this, _flags);
+	// Z_BUF_ERROR: no progress, e.g. when called without input to
+	// drain the output; a truncated stream ends at the end of input
+	if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) throw zException(this->msg, ret);
 	return ret;
     }
     int compress(const int _flags = Z_NO_FLUSH) override {
-	ret = deflate(this, _flags);
+	ret = Api::deflate(this, _flags);
 	if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
 	    throw zException(this->msg, ret);
 	return ret;
     }
     bool stream_end() const override { return this->ret == Z_STREAM_END; }
     bool done() const override { return (this->ret == Z_BUF_ERROR || this->stream_end()); }
+    // deflateParams() ends the current deflate block with the old level,
+    // and returns Z_BUF_ERROR if that does not fit in avail_out.
+    bool set_level(const int level) override {
+	ret = Api::deflate_params(this, level, strategy);
+	if (ret != Z_OK && ret != Z_BUF_ERROR)
+	    throw zException(this->msg ? this->msg : "deflateParams() failed", ret);
+	return ret == Z_OK;
+    }
+    std::size_t memory_usage() const override {
+	// estimates from the zlib documentation
+	if (is_input) return ((std::size_t)1 << window_bits) + 7160;
+	return ((std::size_t)1 << (window_bits + 2)) + ((std::size_t)1 << (mem_level + 9)) + 6144;
+    }
 
-    const uint8_t* next_in() const override { return z_stream::next_in; }
-    long avail_in() const override { return z_stream::avail_in; }
-    uint8_t* next_out() const override { return z_stream::next_out; }
-    long avail_out() const override { return z_stream::avail_out; }
+    const uint8_t* next_in() const override { return zs::next_in; }
+    long avail_in() const override { return zs::avail_in; }
+    uint8_t* next_out() const override { return zs::next_out; }
+    long avail_out() const override { return zs::avail_out; }
 
-    void set_next_in(const unsigned char* in) override { z_stream::next_in = (unsigned char*)in; }
-    void set_avail_in(long in) override { z_stream::avail_in = in; }
-    void set_next_out(const uint8_t* in) override { z_stream::next_out = const_cast<Bytef*>(in); }
-    void set_avail_out(long in) override { z_stream::avail_out = in; }
+    void set_next_in(const unsigned char* in) override { zs::next_in = (unsigned char*)in; }
+    void set_avail_in(long in) override { zs::avail_in = in; }
+    void set_next_out(const uint8_t* in) override { zs::next_out = const_cast<uint8_t*>(in); }
+    void set_avail_out(long in) override { zs::avail_out = in; }
 
   private:
     bool is_input;
     int ret;
-}; // class bz_stream_wrapper
+    int window_bits;
+    int mem_level;
+    int strategy;
+
+    // State for inflating gzip or zlib streams without checksums
+    enum raw_states { header_start, header_fixed, header_extra_len, header_skip,
+		      header_name, header_comment, body, trailer, member_end };
+    bool raw;
+    raw_states raw_state;
+    raw_states raw_after_skip;
+    unsigned char raw_header[10];
+    unsigned raw_header_pos;
+    unsigned long raw_skip;
+    int raw_flags;
+
+    void consume(const unsigned long n) {
+	zs::next_in += n;
+	zs::avail_in -= n;
+    }
+    void parse_header() {
+	while (raw_state < body && zs::avail_in > 0) {
+	    const unsigned char b = *zs::next_in;
+	    switch (raw_state) {
+	    case header_start:
+		raw_header[0] = b;
+		raw_header_pos = 1;
+		consume(1);
+		raw_state = header_fixed;
+		break;
+	    case header_fixed:
+		raw_header[raw_header_pos++] = b;
+		consume(1);
+		if (raw_header[0] != 0x1F && raw_header_pos == 2) {
+		    // zlib header: CMF, FLG
+		    if (raw_header[1] & 0x20) throw zException("zlib: preset dictionaries are not supported without checksum verification");
+		    raw_skip = 4; // Adler-32
+		    raw_state = body;
+		} else if (raw_header_pos == 10) {
+		    // gzip header: ID1, ID2, CM, FLG, MTIME, XFL, OS
+		    if (raw_header[1] != 0x8B || raw_header[2] != Z_DEFLATED)
+			throw zException("zlib: incorrect gzip header");
+		    raw_flags = raw_header[3];
+		    raw_skip = 8; // CRC32 and ISIZE
+		    raw_header_pos = 0;
+		    raw_state = (raw_flags & 0x04 ? header_extra_len : header_name);
+		}
+		break;
+	    case header_extra_len:
+		raw_header[raw_header_pos++] = b;
+		consume(1);
+		if (raw_header_pos == 2) {
+		    raw_header_pos = (unsigned)raw_header[0] | ((unsigned)raw_header[1] << 8);
+		    raw_state = header_skip;
+		    raw_after_skip = header_name;
+		}
+		break;
+	    case header_skip: {
+		const unsigned long n = std::min((unsigned long)raw_header_pos, (unsigned long)zs::avail_in);
+		consume(n);
+		raw_header_pos -= n;
+		if (raw_header_pos == 0) raw_state = raw_after_skip;
+		break;
+	    }
+	    case header_name:
+	    case header_comment: {
+		const bool in_field = (raw_state == header_name ? raw_flags & 0x08 : raw_flags & 0x10);
+		if (in_field) {
+		    consume(1);
+		    if (b == 0) raw_flags &= (raw_state == header_name ? ~0x08 : ~0x10);
+		} else if (raw_state == header_name) {
+		    raw_state = header_comment;
+		} else if (raw_flags & 0x02) {
+		    // FHCRC
+		    raw_header_pos = 2;
+		    raw_state = header_skip;
+		    raw_after_skip = body;
+		} else {
+		    raw_state = body;
+		}
+		break;
+	    }
+	    default:
+		break;
+	    }
+	}
+    }
+    int decompress_raw(const int _flags) {
+	ret = Z_OK;
+	if (raw_state < body) parse_header();
+	if (raw_state == body && (zs::avail_in > 0 || zs::avail_out > 0)) {
+	    ret = Api::inflate(this, _flags);
+	    // Z_BUF_ERROR only means that more input is needed
+	    if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) throw zException(this->msg, ret);
+	    if (ret == Z_STREAM_END) raw_state = trailer;
+	    ret = Z_OK;
+	}
+	if (raw_state == trailer) {
+	    const unsigned long n = std::min(raw_skip, (unsigned long)zs::avail_in);
+	    consume(n);
+	    raw_skip -= n;
+	    if (raw_skip == 0) raw_state = member_end;
+	}
+	if (raw_state == member_end) ret = Z_STREAM_END;
+	return ret;
+    }
+}; // class basic_z_stream_wrapper
+
+typedef basic_z_stream_wrapper<zlib_api> z_stream_wrapper;
+#if defined(BXZSTR_ZLIB_NG_SUPPORT) && (BXZSTR_ZLIB_NG_SUPPORT) == 1
+typedef basic_z_stream_wrapper<zlib_ng_api> zng_stream_wrapper;
+#endif
 } // namespace detail
 } // namespace bxz
 
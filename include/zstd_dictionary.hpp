@@ -0,0 +1,154 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#if defined(BXZSTR_ZSTD_SUPPORT) && (BXZSTR_ZSTD_SUPPORT) == 1
+
+#ifndef BXZSTR_ZSTD_DICTIONARY_HPP
+#define BXZSTR_ZSTD_DICTIONARY_HPP
+
+#include <zstd.h>
+#include <zdict.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace bxz {
+// A zstd dictionary with its pre-digested compression (ZSTD_CDict,
+// one per compression level) and decompression (ZSTD_DDict) forms.
+// The digested forms are created on first use and shared by all
+// streams that use the dictionary, from any thread.
+class zstd_dictionary {
+  public:
+    explicit zstd_dictionary(const std::string &_contents)
+	    : contents(_contents), dict_id(ZSTD_getDictID_fromDict(_contents.data(), _contents.size())),
+	      digested_ddict(nullptr) {}
+    ~zstd_dictionary() {
+	for (auto &cdict : this->cdicts) ZSTD_freeCDict(cdict.second);
+	ZSTD_freeDDict(this->digested_ddict);
+    }
+    zstd_dictionary(const zstd_dictionary &) = delete;
+    zstd_dictionary & operator = (const zstd_dictionary &) = delete;
+
+    // The dictionary ID, 0 for raw content dictionaries.
+    uint32_t id() const { return this->dict_id; }
+    const std::string& data() const { return this->contents; }
+
+    const ZSTD_CDict* cdict(const int level) const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	ZSTD_CDict *&cdict = this->cdicts[level];
+	if (cdict == nullptr) {
+	    cdict = ZSTD_createCDict(this->contents.data(), this->contents.size(), level);
+	    if (cdict == nullptr) throw std::runtime_error("bxzstr: ZSTD_createCDict() failed.");
+	}
+	return cdict;
+    }
+    const ZSTD_DDict* ddict() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if (this->digested_ddict == nullptr) {
+	    this->digested_ddict = ZSTD_createDDict(this->contents.data(), this->contents.size());
+	    if (this->digested_ddict == nullptr) throw std::runtime_error("bxzstr: ZSTD_createDDict() failed.");
+	}
+	return this->digested_ddict;
+    }
+
+  private:
+    const std::string contents;
+    const uint32_t dict_id;
+    mutable std::mutex mutex;
+    mutable std::map<int, ZSTD_CDict*> cdicts;
+    mutable ZSTD_DDict* digested_ddict;
+}; // class zstd_dictionary
+
+namespace detail {
+struct zstd_dictionary_registry {
+    std::mutex mutex;
+    std::map<uint32_t, std::shared_ptr<const zstd_dictionary>> dictionaries;
+};
+inline zstd_dictionary_registry& zstd_dictionaries() {
+    static zstd_dictionary_registry registry;
+    return registry;
+}
+} // namespace detail
+
+// Registers a dictionary under its dictionary ID, replacing any
+// dictionary with the same ID, and returns the ID. Streams use it with
+// params::zstd_dict_id, and readers pick it for frames that carry its
+// ID. Throws if the dictionary has no ID.
+inline uint32_t add_zstd_dictionary(const std::string &contents) {
+    std::shared_ptr<const zstd_dictionary> dict(new zstd_dictionary(contents));
+    if (dict->id() == 0) throw std::runtime_error("bxzstr: zstd dictionary has no dictionary ID.");
+    detail::zstd_dictionary_registry &registry = detail::zstd_dictionaries();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.dictionaries[dict->id()] = dict;
+    return dict->id();
+}
+// Returns the dictionary registered with `id`, or nullptr.
+inline std::shared_ptr<const zstd_dictionary> find_zstd_dictionary(const uint32_t id) {
+    detail::zstd_dictionary_registry &registry = detail::zstd_dictionaries();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto it = registry.dictionaries.find(id);
+    return it == registry.dictionaries.end() ? nullptr : it->second;
+}
+// Removes a dictionary. Streams that use it keep their reference.
+inline void remove_zstd_dictionary(const uint32_t id) {
+    detail::zstd_dictionary_registry &registry = detail::zstd_dictionaries();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.dictionaries.erase(id);
+}
+namespace detail {
+inline std::vector<std::shared_ptr<const zstd_dictionary>> registered_zstd_dictionaries() {
+    zstd_dictionary_registry &registry = zstd_dictionaries();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    std::vector<std::shared_ptr<const zstd_dictionary>> dicts;
+    for (auto &dict : registry.dictionaries) dicts.push_back(dict.second);
+    return dicts;
+}
+} // namespace detail
+
+// Trains a dictionary of at most `max_size` bytes with
+// ZDICT_trainFromBuffer() from sample records, e.g. small files that
+// are compressed independently. zstd recommends around 100 times more
+// sample data than the dictionary size.
+inline std::string train_zstd_dictionary(const std::vector<std::string> &samples,
+					 const std::size_t max_size = 112640) {
+    std::string buffer;
+    std::vector<size_t> sizes;
+    for (const std::string &sample : samples) {
+	buffer += sample;
+	sizes.push_back(sample.size());
+    }
+    std::string dict(max_size, '\0');
+    const size_t size = ZDICT_trainFromBuffer(&dict[0], dict.size(), buffer.data(), sizes.data(),
+					      (unsigned)sizes.size());
+    if (ZDICT_isError(size))
+	throw std::runtime_error(std::string("bxzstr: ZDICT_trainFromBuffer() failed: ") + ZDICT_getErrorName(size));
+    dict.resize(size);
+    return dict;
+}
+// Trains a dictionary from the contents of the files in `paths`.
+inline std::string train_zstd_dictionary_from_files(const std::vector<std::string> &paths,
+						    const std::size_t max_size = 112640) {
+    std::vector<std::string> samples;
+    for (const std::string &path : paths) {
+	std::ifstream in(path, std::ios_base::in | std::ios_base::binary);
+	if (!in) throw std::runtime_error("bxzstr: could not open " + path + ".");
+	std::ostringstream oss;
+	oss << in.rdbuf();
+	samples.push_back(oss.str());
+    }
+    return train_zstd_dictionary(samples, max_size);
+}
+} // namespace bxz
+
+#endif
+#endif
@@ -13,9 +13,15 @@
 #include <zstd.h>
 
 #include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
 #include <exception>
 
 #include "stream_wrapper.hpp"
+#include "params.hpp"
+#include "zstd_dictionary.hpp"
+#include "mapped_file.hpp"
 
 namespace bxz {
 /// Exception class thrown by failed zstd operations.
@@ -35,19 +41,81 @@ class zstdException : public std::exception {
 }; // class zstdException
 
 namespace detail {
-class zstd_stream_wrapper : public stream_wrapper {
+// Target compressed block size used for low latency streams.
+static const int zstd_low_latency_block_size = 1 << 12;
+
+class zstd_stream_wrapper final : public stream_wrapper {
   public:
     zstd_stream_wrapper(const bool _isInput = true,
-			const int level = ZSTD_CLEVEL_DEFAULT, const int = 0)
+			const int level = ZSTD_CLEVEL_DEFAULT, const int target_block_size = 0)
+	    : zstd_stream_wrapper(_isInput, make_params(level, target_block_size)) {}
+    zstd_stream_wrapper(const bool _isInput, const params &p)
 	    : isInput(_isInput) {
 	if (this->isInput) {
 	    this->dctx = ZSTD_createDCtx();
 	    if (this->dctx == NULL) throw zstdException("ZSTD_createDCtx() failed!");
+	    int window_log_max = limit_window_log(p.zstd_window_log_max, p.memory_limit);
+	    if (!p.zstd_patch_from.empty()) {
+		this->map_reference(p);
+		const int patch_window_log = this->patch_window_log();
+		if (p.zstd_window_log_max == 0 && p.memory_limit == 0 && patch_window_log > 27)
+		    window_log_max = patch_window_log;
+	    }
+	    if (window_log_max > 0) this->set_parameter(ZSTD_d_windowLogMax, window_log_max);
+#if ZSTD_VERSION_NUMBER >= 10407
+	    // ZSTD_d_forceIgnoreChecksum
+	    if (!p.verify_checksums) this->set_parameter(ZSTD_d_experimentalParam3, 1);
+#endif
+#if ZSTD_VERSION_NUMBER >= 10409
+	    // ZSTD_d_refMultipleDDicts: each frame uses the registered
+	    // dictionary with the dictionary ID in its header
+	    this->dicts = registered_zstd_dictionaries();
+	    if (!this->dicts.empty()) this->set_parameter(ZSTD_d_experimentalParam4, 1);
+	    for (const auto &dict : this->dicts) this->check(ZSTD_DCtx_refDDict(this->dctx, dict->ddict()));
+#endif
+	    // referenced last, so that frames without a dictionary ID use it
+	    if (p.zstd_dict_id != 0)
+		this->check(ZSTD_DCtx_refDDict(this->dctx, this->use_dictionary(p.zstd_dict_id)->ddict()));
+	    if (this->reference)
+		this->check(ZSTD_DCtx_refPrefix(this->dctx, this->reference->data(), this->reference->size()));
 	} else {
 	    this->cctx = ZSTD_createCCtx();
 	    if (this->cctx == NULL) throw zstdException("ZSTD_createCCtx() failed!");
-	    this->ret = ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level);
-	    if (ZSTD_isError(this->ret)) throw zstdException(this->ret);
+	    this->set_parameter(ZSTD_c_compressionLevel, p.level);
+	    int window_log = p.zstd_window_log;
+	    if (!p.zstd_patch_from.empty()) {
+		this->map_reference(p);
+		window_log = std::max(window_log, this->patch_window_log());
+	    }
+	    if (window_log > 0) this->set_parameter(ZSTD_c_windowLog, window_log);
+	    if (p.zstd_long_distance_matching || this->reference)
+		this->set_parameter(ZSTD_c_enableLongDistanceMatching, 1);
+	    if (p.zstd_strategy > 0) this->set_parameter(ZSTD_c_strategy, p.zstd_strategy);
+	    if (p.zstd_workers > 0) {
+		this->set_parameter(ZSTD_c_nbWorkers, p.zstd_workers);
+	    } else if (p.adaptive_level && ZSTD_cParam_getBounds(ZSTD_c_nbWorkers).upperBound > 0) {
+		// the level only changes within a frame when a worker
+		// compresses it, as with `zstd --adapt`
+		this->set_parameter(ZSTD_c_nbWorkers, 1);
+	    }
+	    // ZSTD_c_rsyncable
+	    if (p.rsyncable && p.zstd_workers > 0) this->set_parameter(ZSTD_c_experimentalParam1, 1);
+	    if (p.checksum != checksum_default) this->set_parameter(ZSTD_c_checksumFlag, p.checksum == checksum_on);
+	    const int target_block_size = (p.zstd_target_block_size == 0 && p.flush == low_latency
+					   ? zstd_low_latency_block_size : p.zstd_target_block_size);
+	    if (target_block_size > 0) {
+#if ZSTD_VERSION_NUMBER >= 10506
+		this->set_parameter(ZSTD_c_targetCBlockSize, target_block_size);
+#else
+		this->set_parameter(ZSTD_c_experimentalParam6, target_block_size);
+#endif
+	    }
+	    if (p.zstd_dict_id != 0)
+		this->check(ZSTD_CCtx_refCDict(this->cctx, this->use_dictionary(p.zstd_dict_id)->cdict(p.level)));
+	    if (this->reference)
+		this->check(ZSTD_CCtx_refPrefix(this->cctx, this->reference->data(), this->reference->size()));
+	    if (p.zstd_pledged_size > 0)
+		this->check(ZSTD_CCtx_setPledgedSrcSize(this->cctx, p.zstd_pledged_size));
 	}
     }
 
@@ -75,7 +143,11 @@ class zstd_stream_wrapper : public stream_wrapper {
 	this->update_inbuffer();
 	this->update_outbuffer();
 
-	if (endStream) {
+	if (endStream == 2) {
+	    // flush the current block but keep the frame open
+	    this->ret = ZSTD_compressStream2(this->cctx, &output, &input, ZSTD_e_flush);
+	    if (ZSTD_isError(this->ret)) throw zstdException(this->ret);
+	} else if (endStream) {
 	    this->ret = ZSTD_endStream(this->cctx, &output);
 	    if (ZSTD_isError(this->ret)) throw zstdException(this->ret);
 	} else {
@@ -92,6 +164,13 @@ class zstd_stream_wrapper : public stream_wrapper {
 
     bool stream_end() const override { return this->ret == 0; }
     bool done() const override { return this->stream_end(); }
+    bool set_level(const int level) override {
+	this->set_parameter(ZSTD_c_compressionLevel, level);
+	return true;
+    }
+    std::size_t memory_usage() const override {
+	return this->isInput ? ZSTD_sizeof_DCtx(this->dctx) : ZSTD_sizeof_CCtx(this->cctx);
+    }
 
     const unsigned char* next_in() const override { return static_cast<unsigned char*>(this->buffIn); }
     long avail_in() const override { return this->buffInSize; }
@@ -118,6 +197,54 @@ class zstd_stream_wrapper : public stream_wrapper {
     ZSTD_inBuffer input;
     ZSTD_outBuffer output;
 
+    // Dictionaries referenced by the context
+    std::vector<std::shared_ptr<const zstd_dictionary>> dicts;
+    // Reference file of patch mode, used as the prefix of one frame
+    std::unique_ptr<const mapped_file> reference;
+
+    void check(const size_t code) {
+	this->ret = code;
+	if (ZSTD_isError(this->ret)) throw zstdException(this->ret);
+    }
+    const zstd_dictionary* use_dictionary(const uint32_t id) {
+	std::shared_ptr<const zstd_dictionary> dict = find_zstd_dictionary(id);
+	if (!dict) throw zstdException("zstd error: dictionary " + std::to_string(id) + " is not registered");
+	this->dicts.push_back(dict);
+	return dict.get();
+    }
+    void map_reference(const params &p) {
+	if (p.zstd_dict_id != 0) throw zstdException("zstd error: a dictionary cannot be used in patch mode");
+	this->reference.reset(new mapped_file(p.zstd_patch_from));
+    }
+    // Window that covers the reference and a new version of about the
+    // same size, as in `zstd --patch-from`.
+    int patch_window_log() const {
+	int window_log = 10; // ZSTD_WINDOWLOG_ABSOLUTEMIN
+	while (window_log < ZSTD_cParam_getBounds(ZSTD_c_windowLog).upperBound
+	       && ((uint64_t)1 << window_log) < 2*(uint64_t)this->reference->size()) ++window_log;
+	return window_log;
+    }
+    void set_parameter(const ZSTD_cParameter param, const int value) {
+	this->ret = ZSTD_CCtx_setParameter(this->cctx, param, value);
+	if (ZSTD_isError(this->ret)) throw zstdException(this->ret);
+    }
+    void set_parameter(const ZSTD_dParameter param, const int value) {
+	this->ret = ZSTD_DCtx_setParameter(this->dctx, param, value);
+	if (ZSTD_isError(this->ret)) throw zstdException(this->ret);
+    }
+    // Largest window that fits in memory_limit, or window_log_max if it is smaller.
+    static int limit_window_log(const int window_log_max, const uint64_t memory_limit) {
+	if (memory_limit == 0) return window_log_max;
+	int window_log = 10; // ZSTD_WINDOWLOG_ABSOLUTEMIN
+	while (window_log < 31 && ((uint64_t)1 << (window_log + 1)) <= memory_limit) ++window_log;
+	return (window_log_max > 0 && window_log_max < window_log ? window_log_max : window_log);
+    }
+    static params make_params(const int level, const int target_block_size) {
+	params p(level);
+	p.zstd_target_block_size = target_block_size;
+	return p;
+    }
+
     void update_inbuffer() { this->input = { this->buffIn, this->buffInSize, 0 }; }
     void update_outbuffer() { this->output =  { this->buffOut, this->buffOutSize, 0 }; }
     void update_stream_state() {
@@ -0,0 +1,62 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_ADAPTIVE_LEVEL_UNITTEST_HPP
+#define BXZSTR_ADAPTIVE_LEVEL_UNITTEST_HPP
+
+#include <chrono>
+#include <thread>
+#include <string>
+#include <sstream>
+#include <iterator>
+
+#include "gtest/gtest.h"
+
+#include "bxzstr.hpp"
+
+// A sink that blocks on every write, like a slow network mount
+class SlowSink : public std::stringbuf {
+  protected:
+    std::streamsize xsputn(const char *s, std::streamsize n) override {
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	return std::stringbuf::xsputn(s, n);
+    }
+};
+
+// Test params::adaptive_level with slow and fast sinks
+class AdaptiveLevelTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+	uint64_t x = 88172645463325252ULL;
+	while (this->data.size() < ((size_t)1 << 21)) {
+	    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+	    this->data += "record " + std::to_string(x % 100000) + " value " + std::to_string(x % 97) + "\n";
+	}
+    }
+    // Writes `data` in 64 KiB blocks and returns the last level.
+    int compress(std::streambuf *sink, const bxz::Compression type, const bxz::params &prm) const {
+	bxz::ostreambuf obuf(sink, type, prm, (std::size_t)1 << 16);
+	std::ostream os(&obuf);
+	os << this->data;
+	os.flush();
+	return obuf.level();
+    }
+    std::string decompress(const std::string &compressed) const {
+	std::stringbuf in(compressed);
+	bxz::istreambuf ibuf(&in);
+	return std::string(std::istreambuf_iterator<char>(&ibuf), std::istreambuf_iterator<char>());
+    }
+    bxz::params adaptive_params(const int level) const {
+	bxz::params prm(level);
+	prm.adaptive_level = true;
+	return prm;
+    }
+    // Test values
+    std::string data;
+};
+
+#endif
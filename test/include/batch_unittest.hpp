@@ -0,0 +1,91 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_BATCH_UNITTEST_HPP
+#define BXZSTR_BATCH_UNITTEST_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "bxzstr.hpp"
+
+// Test compress_batch() and decompress_batch() on 64 pages of 16 to
+// 64 KB
+class BatchTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+	for (int i = 0; i < 64; ++i) {
+	    std::string page;
+	    while (page.size() < (std::size_t)(16384 + (i % 4)*16384))
+		page += "page " + std::to_string(i) + " row " + std::to_string(page.size() % 977) + "\n";
+	    this->pages.push_back(page);
+	}
+	this->pool = std::make_shared<bxz::thread_pool_executor>(4);
+    }
+    std::vector<bxz::Compression> types() const {
+	std::vector<bxz::Compression> available;
+	available.push_back(bxz::plaintext);
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+	available.push_back(bxz::z);
+#endif
+#if defined(BXZSTR_BZ2_SUPPORT) && (BXZSTR_BZ2_SUPPORT) == 1
+	available.push_back(bxz::bz2);
+#endif
+#if defined(BXZSTR_LZMA_SUPPORT) && (BXZSTR_LZMA_SUPPORT) == 1
+	available.push_back(bxz::lzma);
+#endif
+#if defined(BXZSTR_ZSTD_SUPPORT) && (BXZSTR_ZSTD_SUPPORT) == 1
+	available.push_back(bxz::zstd);
+#endif
+	return available;
+    }
+    // `prm` on `pool` with at most `threads` threads.
+    bxz::params on_pool(bxz::params prm, const unsigned threads) const {
+	prm.executor_p = this->pool;
+	prm.max_threads = threads;
+	return prm;
+    }
+    // Compresses the pages into `compressed` and returns the results.
+    std::vector<bxz::batch_result> compress(const bxz::Compression type, const bxz::params &prm,
+					    const unsigned threads) {
+	std::vector<bxz::batch_input> inputs;
+	std::vector<bxz::batch_output> outputs;
+	this->compressed.assign(this->pages.size(), std::string());
+	for (std::size_t i = 0; i < this->pages.size(); ++i) {
+	    this->compressed[i].resize(bxz::compress_bound(type, this->pages[i].size()));
+	    inputs.emplace_back(this->pages[i].data(), this->pages[i].size());
+	    outputs.emplace_back(&this->compressed[i][0], this->compressed[i].size());
+	}
+	const std::vector<bxz::batch_result> results = bxz::compress_batch(type, inputs, outputs,
+									    this->on_pool(prm, threads));
+	for (std::size_t i = 0; i < results.size(); ++i) this->compressed[i].resize(results[i].size);
+	return results;
+    }
+    // Decompresses `compressed` into `decompressed`.
+    std::vector<bxz::batch_result> decompress(const bxz::Compression type, const bxz::params &prm,
+					      const unsigned threads) {
+	std::vector<bxz::batch_input> inputs;
+	std::vector<bxz::batch_output> outputs;
+	this->decompressed.assign(this->pages.size(), std::string());
+	for (std::size_t i = 0; i < this->pages.size(); ++i) {
+	    this->decompressed[i].resize(this->pages[i].size());
+	    inputs.emplace_back(this->compressed[i].data(), this->compressed[i].size());
+	    outputs.emplace_back(&this->decompressed[i][0], this->decompressed[i].size());
+	}
+	return bxz::decompress_batch(inputs, outputs, type, this->on_pool(prm, threads));
+    }
+    // Test values
+    std::shared_ptr<bxz::executor> pool;
+    std::vector<std::string> pages;
+    std::vector<std::string> compressed;
+    std::vector<std::string> decompressed;
+};
+
+#endif
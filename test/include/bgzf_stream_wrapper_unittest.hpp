@@ -0,0 +1,102 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "bxzstr.hpp"
+
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+
+#ifndef BXZSTR_BGZF_STREAM_WRAPPER_UNITTEST_HPP
+#define BXZSTR_BGZF_STREAM_WRAPPER_UNITTEST_HPP
+
+#include <string>
+#include <cstddef>
+
+#include "gtest/gtest.h"
+#include "zlib.h"
+
+// Test bgzfException
+class BgzfExceptionTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->msgConstructorValue = "urpdcjgztzcowdpiucfrhxczlgbbopeg";
+	this->msgConstructorExpected = "bgzf: urpdcjgztzcowdpiucfrhxczlgbbopeg";
+    }
+    void TearDown() override {
+    }
+    // Test values
+    std::string msgConstructorValue;
+    // Expecteds
+    std::string msgConstructorExpected;
+};
+
+// Test bgzf_stream_wrapper
+class BgzfStreamWrapperTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->testTrue = true;
+	this->testFalse = false;
+    }
+    void TearDown() override {
+    }
+    // Test values
+    bool testTrue;
+    bool testFalse;
+};
+
+// Common inputs/outputs for compression and decompression testing
+class BgzfCompressAndDecompressTest {
+  protected:
+    // one block with 10 1s on their own lines and the end-of-file block
+    unsigned char test_vals[60] = { 0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 0x42, 0x43, 0x02, 0x00,
+				    0x1f, 0x00, 0x33, 0xe4, 0x32, 0x44, 0x87, 0x00, 0xae, 0x30, 0x5a, 0x73, 0x13, 0x00, 0x00, 0x00,
+				    0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 0x42, 0x43, 0x02, 0x00,
+				    0x1b, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    unsigned char output_vals[64] = { 0 };
+
+    unsigned char* testIn;
+    const unsigned char* testOut;
+    bxz::detail::bgzf_stream_wrapper* wrapper;
+
+    void set_addresses(bxz::detail::bgzf_stream_wrapper* wrapper) {
+	wrapper->set_next_in(&testIn[0]);
+	wrapper->set_avail_in(10);
+	wrapper->set_next_out(&testOut[0]);
+	wrapper->set_avail_out(64);
+    }
+};
+
+// Test decompress
+class BgzfDecompressTest : public BgzfCompressAndDecompressTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->testIn = reinterpret_cast<unsigned char*>(test_vals);
+	this->testOut = reinterpret_cast<const unsigned char*>(output_vals);
+	wrapper = new bxz::detail::bgzf_stream_wrapper();
+	this->set_addresses(wrapper);
+    }
+    void TearDown() override {
+	delete wrapper;
+    }
+};
+
+// Test compress
+class BgzfCompressTest : public BgzfCompressAndDecompressTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->testIn = reinterpret_cast<unsigned char*>(test_vals);
+	this->testOut = reinterpret_cast<const unsigned char*>(output_vals);
+	wrapper = new bxz::detail::bgzf_stream_wrapper(false);
+	this->set_addresses(wrapper);
+    }
+    void TearDown() override {
+	delete wrapper;
+    }
+};
+
+#endif
+
+#endif
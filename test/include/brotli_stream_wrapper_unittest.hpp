@@ -0,0 +1,104 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "bxzstr.hpp"
+
+#if defined(BXZSTR_BROTLI_SUPPORT) && (BXZSTR_BROTLI_SUPPORT) == 1
+
+#ifndef BXZSTR_BROTLI_STREAM_WRAPPER_UNITTEST_HPP
+#define BXZSTR_BROTLI_STREAM_WRAPPER_UNITTEST_HPP
+
+#include <string>
+#include <cstddef>
+
+#include "gtest/gtest.h"
+#include "brotli/decode.h"
+#include "brotli/encode.h"
+
+
+// Test brotliException
+class BrotliExceptionTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->msgConstructorValue = "urpdcjgztzcowdpiucfrhxczlgbbopeg";
+	this->msgConstructorExpected = "urpdcjgztzcowdpiucfrhxczlgbbopeg";
+	this->errcodeConstructorValue = BROTLI_DECODER_ERROR_FORMAT_EXUBERANT_NIBBLE;
+	this->errcodeConstructorExpected = "brotli error: [-1]: EXUBERANT_NIBBLE";
+    }
+    void TearDown() override {
+    }
+    // Test values
+    std::string msgConstructorValue;
+    BrotliDecoderErrorCode errcodeConstructorValue;
+    // Expecteds
+    std::string msgConstructorExpected;
+    std::string errcodeConstructorExpected;
+};
+
+// Test brotli_stream_wrapper
+class BrotliStreamWrapperTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->testTrue = true;
+	this->testFalse = false;
+    }
+    void TearDown() override {
+    }
+    // Test values
+    bool testTrue;
+    bool testFalse;
+};
+
+// Common inputs/outputs for compression and decompression testing
+class BrotliCompressAndDecompressTest {
+  protected:
+    unsigned char test_vals[12] = { 0x1b, 0x12, 0x00, 0x00, 0xa4, 0x14, 0x62, 0x42, 0x9a, 0x30, 0x0e, 0x3b };
+    unsigned char output_vals[64] = { 0 };
+
+    unsigned char* testIn;
+    const unsigned char* testOut;
+    bxz::detail::brotli_stream_wrapper* wrapper;
+
+    void set_addresses(bxz::detail::brotli_stream_wrapper* wrapper) {
+	wrapper->set_next_in(&testIn[0]);
+	wrapper->set_avail_in(10);
+	wrapper->set_next_out(&testOut[0]);
+	wrapper->set_avail_out(64);
+    }
+};
+
+// Test decompress
+class BrotliDecompressTest : public BrotliCompressAndDecompressTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->testIn = reinterpret_cast<unsigned char*>(test_vals);
+	this->testOut = reinterpret_cast<const unsigned char*>(output_vals);
+	wrapper = new bxz::detail::brotli_stream_wrapper();
+	this->set_addresses(wrapper);
+    }
+    void TearDown() override {
+	delete wrapper;
+    }
+};
+
+// Test compress
+class BrotliCompressTest : public BrotliCompressAndDecompressTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->testIn = reinterpret_cast<unsigned char*>(test_vals);
+	this->testOut = reinterpret_cast<const unsigned char*>(output_vals);
+	wrapper = new bxz::detail::brotli_stream_wrapper(false);
+	this->set_addresses(wrapper);
+    }
+    void TearDown() override {
+	delete wrapper;
+    }
+};
+
+#endif
+
+#endif
@@ -12,6 +12,7 @@
 #include <vector>
 #include <string>
 #include <fstream>
+#include <iterator>
 
 #include "gtest/gtest.h"
 
@@ -37,9 +38,9 @@ class DecompressionTest {
 	of.close();
     }
 
-    void run_test() {
+    void run_test(const bxz::params &prm = bxz::params()) {
     // Helper function for running the tests since only the data in test_infile differs.
-	bxz::ifstream in(this->test_infile);
+	bxz::ifstream in(this->test_infile, prm);
 	std::string line;
 	uint32_t i = 0;
 	while (std::getline(in, line)) {
@@ -49,6 +50,13 @@ class DecompressionTest {
 	EXPECT_EQ(i, this->n_in_vals);
     }
 
+    // Reads test_infile through a bxz::istreambuf with `buff_size` byte buffers.
+    std::string read_with_buffer(const std::size_t buff_size) const {
+	std::ifstream file(this->test_infile, std::ios::binary);
+	bxz::istreambuf buf(file.rdbuf(), buff_size);
+	return std::string((std::istreambuf_iterator<char>(&buf)), std::istreambuf_iterator<char>());
+    }
+
 };
 uint32_t DecompressionTest::n_in_vals = 10;
 std::vector<char> DecompressionTest::expected = std::vector<char>(10, '1');
@@ -69,6 +77,76 @@ class ZDecompressionTest : public DecompressionTest, public ::testing::Test {
 
 };
 
+// Test z decompression with a corrupted CRC32 in the trailer
+class ZCorruptChecksumTest : public DecompressionTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	// ZDecompressionTest data with the CRC32 bytes set to 0
+	const unsigned char test_vals[] = {0x1f, 0x8b, 0x08, 0x08, 0xf1, 0x0a, 0x61, 0x62, 0x00, 0x03, 0x74, 0x65, 0x73, 0x74, 0x7a, 0x2e,
+	                                   0x74, 0x78, 0x74, 0x00, 0x33, 0xe4, 0x32, 0xc4, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x14, 0x00,
+					   0x00, 0x00 };
+	this->test_infile = "ZCorruptChecksumTest_fake_data.txt.gz";
+	this->write_test_data(test_vals, 34);
+    }
+
+};
+
+// Test z decompression of concatenated gzip members
+class ZConcatenatedDecompressionTest : public DecompressionTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	// Two copies of the ZDecompressionTest data
+	const unsigned char test_vals[] = {0x1f, 0x8b, 0x08, 0x08, 0xf1, 0x0a, 0x61, 0x62, 0x00, 0x03, 0x74, 0x65, 0x73, 0x74, 0x7a, 0x2e,
+	                                   0x74, 0x78, 0x74, 0x00, 0x33, 0xe4, 0x32, 0xc4, 0x80, 0x00, 0x4c, 0xd2, 0xca, 0x03, 0x14, 0x00,
+					   0x00, 0x00,
+					   0x1f, 0x8b, 0x08, 0x08, 0xf1, 0x0a, 0x61, 0x62, 0x00, 0x03, 0x74, 0x65, 0x73, 0x74, 0x7a, 0x2e,
+	                                   0x74, 0x78, 0x74, 0x00, 0x33, 0xe4, 0x32, 0xc4, 0x80, 0x00, 0x4c, 0xd2, 0xca, 0x03, 0x14, 0x00,
+					   0x00, 0x00 };
+	this->test_infile = "ZConcatenatedDecompressionTest_fake_data.txt.gz";
+	this->write_test_data(test_vals, 68);
+    }
+
+    void run_concatenated_test(const bxz::params &prm) {
+	bxz::ifstream in(this->test_infile, prm);
+	std::string line;
+	uint32_t i = 0;
+	while (std::getline(in, line)) {
+	    EXPECT_EQ(line[0], '1');
+	    ++i;
+	}
+	EXPECT_EQ(i, 2*this->n_in_vals);
+    }
+
+};
+
+// Test z decompression of a member that ends before its trailer
+class ZTruncatedDecompressionTest : public DecompressionTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	// ZDecompressionTest data without the CRC32 and ISIZE
+	const unsigned char test_vals[] = {0x1f, 0x8b, 0x08, 0x08, 0xf1, 0x0a, 0x61, 0x62, 0x00, 0x03, 0x74, 0x65, 0x73, 0x74, 0x7a, 0x2e,
+	                                   0x74, 0x78, 0x74, 0x00, 0x33, 0xe4, 0x32, 0xc4, 0x80, 0x00 };
+	this->test_infile = "ZTruncatedDecompressionTest_fake_data.txt.gz";
+	this->write_test_data(test_vals, 26);
+    }
+
+};
+
+// Test reading past the initial read size
+class ZReadSizeGrowthTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->test_infile = "ZReadSizeGrowthTest_fake_data.txt.gz";
+	bxz::ofstream out(this->test_infile, bxz::z);
+	for (uint32_t i = 0; i < this->n_lines; ++i) {
+	    out << i << '\n';
+	}
+    }
+    // Test parameters
+    std::string test_infile;
+    uint32_t n_lines = 100000;
+};
+
 #endif
 
 #if defined(BXZSTR_BZ2_SUPPORT) && (BXZSTR_BZ2_SUPPORT) == 1
@@ -125,4 +203,112 @@ class ZstdDecompressionTest : public DecompressionTest, public ::testing::Test {
 
 #endif
 
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+// Test BGZF decompression
+class BgzfDecompressionTest : public DecompressionTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	// Fake BGZF data with 10 1s on their own lines: one data block
+	// and the end-of-file block
+	const unsigned char test_vals[] = { 0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 0x42, 0x43, 0x02, 0x00,
+	                                    0x1f, 0x00, 0x33, 0xe4, 0x32, 0x44, 0x87, 0x00, 0xae, 0x30, 0x5a, 0x73, 0x13, 0x00, 0x00, 0x00,
+	                                    0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 0x42, 0x43, 0x02, 0x00,
+	                                    0x1b, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+	this->test_infile = "BgzfDecompressionTest_fake_data.txt.gz";
+	this->write_test_data(test_vals, 60);
+    }
+
+};
+
+// Test BGZF decompression with a corrupted CRC32 in the first block
+class BgzfCorruptChecksumTest : public DecompressionTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	// BgzfDecompressionTest data with the CRC32 bytes set to 0
+	const unsigned char test_vals[] = { 0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 0x42, 0x43, 0x02, 0x00,
+	                                    0x1f, 0x00, 0x33, 0xe4, 0x32, 0x44, 0x87, 0x00, 0x00, 0x00, 0x00, 0x00, 0x13, 0x00, 0x00, 0x00,
+	                                    0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 0x42, 0x43, 0x02, 0x00,
+	                                    0x1b, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+	this->test_infile = "BgzfCorruptChecksumTest_fake_data.txt.gz";
+	this->write_test_data(test_vals, 60);
+    }
+
+};
+
+// Test BGZF decompression of a file without the end-of-file block
+class BgzfNoEofBlockTest : public DecompressionTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	// The BgzfDecompressionTest data block
+	const unsigned char test_vals[] = { 0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 0x42, 0x43, 0x02, 0x00,
+	                                    0x1f, 0x00, 0x33, 0xe4, 0x32, 0x44, 0x87, 0x00, 0xae, 0x30, 0x5a, 0x73, 0x13, 0x00, 0x00, 0x00 };
+	this->test_infile = "BgzfNoEofBlockTest_fake_data.txt.gz";
+	this->write_test_data(test_vals, 32);
+    }
+
+};
+
+// Test decompression of a plain gzip member between BGZF blocks
+class BgzfMixedMemberTest : public DecompressionTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	// The BgzfDecompressionTest data block, the ZDecompressionTest
+	// member, and the BGZF end-of-file block
+	const unsigned char test_vals[] = { 0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 0x42, 0x43, 0x02, 0x00,
+	                                    0x1f, 0x00, 0x33, 0xe4, 0x32, 0x44, 0x87, 0x00, 0xae, 0x30, 0x5a, 0x73, 0x13, 0x00, 0x00, 0x00,
+					    0x1f, 0x8b, 0x08, 0x08, 0xf1, 0x0a, 0x61, 0x62, 0x00, 0x03, 0x74, 0x65, 0x73, 0x74, 0x7a, 0x2e,
+	                                    0x74, 0x78, 0x74, 0x00, 0x33, 0xe4, 0x32, 0xc4, 0x80, 0x00, 0x4c, 0xd2, 0xca, 0x03, 0x14, 0x00,
+					    0x00, 0x00,
+	                                    0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 0x42, 0x43, 0x02, 0x00,
+	                                    0x1b, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+	this->test_infile = "BgzfMixedMemberTest_fake_data.txt.gz";
+	this->write_test_data(test_vals, 94);
+    }
+
+    void run_mixed_test(const bxz::params &prm) {
+	// the BGZF block does not end with a newline
+	std::string expected;
+	for (uint32_t i = 0; i < 2*this->n_in_vals; ++i) expected += (i == this->n_in_vals - 1 ? "1" : "1\n");
+	bxz::ifstream in(this->test_infile, prm);
+	const std::string got((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	EXPECT_EQ(got, expected);
+    }
+
+};
+
+#endif
+
+#if defined(BXZSTR_LZ4_SUPPORT) && (BXZSTR_LZ4_SUPPORT) == 1
+// Test lz4 decompression
+class Lz4DecompressionTest : public DecompressionTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	// Fake lz4 data with 10 1s on their own lines
+	const unsigned char test_vals[] = { 0x04, 0x22, 0x4d, 0x18, 0x40, 0x40, 0xc0, 0x0b, 0x00, 0x00, 0x00, 0x28, 0x31, 0x0a, 0x02, 0x00,
+	                                    0x50, 0x31, 0x0a, 0x31, 0x0a, 0x31, 0x00, 0x00, 0x00, 0x00, 0x04, 0x22, 0x4d, 0x18, 0x40, 0x40,
+	                                    0xc0, 0x00, 0x00, 0x00, 0x00 };
+	this->test_infile = "Lz4DecompressionTest_fake_data.txt.lz4";
+	this->write_test_data(test_vals, 37);
+    }
+
+};
+
+#endif
+
+#if defined(BXZSTR_BROTLI_SUPPORT) && (BXZSTR_BROTLI_SUPPORT) == 1
+// Test brotli decompression. Brotli has no magic bytes, so the type
+// comes from the .br extension.
+class BrotliDecompressionTest : public DecompressionTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	// Fake brotli data with 10 1s on their own lines
+	const unsigned char test_vals[] = { 0x1b, 0x12, 0x00, 0x00, 0xa4, 0x14, 0x62, 0x42, 0x9a, 0x30, 0x0e, 0x3b };
+	this->test_infile = "BrotliDecompressionTest_fake_data.txt.br";
+	this->write_test_data(test_vals, 12);
+    }
+
+};
+
+#endif
+
 #endif
@@ -61,6 +61,54 @@ class CompressionTest {
 };
 uint32_t CompressionTest::n_out_vals = 10;
 
+// Round trip records that are flushed one by one with bxz::ofstream
+class RecordRoundTripTest {
+  protected:
+    // Test parameters
+    std::string test_outfile;
+    uint32_t n_records = 1000;
+
+    size_t write_records(const bxz::Compression compression, const bxz::FlushMode flush) const {
+	return this->write_records(compression, bxz::params(6, flush));
+    }
+
+    size_t write_records(const bxz::Compression compression, const bxz::params &prm) const {
+	{
+	    bxz::ofstream out(this->test_outfile, compression, prm);
+	    for (uint32_t i = 0; i < this->n_records; ++i) {
+		out << "record " << i << std::endl;
+	    }
+	}
+	std::ifstream in(this->test_outfile, std::ios_base::binary | std::ios_base::ate);
+	return in.tellg();
+    }
+
+    // Writes with one of the compile-time codec streams (bxz::z_ofstream, ...)
+    template <typename OFStream>
+    size_t write_typed_records(const bxz::params &prm) const {
+	{
+	    OFStream out(this->test_outfile, prm);
+	    for (uint32_t i = 0; i < this->n_records; ++i) {
+		out << "record " << i << std::endl;
+	    }
+	}
+	std::ifstream in(this->test_outfile, std::ios_base::binary | std::ios_base::ate);
+	return in.tellg();
+    }
+
+    template <typename IFStream = bxz::ifstream>
+    void check_records() const {
+	IFStream in(this->test_outfile);
+	std::string line;
+	uint32_t i = 0;
+	while (std::getline(in, line)) {
+	    EXPECT_EQ(line, "record " + std::to_string(i));
+	    ++i;
+	}
+	EXPECT_EQ(i, this->n_records);
+    }
+};
+
 #if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
 // Test z compression
 class ZCompressionTest : public CompressionTest, public ::testing::Test {
@@ -79,6 +127,27 @@ class ZCompressionTest : public CompressionTest, public ::testing::Test {
 
 };
 
+class ZFlushModeTest : public RecordRoundTripTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->test_outfile = "ZFlushModeTest_fake_data.txt.gz";
+    }
+};
+
+class ZParamsTest : public RecordRoundTripTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->test_outfile = "ZParamsTest_fake_data.txt.gz";
+    }
+};
+
+class ZTypedStreamTest : public RecordRoundTripTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->test_outfile = "ZTypedStreamTest_fake_data.txt.gz";
+    }
+};
+
 #endif
 
 #if defined(BXZSTR_BZ2_SUPPORT) && (BXZSTR_BZ2_SUPPORT) == 1
@@ -100,6 +169,13 @@ class BzCompressionTest : public CompressionTest, public ::testing::Test {
 
 };
 
+class BzFlushModeTest : public RecordRoundTripTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->test_outfile = "BzFlushModeTest_fake_data.txt.bz2";
+    }
+};
+
 #endif
 
 
@@ -126,6 +202,13 @@ class LzmaCompressionTest : public CompressionTest, public ::testing::Test {
 
 };
 
+class LzmaFlushModeTest : public RecordRoundTripTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->test_outfile = "LzmaFlushModeTest_fake_data.txt.xz";
+    }
+};
+
 #endif
 
 
@@ -147,6 +230,143 @@ class ZstdCompressionTest : public CompressionTest, public ::testing::Test {
 
 };
 
+class ZstdFlushModeTest : public RecordRoundTripTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->test_outfile = "ZstdFlushModeTest_fake_data.txt.zst";
+    }
+};
+
+class ZstdParamsTest : public RecordRoundTripTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->test_outfile = "ZstdParamsTest_fake_data.txt.zst";
+    }
+};
+
+class ZstdTypedStreamTest : public RecordRoundTripTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->test_outfile = "ZstdTypedStreamTest_fake_data.txt.zst";
+    }
+};
+
+#endif
+
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+// Test BGZF compression
+class BgzfCompressionTest : public CompressionTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	// Raw data from running bxz::ofstream with bxz::bgzf for this test set
+	const unsigned char test[] = { 0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 0x42, 0x43, 0x02, 0x00,
+	                               0x1f, 0x00, 0x33, 0xe4, 0x32, 0x44, 0x87, 0x00, 0xae, 0x30, 0x5a, 0x73, 0x13, 0x00, 0x00, 0x00,
+	                               0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 0x42, 0x43, 0x02, 0x00,
+	                               0x1b, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	                               0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 0x42, 0x43, 0x02, 0x00,
+	                               0x1b, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+	this->test_outfile = "BgzfCompressionTest_fake_data.txt.gz";
+	this->write_test_data(bxz::bgzf);
+	for (uint32_t i = 0; i < sizeof(test)/sizeof(test[0]); ++i) {
+	    expected.push_back(test[i]);
+	}
+    }
+
+};
+
+class BgzfFlushModeTest : public RecordRoundTripTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->test_outfile = "BgzfFlushModeTest_fake_data.txt.gz";
+    }
+};
+
+class BgzfParamsTest : public RecordRoundTripTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->test_outfile = "BgzfParamsTest_fake_data.txt.gz";
+	// enough records for several 0xff00 byte blocks
+	this->n_records = 100000;
+    }
+};
+
+#endif
+
+#if defined(BXZSTR_LZ4_SUPPORT) && (BXZSTR_LZ4_SUPPORT) == 1
+// Test lz4 compression
+class Lz4CompressionTest : public CompressionTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	// Raw data from running bxz::ofstream with bxz::lz4 for this test set
+	const unsigned char test[] = { 0x04, 0x22, 0x4d, 0x18, 0x40, 0x40, 0xc0, 0x0b, 0x00, 0x00, 0x00, 0x28, 0x31, 0x0a, 0x02, 0x00,
+	                               0x50, 0x31, 0x0a, 0x31, 0x0a, 0x31, 0x00, 0x00, 0x00, 0x00, 0x04, 0x22, 0x4d, 0x18, 0x40, 0x40,
+	                               0xc0, 0x00, 0x00, 0x00, 0x00 };
+
+	this->test_outfile = "Lz4CompressionTest_fake_data.txt.lz4";
+	this->write_test_data(bxz::lz4);
+	for (uint32_t i = 0; i < sizeof(test)/sizeof(test[0]); ++i) {
+	    expected.push_back(test[i]);
+	}
+    }
+
+};
+
+class Lz4FlushModeTest : public RecordRoundTripTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->test_outfile = "Lz4FlushModeTest_fake_data.txt.lz4";
+    }
+};
+
+class Lz4ParamsTest : public RecordRoundTripTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->test_outfile = "Lz4ParamsTest_fake_data.txt.lz4";
+    }
+
+    uint64_t records_size() const {
+	uint64_t size = 0;
+	for (uint32_t i = 0; i < this->n_records; ++i) {
+	    size += ("record " + std::to_string(i) + "\n").size();
+	}
+	return size;
+    }
+};
+
+#endif
+
+#if defined(BXZSTR_BROTLI_SUPPORT) && (BXZSTR_BROTLI_SUPPORT) == 1
+// Test brotli compression
+class BrotliCompressionTest : public CompressionTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	// Raw data from running bxz::ofstream with bxz::brotli for this test set
+	const unsigned char test[] = { 0x1b, 0x12, 0x00, 0x00, 0xa4, 0x14, 0x62, 0x42, 0x9a, 0x30, 0x0e, 0x3b };
+
+	this->test_outfile = "BrotliCompressionTest_fake_data.txt.br";
+	this->write_test_data(bxz::brotli);
+	for (uint32_t i = 0; i < sizeof(test)/sizeof(test[0]); ++i) {
+	    expected.push_back(test[i]);
+	}
+    }
+
+};
+
+class BrotliFlushModeTest : public RecordRoundTripTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->test_outfile = "BrotliFlushModeTest_fake_data.txt.br";
+    }
+};
+
+class BrotliParamsTest : public RecordRoundTripTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->test_outfile = "BrotliParamsTest_fake_data.txt.br";
+    }
+};
+
 #endif
 
 #endif
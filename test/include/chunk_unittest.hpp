@@ -0,0 +1,46 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_CHUNK_UNITTEST_HPP
+#define BXZSTR_CHUNK_UNITTEST_HPP
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "bxzstr.hpp"
+
+// Test istreambuf::next_chunk() and bxz::chunks() on 1 MB of text
+class ChunkTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+	for (int i = 0; this->data.size() < 1000000; ++i) this->data += "line " + std::to_string(i % 1000) + "\n";
+    }
+    std::vector<bxz::Compression> types() const {
+	std::vector<bxz::Compression> available;
+	available.push_back(bxz::plaintext);
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+	available.push_back(bxz::z);
+#endif
+#if defined(BXZSTR_BZ2_SUPPORT) && (BXZSTR_BZ2_SUPPORT) == 1
+	available.push_back(bxz::bz2);
+#endif
+#if defined(BXZSTR_LZMA_SUPPORT) && (BXZSTR_LZMA_SUPPORT) == 1
+	available.push_back(bxz::lzma);
+#endif
+#if defined(BXZSTR_ZSTD_SUPPORT) && (BXZSTR_ZSTD_SUPPORT) == 1
+	available.push_back(bxz::zstd);
+#endif
+	return available;
+    }
+    // Test values
+    std::string data;
+    std::string path = "chunk_test.gz";
+};
+
+#endif
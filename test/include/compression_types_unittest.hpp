@@ -37,6 +37,30 @@ class DetectZTest : public ::testing::Test {
     bxz::Compression expected = bxz::z;
 };
 
+// Detect bxz::bgzf, and gzip headers with other extra fields as bxz::z
+class DetectBgzfTest : public ::testing::Test {
+  protected:
+    void SetUp() {
+	test_headers.emplace_back(std::array<unsigned char, 18>({ 0x1F, 0x8B, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF,
+								  0x06, 0x00, 0x42, 0x43, 0x02, 0x00, 0x1B, 0x00 }));
+	gzip_headers.emplace_back(std::array<unsigned char, 18>({ 0x1F, 0x8B, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF,
+								  0x06, 0x00, 0x41, 0x42, 0x02, 0x00, 0x1B, 0x00 }));
+	gzip_headers.emplace_back(std::array<unsigned char, 18>({ 0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03,
+								  0x06, 0x00, 0x42, 0x43, 0x02, 0x00, 0x1B, 0x00 }));
+    }
+    void TearDown() {
+	test_headers.clear();
+	test_headers.shrink_to_fit();
+	gzip_headers.clear();
+	gzip_headers.shrink_to_fit();
+    }
+    // Test input
+    std::vector<std::array<unsigned char, 18>> test_headers;
+    std::vector<std::array<unsigned char, 18>> gzip_headers;
+    // Expected
+    bxz::Compression expected = bxz::bgzf;
+};
+
 #endif
 
 #if defined(BXZSTR_BZ2_SUPPORT) && (BXZSTR_BZ2_SUPPORT) == 1
@@ -96,6 +120,25 @@ class DetectZstdTest : public ::testing::Test {
 
 #endif
 
+#if defined(BXZSTR_LZ4_SUPPORT) && (BXZSTR_LZ4_SUPPORT) == 1
+// Detect bxz::lz4
+class DetectLz4Test : public ::testing::Test {
+  protected:
+    void SetUp() {
+	test_headers.emplace_back(std::array<unsigned char, 4>({ 0x04, 0x22, 0x4D, 0x18 }));
+    }
+    void TearDown() {
+	test_headers.clear();
+	test_headers.shrink_to_fit();
+    }
+    // Test input
+    std::vector<std::array<unsigned char, 4>> test_headers;
+    // Expected
+    bxz::Compression expected = bxz::lz4;
+};
+
+#endif
+
 // Return plaintext if no header is identified
 class DetectTypeTest : public ::testing::Test {
   protected:
@@ -0,0 +1,56 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_CONTENT_SIZE_UNITTEST_HPP
+#define BXZSTR_CONTENT_SIZE_UNITTEST_HPP
+
+#include <cstdint>
+#include <string>
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+#include "bxzstr.hpp"
+
+// Test bxz::stat() and seeking from the end on 300 KB of text
+class ContentSizeTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+	for (int i = 0; this->data.size() < 300000; ++i) this->data += "line " + std::to_string(i) + "\n";
+    }
+    // Compresses `data` in two parts, as two gzip members, zstd frames, ...
+    // when `split` is set. Small buffers make zstd compress the input
+    // in pieces, so that the frame header only records the size when
+    // it is pledged.
+    std::string compress(const bxz::Compression type, const bxz::params &prm, const bool split = false) const {
+	std::stringbuf out;
+	{
+	    bxz::ostreambuf obuf(&out, type, prm, (std::size_t)1 << 12);
+	    std::ostream os(&obuf);
+	    if (split) os << this->data.substr(0, 100000) << std::flush << this->data.substr(100000);
+	    else os << this->data;
+	}
+	return out.str();
+    }
+    static void put_le32(std::string *out, const uint32_t x) {
+	for (int i = 0; i < 4; ++i) out->push_back((char)((x >> (8*i)) & 0xFF));
+    }
+    // Test values
+    std::string data;
+};
+
+// Stream buffer that cannot seek
+class UnseekableBuf : public std::streambuf {
+  public:
+    explicit UnseekableBuf(std::string _data) : data(_data) {
+	this->setg(&this->data[0], &this->data[0], &this->data[0] + this->data.size());
+    }
+  private:
+    std::string data;
+};
+
+#endif
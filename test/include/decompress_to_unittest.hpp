@@ -0,0 +1,55 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_DECOMPRESS_TO_UNITTEST_HPP
+#define BXZSTR_DECOMPRESS_TO_UNITTEST_HPP
+
+#include <cstdint>
+#include <string>
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+#include "bxzstr.hpp"
+
+// Test bxz::decompress_to with and without inflateBack()
+class DecompressToTest : public ::testing::TestWithParam<bool> {
+  protected:
+    void SetUp() override {
+	for (uint32_t i = 0; i < this->n_lines; ++i) {
+	    this->expected += std::to_string(i) + '\n';
+	}
+	this->prm.z_inflate_back = GetParam();
+	this->prm.z_backend = bxz::gzip_backend_zlib;
+    }
+    void TearDown() override {
+    }
+    std::string compress(const bxz::Compression type) const {
+	std::stringbuf out;
+	{
+	    bxz::ostreambuf obuf(&out, type, 6);
+	    std::ostream os(&obuf);
+	    for (uint32_t i = 0; i < this->n_lines; ++i) {
+		os << i << '\n';
+	    }
+	}
+	return out.str();
+    }
+    std::string decompress(const std::string &data) const {
+	std::stringbuf in(data);
+	std::stringbuf out;
+	const uint64_t n = bxz::decompress_to(&in, &out, this->prm);
+	EXPECT_EQ(n, out.str().size());
+	return out.str();
+    }
+    // Test values
+    uint32_t n_lines = 100000;
+    std::string expected;
+    bxz::params prm;
+};
+
+#endif
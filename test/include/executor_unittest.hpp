@@ -0,0 +1,62 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_EXECUTOR_UNITTEST_HPP
+#define BXZSTR_EXECUTOR_UNITTEST_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "gtest/gtest.h"
+
+#include "bxzstr.hpp"
+
+// An executor that runs each task on the thread pool of the test and
+// counts them, as an application would inject its own pool
+class CountingExecutor : public bxz::executor {
+  public:
+    explicit CountingExecutor(const std::shared_ptr<bxz::executor> &_pool) : submitted(0), pool(_pool) {}
+    void submit(std::function<void()> task) override {
+	++this->submitted;
+	this->pool->submit(std::move(task));
+    }
+    unsigned concurrency() const override { return this->pool->concurrency(); }
+
+    std::atomic<unsigned> submitted;
+
+  private:
+    std::shared_ptr<bxz::executor> pool;
+};
+
+// Test the thread pool, the caps of parallel_for() and injecting an
+// executor
+class ExecutorTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->pool = std::make_shared<bxz::thread_pool_executor>(4);
+    }
+    // Counts the tasks that are done and waits for `n` of them.
+    void task_done() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	++this->done;
+	this->done_cv.notify_all();
+    }
+    void wait_for(const unsigned n) {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->done_cv.wait(lock, [this, n]() { return this->done >= n; });
+    }
+    // Test values
+    std::shared_ptr<bxz::executor> pool;
+    std::mutex mutex;
+    std::condition_variable done_cv;
+    unsigned done = 0;
+};
+
+#endif
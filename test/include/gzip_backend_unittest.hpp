@@ -0,0 +1,83 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_GZIP_BACKEND_UNITTEST_HPP
+#define BXZSTR_GZIP_BACKEND_UNITTEST_HPP
+
+#include <cstdint>
+#include <string>
+#include <sstream>
+#include <iterator>
+#include <tuple>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "bxzstr.hpp"
+
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+// The backends compiled into this build.
+inline std::vector<bxz::GzipBackend> available_gzip_backends() {
+    std::vector<bxz::GzipBackend> backends;
+    const bxz::GzipBackend all[] = { bxz::gzip_backend_zlib, bxz::gzip_backend_zlib_ng, bxz::gzip_backend_isal };
+    for (const bxz::GzipBackend backend : all) {
+	if (bxz::gzip_backend_available(backend)) backends.push_back(backend);
+    }
+    return backends;
+}
+
+// Test the process-wide backend selection
+class GzipBackendSelectionTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+	bxz::set_gzip_backend(bxz::gzip_backend_default);
+    }
+    void TearDown() override {
+	bxz::set_gzip_backend(bxz::gzip_backend_default);
+    }
+};
+
+// Test that every pair of backends can read what the other writes.
+// The first value is the writing backend and the second the reading one.
+class GzipBackendMatrixTest : public ::testing::TestWithParam<std::tuple<bxz::GzipBackend, bxz::GzipBackend>> {
+  protected:
+    void SetUp() override {
+	for (uint32_t i = 0; i < this->n_lines; ++i) {
+	    this->expected += std::to_string(i) + '\n';
+	}
+    }
+    void TearDown() override {
+    }
+    std::string compress(const bxz::GzipBackend backend, const int flush_every) const {
+	bxz::params prm(6);
+	prm.z_backend = backend;
+	std::stringbuf out;
+	{
+	    bxz::ostreambuf obuf(&out, bxz::z, prm);
+	    std::ostream os(&obuf);
+	    for (uint32_t i = 0; i < this->n_lines; ++i) {
+		os << i << '\n';
+		if (flush_every > 0 && i % flush_every == 0) os.flush();
+	    }
+	}
+	return out.str();
+    }
+    std::string decompress(const bxz::GzipBackend backend, const std::string &data) const {
+	bxz::params prm;
+	prm.z_backend = backend;
+	std::stringbuf in(data);
+	bxz::istreambuf ibuf(&in, prm);
+	// read through the streambuf so that exceptions are not caught
+	return std::string(std::istreambuf_iterator<char>(&ibuf), std::istreambuf_iterator<char>());
+    }
+    // Test values
+    uint32_t n_lines = 100000;
+    std::string expected;
+};
+#endif
+
+#endif
@@ -0,0 +1,49 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_LINE_READER_UNITTEST_HPP
+#define BXZSTR_LINE_READER_UNITTEST_HPP
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "bxzstr.hpp"
+
+// Test bxz::line_reader on FASTQ records
+class LineReaderTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+	for (int i = 0; this->data.size() < 500000; ++i) {
+	    const std::string seq(50 + i % 100, "ACGT"[i % 4]);
+	    this->data += "@read" + std::to_string(i) + "\n" + seq + "\n+\n" + std::string(seq.size(), 'I') + "\n";
+	}
+    }
+    // The lines of `text` split with std::getline().
+    static std::vector<std::string> getlines(const std::string &text, const char delim = '\n') {
+	std::istringstream in(text);
+	std::vector<std::string> lines;
+	for (std::string line; std::getline(in, line, delim); ) lines.push_back(line);
+	return lines;
+    }
+    // The lines of `text` compressed in `type` and read with a
+    // line_reader from an istreambuf with `buff_size` byte buffers.
+    static std::vector<std::string> read_lines(const bxz::Compression type, const std::string &text,
+					       const std::size_t buff_size, const char delim = '\n') {
+	std::stringbuf in(bxz::compress(type, text));
+	bxz::istreambuf ibuf(&in, type, buff_size);
+	std::vector<std::string> lines;
+	for (const bxz::chunk &line : bxz::line_reader(ibuf, delim)) lines.push_back(line.str());
+	return lines;
+    }
+    // Test values
+    std::string data;
+};
+
+#endif
@@ -0,0 +1,104 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "bxzstr.hpp"
+
+#if defined(BXZSTR_LZ4_SUPPORT) && (BXZSTR_LZ4_SUPPORT) == 1
+
+#ifndef BXZSTR_LZ4_STREAM_WRAPPER_UNITTEST_HPP
+#define BXZSTR_LZ4_STREAM_WRAPPER_UNITTEST_HPP
+
+#include <string>
+#include <cstddef>
+
+#include "gtest/gtest.h"
+#include "lz4frame.h"
+
+
+// Test lz4Exception
+class Lz4ExceptionTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->msgConstructorValue = "urpdcjgztzcowdpiucfrhxczlgbbopeg";
+	this->msgConstructorExpected = "urpdcjgztzcowdpiucfrhxczlgbbopeg";
+	this->errcodeConstructorValue = -1;
+	this->errcodeConstructorExpected = "lz4 error: [18446744073709551615]: ERROR_GENERIC";
+    }
+    void TearDown() override {
+    }
+    // Test values
+    std::string msgConstructorValue;
+    size_t errcodeConstructorValue;
+    // Expecteds
+    std::string msgConstructorExpected;
+    std::string errcodeConstructorExpected;
+};
+
+// Test lz4_stream_wrapper
+class Lz4StreamWrapperTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->testTrue = true;
+	this->testFalse = false;
+    }
+    void TearDown() override {
+    }
+    // Test values
+    bool testTrue;
+    bool testFalse;
+};
+
+// Common inputs/outputs for compression and decompression testing
+class Lz4CompressAndDecompressTest {
+  protected:
+    unsigned char test_vals[26] = { 0x04, 0x22, 0x4d, 0x18, 0x40, 0x40, 0xc0, 0x0b, 0x00, 0x00, 0x00, 0x28, 0x31, 0x0a, 0x02, 0x00,
+	                            0x50, 0x31, 0x0a, 0x31, 0x0a, 0x31, 0x00, 0x00, 0x00, 0x00 };
+    unsigned char output_vals[64] = { 0 };
+
+    unsigned char* testIn;
+    const unsigned char* testOut;
+    bxz::detail::lz4_stream_wrapper* wrapper;
+
+    void set_addresses(bxz::detail::lz4_stream_wrapper* wrapper) {
+	wrapper->set_next_in(&testIn[0]);
+	wrapper->set_avail_in(10);
+	wrapper->set_next_out(&testOut[0]);
+	wrapper->set_avail_out(64);
+    }
+};
+
+// Test decompress
+class Lz4DecompressTest : public Lz4CompressAndDecompressTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->testIn = reinterpret_cast<unsigned char*>(test_vals);
+	this->testOut = reinterpret_cast<const unsigned char*>(output_vals);
+	wrapper = new bxz::detail::lz4_stream_wrapper();
+	this->set_addresses(wrapper);
+    }
+    void TearDown() override {
+	delete wrapper;
+    }
+};
+
+// Test compress
+class Lz4CompressTest : public Lz4CompressAndDecompressTest, public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->testIn = reinterpret_cast<unsigned char*>(test_vals);
+	this->testOut = reinterpret_cast<const unsigned char*>(output_vals);
+	wrapper = new bxz::detail::lz4_stream_wrapper(false);
+	this->set_addresses(wrapper);
+    }
+    void TearDown() override {
+	delete wrapper;
+    }
+};
+
+#endif
+
+#endif
@@ -0,0 +1,66 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_MEMORY_UNITTEST_HPP
+#define BXZSTR_MEMORY_UNITTEST_HPP
+
+#include <cstdint>
+#include <string>
+#include <sstream>
+#include <iterator>
+
+#include "gtest/gtest.h"
+
+#include "bxzstr.hpp"
+
+// Test the global memory budget
+class MemoryBudgetTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->old_budget = bxz::memory_budget();
+    }
+    void TearDown() override {
+	bxz::set_memory_budget(this->old_budget);
+    }
+    // Test values
+    uint64_t old_budget;
+    std::stringbuf sbuf;
+    std::size_t buff_size = (std::size_t)1 << 16;
+};
+
+// Test per-stream memory limits
+class MemoryLimitTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+	this->prm.memory_limit = (uint64_t)1 << 16;
+    }
+    void TearDown() override {
+    }
+    // Compresses n_lines lines of text with type and prm.
+    std::string compress(const bxz::Compression type, const bxz::params &p, const uint32_t n_lines) const {
+	std::stringbuf out;
+	{
+	    bxz::ostreambuf obuf(&out, type, p);
+	    std::ostream os(&obuf);
+	    for (uint32_t i = 0; i < n_lines; ++i) {
+		os << i << '\n';
+	    }
+	}
+	return out.str();
+    }
+    // Decompresses everything in data with prm.
+    std::string decompress(const std::string &data) const {
+	std::stringbuf in(data);
+	bxz::istreambuf ibuf(&in, this->prm);
+	// read through the streambuf so that exceptions are not caught
+	return std::string(std::istreambuf_iterator<char>(&ibuf), std::istreambuf_iterator<char>());
+    }
+    // Test values
+    bxz::params prm;
+};
+
+#endif
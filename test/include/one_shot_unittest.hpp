@@ -0,0 +1,55 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_ONE_SHOT_UNITTEST_HPP
+#define BXZSTR_ONE_SHOT_UNITTEST_HPP
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "bxzstr.hpp"
+
+// Test the one-shot compress() and decompress() on a 4 KB message and
+// on 1 MB of text
+class OneShotTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+	for (int i = 0; this->large.size() < 1000000; ++i) this->large += "line " + std::to_string(i % 5000) + "\n";
+	this->message = this->large.substr(0, 4096);
+    }
+    std::vector<bxz::Compression> types() const {
+	std::vector<bxz::Compression> available;
+	available.push_back(bxz::plaintext);
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+	available.push_back(bxz::z);
+	available.push_back(bxz::bgzf);
+#endif
+#if defined(BXZSTR_BZ2_SUPPORT) && (BXZSTR_BZ2_SUPPORT) == 1
+	available.push_back(bxz::bz2);
+#endif
+#if defined(BXZSTR_LZMA_SUPPORT) && (BXZSTR_LZMA_SUPPORT) == 1
+	available.push_back(bxz::lzma);
+#endif
+#if defined(BXZSTR_ZSTD_SUPPORT) && (BXZSTR_ZSTD_SUPPORT) == 1
+	available.push_back(bxz::zstd);
+#endif
+#if defined(BXZSTR_LZ4_SUPPORT) && (BXZSTR_LZ4_SUPPORT) == 1
+	available.push_back(bxz::lz4);
+#endif
+#if defined(BXZSTR_BROTLI_SUPPORT) && (BXZSTR_BROTLI_SUPPORT) == 1
+	available.push_back(bxz::brotli);
+#endif
+	return available;
+    }
+    // Test values
+    std::string message;
+    std::string large;
+};
+
+#endif
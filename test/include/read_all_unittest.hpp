@@ -0,0 +1,40 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_READ_ALL_UNITTEST_HPP
+#define BXZSTR_READ_ALL_UNITTEST_HPP
+
+#include <cstdio>
+#include <string>
+#include <fstream>
+
+#include "gtest/gtest.h"
+
+#include "bxzstr.hpp"
+
+// Test bxz::read_all() on 1 MB of text written to a file
+class ReadAllTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+	for (int i = 0; this->data.size() < 1000000; ++i) this->data += "line " + std::to_string(i % 1000) + "\n";
+    }
+    void TearDown() override {
+	std::remove(this->path.c_str());
+    }
+    // Writes `data` to the test file in two parts, as two gzip members,
+    // zstd frames, ... when `split` is set.
+    void write(const bxz::Compression type, const bool split = false, const bxz::params &prm = bxz::params()) {
+	bxz::ofstream out(this->path, type, prm);
+	if (split) out << this->data.substr(0, 300000) << std::flush << this->data.substr(300000);
+	else out << this->data;
+    }
+    // Test values
+    std::string data;
+    std::string path = "read_all_test.bin";
+};
+
+#endif
@@ -0,0 +1,61 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_RSYNCABLE_UNITTEST_HPP
+#define BXZSTR_RSYNCABLE_UNITTEST_HPP
+
+#include <cstdint>
+#include <string>
+#include <sstream>
+#include <iterator>
+
+#include "gtest/gtest.h"
+
+#include "bxzstr.hpp"
+
+// Test rsyncable output on text where one byte near the start is
+// changed between two versions
+class RsyncableTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+	const char* words[] = { "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing",
+				"elit", "sed", "do", "eiusmod", "tempor", "incididunt", "labore" };
+	uint64_t x = 88172645463325252ULL;
+	while (this->original.size() < ((size_t)1 << 23)) {
+	    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+	    this->original += words[x % 14];
+	    this->original += (x % 11 == 0 ? ".\n" : " ");
+	}
+	this->edited = this->original;
+	this->edited[100] = '#';
+    }
+    std::string compress(const std::string &data, const bxz::Compression type, const bxz::params &prm) const {
+	std::stringbuf out;
+	{
+	    bxz::ostreambuf obuf(&out, type, prm);
+	    std::ostream os(&obuf);
+	    os << data;
+	}
+	return out.str();
+    }
+    std::string decompress(const std::string &data) const {
+	std::stringbuf in(data);
+	bxz::istreambuf ibuf(&in);
+	return std::string(std::istreambuf_iterator<char>(&ibuf), std::istreambuf_iterator<char>());
+    }
+    // Length of the common suffix of `a` and `b` before the last `skip` bytes.
+    static size_t common_suffix(const std::string &a, const std::string &b, const size_t skip = 0) {
+	size_t n = skip;
+	while (n < a.size() && n < b.size() && a[a.size() - 1 - n] == b[b.size() - 1 - n]) ++n;
+	return n - skip;
+    }
+    // Test values
+    std::string original;
+    std::string edited;
+};
+
+#endif
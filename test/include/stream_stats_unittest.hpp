@@ -0,0 +1,42 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#ifndef BXZSTR_STREAM_STATS_UNITTEST_HPP
+#define BXZSTR_STREAM_STATS_UNITTEST_HPP
+
+#include <string>
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+#include "bxzstr.hpp"
+
+// Test stream_stats on two gzip members
+class StreamStatsTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+	for (int i = 0; i < 50000; ++i) this->data += "line " + std::to_string(i) + "\n";
+	std::stringbuf out;
+	{
+	    bxz::ostreambuf obuf(&out, bxz::z, 6);
+	    std::ostream os(&obuf);
+	    os << this->data.substr(0, 100000) << std::flush;
+	    os << this->data.substr(100000);
+	}
+	this->compressed = out.str();
+    }
+    bxz::params stats_params() const {
+	bxz::params prm;
+	prm.collect_stats = true;
+	return prm;
+    }
+    // Test values
+    std::string data;
+    std::string compressed;
+};
+
+#endif
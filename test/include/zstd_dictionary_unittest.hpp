@@ -0,0 +1,64 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "bxzstr.hpp"
+
+#if defined(BXZSTR_ZSTD_SUPPORT) && (BXZSTR_ZSTD_SUPPORT) == 1
+
+#ifndef BXZSTR_ZSTD_DICTIONARY_UNITTEST_HPP
+#define BXZSTR_ZSTD_DICTIONARY_UNITTEST_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iterator>
+
+#include "gtest/gtest.h"
+
+// Test zstd dictionaries on small JSON records
+class ZstdDictionaryTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+	const char* names[] = { "alice", "bob", "carol", "dave", "erin", "frank" };
+	const char* cities[] = { "Helsinki", "Espoo", "Tampere", "Turku", "Oulu" };
+	for (uint32_t i = 0; i < 2000; ++i) {
+	    this->samples.push_back("{\"id\": " + std::to_string(i) + ", \"name\": \"" + names[i % 6]
+				    + "\", \"city\": \"" + cities[(i*7) % 5] + "\", \"active\": "
+				    + (i % 3 == 0 ? "true" : "false") + ", \"score\": " + std::to_string((i*37) % 1000)
+				    + ", \"tags\": [\"customer\", \"newsletter\"]}\n");
+	}
+	this->dict = bxz::train_zstd_dictionary(this->samples, 4096);
+	this->dict_id = bxz::add_zstd_dictionary(this->dict);
+    }
+    void TearDown() override {
+	bxz::remove_zstd_dictionary(this->dict_id);
+    }
+    std::string compress(const std::string &record, const bxz::params &prm) const {
+	std::stringbuf out;
+	{
+	    bxz::ostreambuf obuf(&out, bxz::zstd, prm);
+	    std::ostream os(&obuf);
+	    os << record;
+	}
+	return out.str();
+    }
+    std::string decompress(const std::string &data, const bxz::params &prm = bxz::params()) const {
+	std::stringbuf in(data);
+	bxz::istreambuf ibuf(&in, prm);
+	// read through the streambuf so that exceptions are not caught
+	return std::string(std::istreambuf_iterator<char>(&ibuf), std::istreambuf_iterator<char>());
+    }
+    // Test values
+    std::vector<std::string> samples;
+    std::string dict;
+    uint32_t dict_id;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,73 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "bxzstr.hpp"
+
+#if defined(BXZSTR_ZSTD_SUPPORT) && (BXZSTR_ZSTD_SUPPORT) == 1
+
+#ifndef BXZSTR_ZSTD_PATCH_UNITTEST_HPP
+#define BXZSTR_ZSTD_PATCH_UNITTEST_HPP
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+
+#include "gtest/gtest.h"
+
+// Test zstd patch mode on a random "snapshot" and a slightly edited
+// next version of it
+class ZstdPatchTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+	uint64_t x = 88172645463325252ULL;
+	this->reference.resize((size_t)1 << 22);
+	for (size_t i = 0; i < this->reference.size(); ++i) {
+	    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+	    this->reference[i] = (char)(x & 0xff);
+	}
+	this->next_version = this->reference;
+	for (size_t i = 1000; i < this->next_version.size(); i += 500000) this->next_version[i] ^= 0x5a;
+	this->next_version.insert(2000000, "some inserted bytes");
+	this->next_version.erase(3000000, 100);
+	std::ofstream out(this->reference_path, std::ios_base::out | std::ios_base::binary);
+	out << this->reference;
+    }
+    void TearDown() override {
+	std::remove(this->reference_path.c_str());
+    }
+    std::string compress(const std::string &data, const bxz::params &prm) const {
+	std::stringbuf out;
+	{
+	    bxz::ostreambuf obuf(&out, bxz::zstd, prm);
+	    std::ostream os(&obuf);
+	    os << data;
+	}
+	return out.str();
+    }
+    std::string decompress(const std::string &data, const bxz::params &prm) const {
+	std::stringbuf in(data);
+	bxz::istreambuf ibuf(&in, prm);
+	// read through the streambuf so that exceptions are not caught
+	return std::string(std::istreambuf_iterator<char>(&ibuf), std::istreambuf_iterator<char>());
+    }
+    bxz::params patch_params() const {
+	bxz::params prm(3);
+	prm.zstd_patch_from = this->reference_path;
+	return prm;
+    }
+    // Test values
+    std::string reference;
+    std::string next_version;
+    const std::string reference_path = "zstd_patch_reference.bin";
+};
+
+#endif
+
+#endif
@@ -0,0 +1,77 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "adaptive_level_unittest.hpp"
+
+TEST_F(AdaptiveLevelTest, LevelIsClampedToTheBounds) {
+    bxz::detail::adaptive_level adapt(12, 1, 9);
+    EXPECT_EQ(adapt.level(), 9);
+    int level = 0;
+    adapt.record(std::chrono::milliseconds(10), std::chrono::milliseconds(1));
+    EXPECT_TRUE(adapt.update(&level));
+    EXPECT_EQ(level, 8);
+    adapt.set_level(level);
+    // similar times keep the level
+    adapt.record(std::chrono::milliseconds(10), std::chrono::milliseconds(11));
+    EXPECT_FALSE(adapt.update(&level));
+    EXPECT_EQ(adapt.level(), 8);
+}
+
+TEST_F(AdaptiveLevelTest, LevelChangesOnlyWhenSet) {
+    bxz::detail::adaptive_level adapt(6, 1, 9);
+    int level = 0;
+    adapt.record(std::chrono::milliseconds(10), std::chrono::milliseconds(1));
+    EXPECT_TRUE(adapt.update(&level));
+    EXPECT_EQ(level, 5);
+    // e.g. the codec could not change
+    EXPECT_EQ(adapt.level(), 6);
+    adapt.record(std::chrono::milliseconds(10), std::chrono::milliseconds(1));
+    EXPECT_TRUE(adapt.update(&level));
+    EXPECT_EQ(level, 5);
+}
+
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+TEST_F(AdaptiveLevelTest, GzipRaisesLevelForSlowSink) {
+    SlowSink sink;
+    EXPECT_EQ(this->compress(&sink, bxz::z, this->adaptive_params(3)), 9);
+    EXPECT_EQ(this->data, this->decompress(sink.str()));
+}
+
+TEST_F(AdaptiveLevelTest, GzipLowersLevelForFastSink) {
+    std::stringbuf sink;
+    EXPECT_EQ(this->compress(&sink, bxz::z, this->adaptive_params(9)), 1);
+    EXPECT_EQ(this->data, this->decompress(sink.str()));
+}
+
+TEST_F(AdaptiveLevelTest, StaysWithinConfiguredBounds) {
+    bxz::params prm = this->adaptive_params(6);
+    prm.adaptive_min_level = 4;
+    prm.adaptive_max_level = 7;
+    std::stringbuf fast;
+    EXPECT_EQ(this->compress(&fast, bxz::z, prm), 4);
+    SlowSink slow;
+    EXPECT_EQ(this->compress(&slow, bxz::z, prm), 7);
+}
+
+TEST_F(AdaptiveLevelTest, FixedLevelWithoutAdaptiveLevel) {
+    SlowSink sink;
+    EXPECT_EQ(this->compress(&sink, bxz::z, bxz::params(3)), 3);
+}
+#endif
+
+#if defined(BXZSTR_ZSTD_SUPPORT) && (BXZSTR_ZSTD_SUPPORT) == 1
+TEST_F(AdaptiveLevelTest, ZstdFollowsTheSink) {
+    bxz::params prm = this->adaptive_params(3);
+    prm.adaptive_max_level = 12;
+    SlowSink slow;
+    EXPECT_EQ(this->compress(&slow, bxz::zstd, prm), 12);
+    EXPECT_EQ(this->data, this->decompress(slow.str()));
+    std::stringbuf fast;
+    EXPECT_LT(this->compress(&fast, bxz::zstd, prm), 3);
+    EXPECT_EQ(this->data, this->decompress(fast.str()));
+}
+#endif
@@ -0,0 +1,91 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "batch_unittest.hpp"
+
+#include <stdexcept>
+
+TEST_F(BatchTest, RoundTrip) {
+    for (const bxz::Compression type : this->types()) {
+	for (const bxz::batch_result &result : this->compress(type, bxz::params(3), 4)) EXPECT_TRUE(result.ok()) << type;
+	for (std::size_t i = 0; i < this->pages.size(); ++i)
+	    EXPECT_TRUE(bxz::decompress(this->compressed[i], type) == this->pages[i]) << type;
+	const std::vector<bxz::batch_result> results = this->decompress(type, bxz::params(), 4);
+	for (std::size_t i = 0; i < results.size(); ++i) {
+	    EXPECT_TRUE(results[i].ok()) << type << " " << results[i].error;
+	    EXPECT_EQ(results[i].size, this->pages[i].size()) << type;
+	    EXPECT_TRUE(this->decompressed[i] == this->pages[i]) << type;
+	}
+    }
+}
+
+TEST_F(BatchTest, SameOutputOnAnyNumberOfThreads) {
+    for (const bxz::Compression type : this->types()) {
+	this->compress(type, bxz::params(), 1);
+	const std::vector<std::string> serial = this->compressed;
+	this->compress(type, bxz::params(), 0);
+	EXPECT_TRUE(this->compressed == serial) << type;
+    }
+}
+
+TEST_F(BatchTest, DetectsTheFormat) {
+    for (const bxz::Compression type : this->types()) {
+	this->compress(type, bxz::params(), 2);
+	for (const bxz::batch_result &result : this->decompress(bxz::none, bxz::params(), 2))
+	    EXPECT_TRUE(result.ok()) << type << " " << result.error;
+	EXPECT_TRUE(this->decompressed == this->pages) << type;
+    }
+}
+
+TEST_F(BatchTest, ItemsFailOnTheirOwn) {
+    for (const bxz::Compression type : this->types()) {
+	this->compress(type, bxz::params(), 3);
+	this->compressed[7].resize(this->compressed[7].size()/2);
+	const std::vector<bxz::batch_result> results = this->decompress(type, bxz::params(), 3);
+	for (std::size_t i = 0; i < results.size(); ++i) {
+	    if (i == 7 && type != bxz::plaintext) {
+		EXPECT_FALSE(results[i].ok()) << type;
+	    } else {
+		EXPECT_TRUE(results[i].ok()) << type;
+		EXPECT_TRUE(i == 7 || this->decompressed[i] == this->pages[i]) << type;
+	    }
+	}
+    }
+}
+
+TEST_F(BatchTest, OutputTooSmallFailsTheItem) {
+    std::vector<bxz::batch_input> inputs = { bxz::batch_input(this->pages[0].data(), this->pages[0].size()) };
+    std::vector<char> out(8);
+    std::vector<bxz::batch_output> outputs = { bxz::batch_output(out.data(), out.size()) };
+    const std::vector<bxz::batch_result> results = bxz::compress_batch(bxz::plaintext, inputs, outputs);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_FALSE(results[0].ok());
+    outputs.clear();
+    EXPECT_THROW(bxz::compress_batch(bxz::plaintext, inputs, outputs), std::runtime_error);
+}
+
+TEST_F(BatchTest, EmptyBatch) {
+    EXPECT_TRUE(bxz::compress_batch(bxz::plaintext, std::vector<bxz::batch_input>(),
+				    std::vector<bxz::batch_output>()).empty());
+}
+
+#if defined(BXZSTR_ZSTD_SUPPORT) && (BXZSTR_ZSTD_SUPPORT) == 1
+TEST_F(BatchTest, ZstdDictionary) {
+    std::vector<std::string> samples;
+    for (const std::string &page : this->pages) samples.push_back(page.substr(0, 512));
+    bxz::params prm;
+    prm.zstd_dict_id = bxz::add_zstd_dictionary(bxz::train_zstd_dictionary(samples, 4096));
+    for (const bxz::batch_result &result : this->compress(bxz::zstd, prm, 4)) EXPECT_TRUE(result.ok()) << result.error;
+    EXPECT_EQ(ZSTD_getDictID_fromFrame(this->compressed[0].data(), this->compressed[0].size()), prm.zstd_dict_id);
+    // the dictionary is found from the frame headers
+    for (const bxz::batch_result &result : this->decompress(bxz::zstd, bxz::params(), 4))
+	EXPECT_TRUE(result.ok()) << result.error;
+    EXPECT_TRUE(this->decompressed == this->pages);
+    bxz::remove_zstd_dictionary(prm.zstd_dict_id);
+    for (const bxz::batch_result &result : this->decompress(bxz::zstd, bxz::params(), 4)) EXPECT_FALSE(result.ok());
+}
+#endif
@@ -0,0 +1,119 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "bxzstr.hpp"
+
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+
+#include "bgzf_stream_wrapper_unittest.hpp"
+
+#include "zlib.h"
+
+TEST_F(BgzfExceptionTest, MsgConstructorWorks) {
+    bxz::bgzfException e(msgConstructorValue);
+    const std::string &got = e.what();
+    EXPECT_EQ(msgConstructorExpected, got);
+}
+
+TEST_F(BgzfStreamWrapperTest, ConstructorDoesNotThrowOnInput) {
+    EXPECT_NO_THROW(bxz::detail::bgzf_stream_wrapper wrapper(testTrue));
+}
+
+TEST_F(BgzfStreamWrapperTest, ConstructorDoesNotThrowOnOutput) {
+    EXPECT_NO_THROW(bxz::detail::bgzf_stream_wrapper wrapper(testFalse));
+}
+
+TEST_F(BgzfStreamWrapperTest, ParamsConstructorDoesNotThrowOnInput) {
+    bxz::params p(9);
+    p.verify_checksums = false;
+    EXPECT_NO_THROW(bxz::detail::bgzf_stream_wrapper wrapper(testTrue, p));
+}
+
+TEST_F(BgzfStreamWrapperTest, ParamsConstructorThrowsOnInvalidLevel) {
+    bxz::params p(100);
+    EXPECT_ANY_THROW(bxz::detail::bgzf_stream_wrapper wrapper(testFalse, p));
+}
+
+TEST_F(BgzfDecompressTest, DecompressDoesNotThrowOnValidBlock) {
+    EXPECT_NO_THROW(wrapper->decompress());
+}
+
+TEST_F(BgzfDecompressTest, DecompressBuffersPartialBlock) {
+    wrapper->decompress();
+    EXPECT_EQ(wrapper->next_in(), &testIn[10]);
+    EXPECT_EQ(wrapper->avail_in(), 0);
+    EXPECT_EQ(wrapper->next_out(), &testOut[0]);
+    EXPECT_EQ(wrapper->avail_out(), 64);
+    EXPECT_FALSE(wrapper->stream_end());
+}
+
+TEST_F(BgzfDecompressTest, DecompressWholeBlock) {
+    wrapper->set_avail_in(32);
+    wrapper->decompress();
+    EXPECT_EQ(wrapper->avail_in(), 0);
+    EXPECT_EQ(wrapper->avail_out(), 64 - 10*2 + 1);
+    EXPECT_EQ(output_vals[0], '1');
+    EXPECT_EQ(output_vals[1], '\n');
+    EXPECT_FALSE(wrapper->stream_end());
+}
+
+TEST_F(BgzfDecompressTest, DecompressEndsStream) {
+    wrapper->set_avail_in(10);
+    wrapper->decompress();
+    wrapper->set_avail_in(50);
+    wrapper->decompress();
+    EXPECT_TRUE(wrapper->stream_end());
+    EXPECT_EQ(wrapper->avail_out(), 64 - 10*2 + 1);
+}
+
+TEST_F(BgzfDecompressTest, DecompressInflatesPlainGzip) {
+    // the first block as a gzip member without the BC field
+    unsigned char plain[24] = { 0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x33, 0xe4,
+				0x32, 0x44, 0x87, 0x00, 0xae, 0x30, 0x5a, 0x73, 0x13, 0x00, 0x00, 0x00 };
+    wrapper->set_next_in(plain);
+    wrapper->set_avail_in(24);
+    EXPECT_NO_THROW(wrapper->decompress());
+    EXPECT_TRUE(wrapper->stream_end());
+    EXPECT_EQ(wrapper->avail_in(), 0);
+    EXPECT_EQ(wrapper->avail_out(), 64 - 10*2 + 1);
+    EXPECT_EQ(output_vals[0], '1');
+}
+
+TEST_F(BgzfDecompressTest, DecompressThrowsOnNonGzip) {
+    test_vals[0] = 0x00;
+    wrapper->set_avail_in(32);
+    EXPECT_THROW(wrapper->decompress(), bxz::bgzfException);
+}
+
+TEST_F(BgzfCompressTest, CompressEndsStream) {
+    wrapper->compress(Z_NO_FLUSH);
+    wrapper->set_avail_out(64);
+    EXPECT_NO_THROW(wrapper->compress(Z_FINISH));
+    EXPECT_TRUE(wrapper->done());
+}
+
+TEST_F(BgzfCompressTest, CompressDoesNotThrowOnValidInput) {
+    EXPECT_NO_THROW(wrapper->compress(Z_NO_FLUSH));
+}
+
+TEST_F(BgzfCompressTest, CompressBuffersInputUntilFlush) {
+    wrapper->compress(Z_NO_FLUSH);
+    EXPECT_EQ(wrapper->next_in(), &testIn[10]);
+    EXPECT_EQ(wrapper->avail_in(), 0);
+    EXPECT_EQ(wrapper->next_out(), &testOut[0]);
+    wrapper->compress(Z_SYNC_FLUSH);
+    EXPECT_GT(wrapper->next_out(), &testOut[0]);
+    EXPECT_FALSE(wrapper->done());
+}
+
+TEST_F(BgzfCompressTest, CompressWritesBlockSize) {
+    wrapper->compress(Z_SYNC_FLUSH);
+    const size_t written = wrapper->next_out() - &testOut[0];
+    EXPECT_EQ(bxz::detail::bgzf_stream_wrapper::block_size(&testOut[0], written), written);
+}
+
+#endif
@@ -0,0 +1,91 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "bxzstr.hpp"
+
+#if defined(BXZSTR_BROTLI_SUPPORT) && (BXZSTR_BROTLI_SUPPORT) == 1
+
+#include "brotli_stream_wrapper_unittest.hpp"
+
+#include "brotli/encode.h"
+
+TEST_F(BrotliExceptionTest, MsgConstructorWorks) {
+    bxz::brotliException e(msgConstructorValue);
+    const std::string &got = e.what();
+    EXPECT_EQ(msgConstructorExpected, got);
+}
+
+TEST_F(BrotliExceptionTest, ErrcodeConstructorWorks) {
+    bxz::brotliException e(errcodeConstructorValue);
+    const std::string &got = e.what();
+    EXPECT_EQ(errcodeConstructorExpected, got);
+}
+
+TEST_F(BrotliStreamWrapperTest, ConstructorDoesNotThrowOnInput) {
+    EXPECT_NO_THROW(bxz::detail::brotli_stream_wrapper wrapper(testTrue));
+}
+
+TEST_F(BrotliStreamWrapperTest, ConstructorDoesNotThrowOnOutput) {
+    EXPECT_NO_THROW(bxz::detail::brotli_stream_wrapper wrapper(testFalse));
+}
+
+TEST_F(BrotliStreamWrapperTest, ParamsConstructorDoesNotThrowOnInput) {
+    bxz::params p(11);
+    EXPECT_NO_THROW(bxz::detail::brotli_stream_wrapper wrapper(testTrue, p));
+}
+
+TEST_F(BrotliStreamWrapperTest, ParamsConstructorDoesNotThrowOnOutput) {
+    bxz::params p(11);
+    p.brotli_window_log = 24;
+    p.brotli_mode = BROTLI_MODE_TEXT;
+    EXPECT_NO_THROW(bxz::detail::brotli_stream_wrapper wrapper(testFalse, p));
+}
+
+TEST_F(BrotliStreamWrapperTest, ParamsConstructorThrowsOnInvalidParams) {
+    bxz::params p(12);
+    EXPECT_THROW(bxz::detail::brotli_stream_wrapper wrapper(testFalse, p), bxz::brotliException);
+    bxz::params q(6);
+    q.brotli_window_log = 25;
+    EXPECT_THROW(bxz::detail::brotli_stream_wrapper wrapper(testFalse, q), bxz::brotliException);
+}
+
+TEST_F(BrotliDecompressTest, DecompressDoesNotThrowOnValidStream) {
+    EXPECT_NO_THROW(wrapper->decompress());
+}
+
+TEST_F(BrotliDecompressTest, DecompressUpdatesStreamState) {
+    wrapper->decompress();
+    EXPECT_EQ(wrapper->next_in(), &testIn[10]);
+    EXPECT_EQ(wrapper->avail_in(), 0);
+    EXPECT_FALSE(wrapper->stream_end());
+}
+
+TEST_F(BrotliDecompressTest, DecompressEndsStream) {
+    wrapper->set_avail_in(11);
+    wrapper->decompress();
+    EXPECT_TRUE(wrapper->stream_end());
+    EXPECT_EQ(wrapper->avail_out(), 64 - 10*2 + 1);
+}
+
+TEST_F(BrotliCompressTest, CompressEndsStream) {
+    wrapper->compress(BROTLI_OPERATION_PROCESS);
+    EXPECT_NO_THROW(wrapper->compress(BROTLI_OPERATION_FINISH));
+    EXPECT_TRUE(wrapper->done());
+}
+
+TEST_F(BrotliCompressTest, CompressDoesNotThrowOnValidInput) {
+    EXPECT_NO_THROW(wrapper->compress(BROTLI_OPERATION_PROCESS));
+}
+
+TEST_F(BrotliCompressTest, CompressUpdatesStreamState) {
+    wrapper->compress(BROTLI_OPERATION_PROCESS);
+    EXPECT_EQ(wrapper->next_in(), &testIn[10]);
+    EXPECT_EQ(wrapper->avail_in(), 0);
+    EXPECT_FALSE(wrapper->done());
+}
+
+#endif
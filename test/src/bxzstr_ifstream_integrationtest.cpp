@@ -13,6 +13,78 @@ TEST_F(ZDecompressionTest, BxzIfstreamDecompressesZ) {
     this->run_test();
 }
 
+TEST_F(ZDecompressionTest, BxzIfstreamDecompressesZWithoutChecksums) {
+    bxz::params prm;
+    prm.verify_checksums = false;
+    this->run_test(prm);
+}
+
+TEST_F(ZCorruptChecksumTest, BxzIfstreamThrowsOnCorruptChecksum) {
+    EXPECT_ANY_THROW(this->run_test());
+}
+
+TEST_F(ZCorruptChecksumTest, BxzIfstreamIgnoresCorruptChecksum) {
+    bxz::params prm;
+    prm.verify_checksums = false;
+    this->run_test(prm);
+}
+
+TEST_F(ZCorruptChecksumTest, BxzIfstreamOpenKeepsParams) {
+    bxz::params prm;
+    prm.verify_checksums = false;
+    bxz::ifstream in(this->test_infile, prm);
+    in.open(this->test_infile);
+    std::string line;
+    uint32_t i = 0;
+    EXPECT_NO_THROW(while (std::getline(in, line)) ++i);
+    EXPECT_EQ(i, this->n_in_vals);
+}
+
+TEST_F(ZConcatenatedDecompressionTest, BxzIfstreamDecompressesConcatenatedZ) {
+    this->run_concatenated_test(bxz::params());
+}
+
+TEST_F(ZConcatenatedDecompressionTest, BxzIfstreamDecompressesConcatenatedZWithoutChecksums) {
+    bxz::params prm;
+    prm.verify_checksums = false;
+    this->run_concatenated_test(prm);
+}
+
+TEST_F(ZTruncatedDecompressionTest, BxzIstreambufEndsAtTruncatedInput) {
+    // the output buffer fills at the end of the input for some sizes
+    std::string expected;
+    for (uint32_t i = 0; i < this->n_in_vals; ++i) expected += "1\n";
+    for (std::size_t size = 8; size <= 32; ++size) {
+	std::string got;
+	EXPECT_NO_THROW(got = this->read_with_buffer(size));
+	EXPECT_EQ(got, expected);
+    }
+}
+
+TEST_F(ZReadSizeGrowthTest, BxzIfstreamReadsPastInitialReadSize) {
+    bxz::ifstream in(this->test_infile);
+    std::string line;
+    uint32_t i = 0;
+    while (std::getline(in, line)) {
+	EXPECT_EQ(line, std::to_string(i));
+	++i;
+    }
+    EXPECT_EQ(i, this->n_lines);
+}
+
+TEST_F(ZReadSizeGrowthTest, BxzIfstreamReadsPastInitialReadSizeWithoutChecksums) {
+    bxz::params prm;
+    prm.verify_checksums = false;
+    bxz::ifstream in(this->test_infile, prm);
+    std::string line;
+    uint32_t i = 0;
+    while (std::getline(in, line)) {
+	EXPECT_EQ(line, std::to_string(i));
+	++i;
+    }
+    EXPECT_EQ(i, this->n_lines);
+}
+
 #endif
 
 #if defined(BXZSTR_BZ2_SUPPORT) && (BXZSTR_BZ2_SUPPORT) == 1
@@ -29,6 +101,12 @@ TEST_F(LzmaDecompressionTest, BxzIfstreamDecompressesLzma) {
     this->run_test();
 }
 
+TEST_F(LzmaDecompressionTest, BxzIfstreamDecompressesLzmaWithoutChecksums) {
+    bxz::params prm;
+    prm.verify_checksums = false;
+    this->run_test(prm);
+}
+
 #endif
 
 #if defined(BXZSTR_ZSTD_SUPPORT) && (BXZSTR_ZSTD_SUPPORT) == 1
@@ -37,4 +115,113 @@ TEST_F(ZstdDecompressionTest, BxzIfstreamDecompressesZstd) {
     this->run_test();
 }
 
+TEST_F(ZstdDecompressionTest, BxzIfstreamDecompressesZstdWithoutChecksums) {
+    bxz::params prm;
+    prm.verify_checksums = false;
+    this->run_test(prm);
+}
+
+#endif
+
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+// Test BGZF Decompression
+TEST_F(BgzfDecompressionTest, BxzIfstreamDecompressesBgzf) {
+    this->run_test();
+}
+
+TEST_F(BgzfDecompressionTest, BxzIfstreamDecompressesBgzfWithoutChecksums) {
+    bxz::params prm;
+    prm.verify_checksums = false;
+    this->run_test(prm);
+}
+
+TEST_F(BgzfDecompressionTest, BgzfIfstreamDecompressesBgzf) {
+    bxz::bgzf_ifstream in(this->test_infile);
+    std::string line;
+    uint32_t n_lines = 0;
+    while (std::getline(in, line)) {
+	EXPECT_EQ(line, "1");
+	++n_lines;
+    }
+    EXPECT_EQ(n_lines, 10);
+}
+
+TEST_F(BgzfCorruptChecksumTest, BxzIfstreamThrowsOnCorruptChecksum) {
+    EXPECT_ANY_THROW(this->run_test());
+}
+
+TEST_F(BgzfCorruptChecksumTest, BxzIfstreamIgnoresCorruptChecksum) {
+    bxz::params prm;
+    prm.verify_checksums = false;
+    this->run_test(prm);
+}
+
+TEST_F(BgzfNoEofBlockTest, BxzIstreambufDrainsLastBlock) {
+    // what does not fit in the output buffer stays in the codec
+    std::string expected;
+    for (uint32_t i = 0; i < this->n_in_vals; ++i) expected += (i + 1 < this->n_in_vals ? "1\n" : "1");
+    for (std::size_t size = 8; size <= 32; ++size) EXPECT_EQ(this->read_with_buffer(size), expected);
+}
+
+TEST_F(BgzfMixedMemberTest, BxzIfstreamDecompressesPlainGzipMember) {
+    this->run_mixed_test(bxz::params());
+}
+
+TEST_F(BgzfMixedMemberTest, BxzIfstreamDecompressesPlainGzipMemberWithoutChecksums) {
+    bxz::params prm;
+    prm.verify_checksums = false;
+    this->run_mixed_test(prm);
+}
+
+#endif
+
+#if defined(BXZSTR_LZ4_SUPPORT) && (BXZSTR_LZ4_SUPPORT) == 1
+// Test Lz4 Decompression
+TEST_F(Lz4DecompressionTest, BxzIfstreamDecompressesLz4) {
+    this->run_test();
+}
+
+TEST_F(Lz4DecompressionTest, BxzIfstreamDecompressesLz4WithoutChecksums) {
+    bxz::params prm;
+    prm.verify_checksums = false;
+    this->run_test(prm);
+}
+
+TEST_F(Lz4DecompressionTest, Lz4IfstreamDecompressesLz4) {
+    bxz::lz4_ifstream in(this->test_infile);
+    std::string line;
+    uint32_t n_lines = 0;
+    while (std::getline(in, line)) {
+	EXPECT_EQ(line, "1");
+	++n_lines;
+    }
+    EXPECT_EQ(n_lines, 10);
+}
+
+#endif
+
+#if defined(BXZSTR_BROTLI_SUPPORT) && (BXZSTR_BROTLI_SUPPORT) == 1
+// Test Brotli Decompression
+TEST_F(BrotliDecompressionTest, BxzIfstreamDecompressesBrotli) {
+    this->run_test();
+}
+
+TEST_F(BrotliDecompressionTest, BxzIfstreamDecompressesBrotliWithExplicitType) {
+    // copy the data to a file without the .br extension
+    const std::string renamed = "BrotliDecompressionTest_fake_data.bin";
+    {
+	std::ifstream src(this->test_infile, std::ios_base::binary);
+	std::ofstream dst(renamed, std::ios_base::binary);
+	dst << src.rdbuf();
+    }
+    bxz::ifstream in(renamed, std::ios_base::in, bxz::brotli);
+    std::string line;
+    uint32_t n_lines = 0;
+    while (std::getline(in, line)) {
+	EXPECT_EQ(line, "1");
+	++n_lines;
+    }
+    EXPECT_EQ(n_lines, 10);
+}
+
 #endif
@@ -7,12 +7,78 @@ g * License, v. 2.0. If a copy of the MPL was not distributed with this
 
 #include "bxzstr_ofstream_integrationtest.hpp"
 
+#include <iterator>
+
 #if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
 // Test Z Compression
 TEST_F(ZCompressionTest, BxzOfstreamCompressesZ) {
     this->run_test();
 }
 
+TEST_F(ZFlushModeTest, SyncFlushRoundTrips) {
+    this->write_records(bxz::z, bxz::sync_flush);
+    this->check_records();
+}
+
+TEST_F(ZFlushModeTest, LowLatencyRoundTrips) {
+    this->write_records(bxz::z, bxz::low_latency);
+    this->check_records();
+}
+
+TEST_F(ZFlushModeTest, WriteAfterCloseRoundTrips) {
+    std::stringbuf out;
+    {
+	bxz::ostreambuf obuf(&out, bxz::z, 6);
+	std::ostream os(&obuf);
+	os << "first";
+	EXPECT_EQ(obuf.close(), 0);
+	os << "second";
+    }
+    std::stringbuf in(out.str());
+    bxz::istreambuf ibuf(&in);
+    EXPECT_EQ(std::string(std::istreambuf_iterator<char>(&ibuf), std::istreambuf_iterator<char>()), "firstsecond");
+}
+
+TEST_F(ZFlushModeTest, SyncFlushIsSmallerThanFinishOnSync) {
+    const size_t finished = this->write_records(bxz::z, bxz::finish_on_sync);
+    const size_t flushed = this->write_records(bxz::z, bxz::sync_flush);
+    EXPECT_LT(flushed, finished);
+}
+
+TEST_F(ZParamsTest, ParamsRoundTrip) {
+    bxz::params prm(9);
+    prm.z_mem_level = 9;
+    prm.z_strategy = Z_FILTERED;
+    this->write_records(bxz::z, prm);
+    this->check_records();
+}
+
+TEST_F(ZParamsTest, OpenKeepsTypeAndParams) {
+    bxz::params prm(9);
+    prm.collect_stats = true;
+    {
+	bxz::ofstream out(this->test_outfile, bxz::bgzf, prm);
+	out.open(this->test_outfile);
+	for (uint32_t i = 0; i < this->n_records; ++i) out << "record " << i << '\n';
+	out.flush();
+	EXPECT_GT(out.stats().uncompressed_bytes, 0);
+    }
+    EXPECT_EQ(bxz::stat(this->test_outfile).type, bxz::bgzf);
+    this->check_records();
+}
+
+TEST_F(ZTypedStreamTest, TypedStreamsRoundTrip) {
+    this->write_typed_records<bxz::z_ofstream>(bxz::params(6, bxz::sync_flush));
+    this->check_records<bxz::z_ifstream>();
+    this->check_records();
+}
+
+TEST_F(ZTypedStreamTest, TypedStreamMatchesRuntimeStream) {
+    const size_t runtime = this->write_records(bxz::z, bxz::params(6));
+    const size_t typed = this->write_typed_records<bxz::z_ofstream>(bxz::params(6));
+    EXPECT_EQ(typed, runtime);
+}
+
 #endif
 
 #if defined(BXZSTR_BZ2_SUPPORT) && (BXZSTR_BZ2_SUPPORT) == 1
@@ -21,6 +87,11 @@ TEST_F(BzCompressionTest, BxzIfstreamCompressesBz) {
     this->run_test();
 }
 
+TEST_F(BzFlushModeTest, SyncFlushRoundTrips) {
+    this->write_records(bxz::bz2, bxz::sync_flush);
+    this->check_records();
+}
+
 #endif
 
 #if defined(BXZSTR_LZMA_SUPPORT) && (BXZSTR_LZMA_SUPPORT) == 1
@@ -29,6 +100,11 @@ TEST_F(LzmaCompressionTest, BxzIfstreamCompressesLzma) {
     this->run_test();
 }
 
+TEST_F(LzmaFlushModeTest, SyncFlushRoundTrips) {
+    this->write_records(bxz::lzma, bxz::sync_flush);
+    this->check_records();
+}
+
 #endif
 
 #if defined(BXZSTR_ZSTD_SUPPORT) && (BXZSTR_ZSTD_SUPPORT) == 1
@@ -37,4 +113,176 @@ TEST_F(ZstdCompressionTest, BxzIfstreamCompressesZstd) {
     this->run_test();
 }
 
+TEST_F(ZstdFlushModeTest, SyncFlushRoundTrips) {
+    this->write_records(bxz::zstd, bxz::sync_flush);
+    this->check_records();
+}
+
+TEST_F(ZstdFlushModeTest, LowLatencyRoundTrips) {
+    this->write_records(bxz::zstd, bxz::low_latency);
+    this->check_records();
+}
+
+TEST_F(ZstdFlushModeTest, SyncFlushIsSmallerThanFinishOnSync) {
+    const size_t finished = this->write_records(bxz::zstd, bxz::finish_on_sync);
+    const size_t flushed = this->write_records(bxz::zstd, bxz::sync_flush);
+    EXPECT_LT(flushed, finished);
+}
+
+TEST_F(ZstdParamsTest, ChecksumRoundTrip) {
+    bxz::params prm;
+    prm.checksum = bxz::checksum_on;
+    this->write_records(bxz::zstd, prm);
+    this->check_records();
+}
+
+TEST_F(ZstdTypedStreamTest, TypedStreamsRoundTrip) {
+    this->write_typed_records<bxz::zstd_ofstream>(bxz::params(3, bxz::sync_flush));
+    this->check_records<bxz::zstd_ifstream>();
+    this->check_records();
+}
+
+TEST_F(ZstdTypedStreamTest, TypedStreamMatchesRuntimeStream) {
+    const size_t runtime = this->write_records(bxz::zstd, bxz::params(3));
+    const size_t typed = this->write_typed_records<bxz::zstd_ofstream>(bxz::params(3));
+    EXPECT_EQ(typed, runtime);
+}
+
+TEST_F(ZstdParamsTest, ParamsRoundTrip) {
+    bxz::params prm(19);
+    prm.zstd_window_log = 24;
+    prm.zstd_long_distance_matching = true;
+    this->write_records(bxz::zstd, prm);
+    this->check_records();
+}
+
 #endif
+
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+// Test BGZF Compression
+TEST_F(BgzfCompressionTest, BxzIfstreamCompressesBgzf) {
+    this->run_test();
+}
+
+TEST_F(BgzfFlushModeTest, FinishOnSyncRoundTrips) {
+    this->write_records(bxz::bgzf, bxz::finish_on_sync);
+    this->check_records();
+}
+
+TEST_F(BgzfFlushModeTest, SyncFlushRoundTrips) {
+    this->write_records(bxz::bgzf, bxz::sync_flush);
+    this->check_records();
+}
+
+TEST_F(BgzfFlushModeTest, SyncFlushIsSmallerThanFinishOnSync) {
+    const size_t finished = this->write_records(bxz::bgzf, bxz::finish_on_sync);
+    const size_t flushed = this->write_records(bxz::bgzf, bxz::sync_flush);
+    EXPECT_LT(flushed, finished);
+}
+
+TEST_F(BgzfParamsTest, MultipleBlocksRoundTrip) {
+    this->write_records(bxz::bgzf, bxz::params(9));
+    this->check_records();
+}
+
+TEST_F(BgzfParamsTest, MultipleBlocksReadAsGzip) {
+    this->write_records(bxz::bgzf, bxz::params(1));
+    this->check_records<bxz::z_ifstream>();
+}
+
+TEST_F(BgzfParamsTest, TypedStreamsRoundTrip) {
+    this->write_typed_records<bxz::bgzf_ofstream>(bxz::params(6));
+    this->check_records<bxz::bgzf_ifstream>();
+}
+
+#endif
+
+#if defined(BXZSTR_LZ4_SUPPORT) && (BXZSTR_LZ4_SUPPORT) == 1
+// Test Lz4 Compression
+TEST_F(Lz4CompressionTest, BxzIfstreamCompressesLz4) {
+    this->run_test();
+}
+
+TEST_F(Lz4FlushModeTest, FinishOnSyncRoundTrips) {
+    this->write_records(bxz::lz4, bxz::finish_on_sync);
+    this->check_records();
+}
+
+TEST_F(Lz4FlushModeTest, SyncFlushRoundTrips) {
+    this->write_records(bxz::lz4, bxz::sync_flush);
+    this->check_records();
+}
+
+TEST_F(Lz4FlushModeTest, SyncFlushIsSmallerThanFinishOnSync) {
+    const size_t finished = this->write_records(bxz::lz4, bxz::finish_on_sync);
+    const size_t flushed = this->write_records(bxz::lz4, bxz::sync_flush);
+    EXPECT_LT(flushed, finished);
+}
+
+TEST_F(Lz4ParamsTest, HighCompressionRoundTrip) {
+    bxz::params prm(12, bxz::sync_flush);
+    prm.lz4_block_size_id = 7;
+    prm.checksum = bxz::checksum_on;
+    this->write_records(bxz::lz4, prm);
+    this->check_records();
+}
+
+TEST_F(Lz4ParamsTest, IndependentBlocksRoundTrip) {
+    bxz::params prm(1, bxz::sync_flush);
+    prm.lz4_block_independent = true;
+    this->write_records(bxz::lz4, prm);
+    this->check_records();
+}
+
+TEST_F(Lz4ParamsTest, ContentSizeRoundTrip) {
+    bxz::params prm(0, bxz::sync_flush);
+    prm.lz4_content_size = this->records_size();
+    this->write_records(bxz::lz4, prm);
+    this->check_records();
+}
+
+TEST_F(Lz4ParamsTest, TypedStreamsRoundTrip) {
+    this->write_typed_records<bxz::lz4_ofstream>(bxz::params(0, bxz::sync_flush));
+    this->check_records<bxz::lz4_ifstream>();
+}
+
+#endif
+
+#if defined(BXZSTR_BROTLI_SUPPORT) && (BXZSTR_BROTLI_SUPPORT) == 1
+// Test Brotli Compression
+TEST_F(BrotliCompressionTest, BxzIfstreamCompressesBrotli) {
+    this->run_test();
+}
+
+TEST_F(BrotliFlushModeTest, FinishOnSyncRoundTrips) {
+    this->write_records(bxz::brotli, bxz::finish_on_sync);
+    this->check_records();
+}
+
+TEST_F(BrotliFlushModeTest, SyncFlushRoundTrips) {
+    this->write_records(bxz::brotli, bxz::sync_flush);
+    this->check_records();
+}
+
+TEST_F(BrotliFlushModeTest, SyncFlushIsSmallerThanFinishOnSync) {
+    const size_t finished = this->write_records(bxz::brotli, bxz::finish_on_sync);
+    const size_t flushed = this->write_records(bxz::brotli, bxz::sync_flush);
+    EXPECT_LT(flushed, finished);
+}
+
+TEST_F(BrotliParamsTest, ParamsRoundTrip) {
+    bxz::params prm(11);
+    prm.brotli_window_log = 16;
+    prm.brotli_mode = BROTLI_MODE_TEXT;
+    this->write_records(bxz::brotli, prm);
+    this->check_records();
+}
+
+TEST_F(BrotliParamsTest, TypedStreamsRoundTrip) {
+    this->write_typed_records<bxz::brotli_ofstream>(bxz::params(5, bxz::sync_flush));
+    this->check_records<bxz::brotli_ifstream>();
+}
+
+#endif
+
+
@@ -33,6 +33,26 @@ TEST_F(BzStreamWrapperTest, ConstructorDoesNotThrowOnOutput) {
     EXPECT_NO_THROW(bxz::detail::bz_stream_wrapper wrapper(testFalse));
 }
 
+TEST_F(BzStreamWrapperTest, ParamsConstructorDoesNotThrowOnInput) {
+    bxz::params p(9);
+    p.bz2_work_factor = 100;
+    p.bz2_small = true;
+    EXPECT_NO_THROW(bxz::detail::bz_stream_wrapper wrapper(testTrue, p));
+}
+
+TEST_F(BzStreamWrapperTest, ParamsConstructorDoesNotThrowOnOutput) {
+    bxz::params p(9);
+    p.bz2_work_factor = 100;
+    p.bz2_small = true;
+    EXPECT_NO_THROW(bxz::detail::bz_stream_wrapper wrapper(testFalse, p));
+}
+
+TEST_F(BzStreamWrapperTest, ParamsConstructorThrowsOnInvalidParams) {
+    bxz::params p;
+    p.bz2_work_factor = 1000;
+    EXPECT_THROW(bxz::detail::bz_stream_wrapper wrapper(testFalse, p), bxz::bzException);
+}
+
 TEST_F(BzDecompressTest, DecompressDoesNotThrowOnValidInput) {
     EXPECT_NO_THROW(wrapper->decompress());
 }
@@ -50,6 +70,14 @@ TEST_F(BzDecompressTest, DecompressUpdatesStreamState) {
     EXPECT_EQ(wrapper->avail_out(), 10);
 }
 
+TEST_F(BzDecompressTest, DecompressDoesNotThrowWithoutInput) {
+    wrapper->decompress();
+    EXPECT_NO_THROW(wrapper->decompress());
+    EXPECT_NO_THROW(wrapper->decompress());
+    EXPECT_EQ(wrapper->avail_out(), 10);
+    EXPECT_FALSE(wrapper->stream_end());
+}
+
 TEST_F(BzCompressTest, CompressEndsStream) {
     wrapper->set_avail_out(0);
     wrapper->set_next_out(&testOut[10]);
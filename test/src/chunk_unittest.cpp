@@ -0,0 +1,89 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "chunk_unittest.hpp"
+
+#include <cstdio>
+#include <sstream>
+#include <istream>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+TEST_F(ChunkTest, ChunksHoldTheData) {
+    for (const bxz::Compression type : this->types()) {
+	std::stringbuf in(bxz::compress(type, this->data));
+	bxz::istreambuf ibuf(&in, type, 1 << 16);
+	std::string out;
+	std::size_t n_chunks = 0;
+	for (bxz::chunk c = ibuf.next_chunk(); !c.empty(); c = ibuf.next_chunk()) {
+	    EXPECT_LE(c.size, (std::size_t)1 << 16) << type;
+	    out.append(c.data, c.size);
+	    ++n_chunks;
+	}
+	EXPECT_TRUE(out == this->data) << type;
+	EXPECT_GT(n_chunks, 1u) << type;
+	EXPECT_TRUE(ibuf.next_chunk().empty()) << type;
+    }
+}
+
+TEST_F(ChunkTest, RangeForLoop) {
+    for (const bxz::Compression type : this->types()) {
+	std::stringbuf in(bxz::compress(type, this->data));
+	bxz::istreambuf ibuf(&in, type);
+	std::string out;
+	for (const bxz::chunk &c : bxz::chunks(ibuf)) out.append(c.begin(), c.end());
+	EXPECT_TRUE(out == this->data) << type;
+    }
+}
+
+TEST_F(ChunkTest, MixesWithStreamReads) {
+    for (const bxz::Compression type : this->types()) {
+	std::stringbuf in(bxz::compress(type, this->data));
+	bxz::istreambuf ibuf(&in, type);
+	std::istream is(&ibuf);
+	std::string line;
+	std::getline(is, line);
+	EXPECT_EQ(line, "line 0") << type;
+	// the chunk starts where the stream stopped
+	const bxz::chunk c = ibuf.next_chunk();
+	ASSERT_FALSE(c.empty()) << type;
+	EXPECT_EQ(c.str(), this->data.substr(7, c.size)) << type;
+	// and the stream continues after the chunk
+	std::getline(is, line);
+	EXPECT_EQ(line + "\n", this->data.substr(7 + c.size, line.size() + 1)) << type;
+    }
+}
+
+TEST_F(ChunkTest, EmptyInput) {
+    std::stringbuf in;
+    bxz::istreambuf ibuf(&in);
+    EXPECT_TRUE(ibuf.next_chunk().empty());
+    EXPECT_TRUE(bxz::chunks(ibuf).begin() == bxz::chunks(ibuf).end());
+}
+
+TEST_F(ChunkTest, Ifstream) {
+    {
+	bxz::ofstream out(this->path, bxz::z);
+	out << this->data;
+    }
+    bxz::ifstream in(this->path);
+    std::string out;
+    for (const bxz::chunk &c : bxz::chunks(in)) out.append(c.data, c.size);
+    EXPECT_TRUE(out == this->data);
+    std::remove(this->path.c_str());
+}
+
+#if __cplusplus >= 201703L
+TEST_F(ChunkTest, StringView) {
+    std::stringbuf in(bxz::compress(bxz::z, this->data));
+    bxz::istreambuf ibuf(&in);
+    const std::string_view view = ibuf.next_chunk();
+    EXPECT_EQ(view, std::string_view(this->data).substr(0, view.size()));
+}
+#endif
@@ -28,6 +28,41 @@ TEST(BxzFinishTest, BxzFinishReturnsZFinish) {
     EXPECT_EQ(got, Z_FINISH);
 }
 
+TEST(BxzFlushTest, BxzFlushReturnsZSyncFlush) {
+    const int got = bxz_flush(bxz::z);
+    EXPECT_EQ(got, Z_SYNC_FLUSH);
+}
+
+// bxz::bgzf test
+TEST_F(DetectBgzfTest, BgzfHeaderReturnsBgzf) {
+    for (size_t i = 0; i < this->test_headers.size(); ++i) {
+	const bxz::Compression &got = bxz::detect_type(reinterpret_cast<char*>(&this->test_headers[i][0]), reinterpret_cast<char*>(&this->test_headers[i][this->test_headers[i].size()]));
+	EXPECT_EQ(got, expected);
+    }
+}
+
+TEST_F(DetectBgzfTest, OtherGzipHeadersReturnZ) {
+    for (size_t i = 0; i < this->gzip_headers.size(); ++i) {
+	const bxz::Compression &got = bxz::detect_type(reinterpret_cast<char*>(&this->gzip_headers[i][0]), reinterpret_cast<char*>(&this->gzip_headers[i][this->gzip_headers[i].size()]));
+	EXPECT_EQ(got, bxz::z);
+    }
+}
+
+TEST(BxzRunTest, BxzRunReturnsBgzfNoFlush) {
+    const int got = bxz_run(bxz::bgzf);
+    EXPECT_EQ(got, Z_NO_FLUSH);
+}
+
+TEST(BxzFinishTest, BxzFinishReturnsBgzfFinish) {
+    const int got = bxz_finish(bxz::bgzf);
+    EXPECT_EQ(got, Z_FINISH);
+}
+
+TEST(BxzFlushTest, BxzFlushReturnsBgzfSyncFlush) {
+    const int got = bxz_flush(bxz::bgzf);
+    EXPECT_EQ(got, Z_SYNC_FLUSH);
+}
+
 #endif
 
 #if defined(BXZSTR_BZ2_SUPPORT) && (BXZSTR_BZ2_SUPPORT) == 1
@@ -49,6 +84,11 @@ TEST(BxzFinishTest, BxzFinishReturnsBzFinish) {
     EXPECT_EQ(got, BZ_FINISH);
 }
 
+TEST(BxzFlushTest, BxzFlushReturnsBzFlush) {
+    const int got = bxz_flush(bxz::bz2);
+    EXPECT_EQ(got, BZ_FLUSH);
+}
+
 #endif
 
 #if defined(BXZSTR_LZMA_SUPPORT) && (BXZSTR_LZMA_SUPPORT) == 1
@@ -70,6 +110,11 @@ TEST(BxzFinishTest, BxzFinishReturnsLzmaFinish) {
     EXPECT_EQ(got, LZMA_FINISH);
 }
 
+TEST(BxzFlushTest, BxzFlushReturnsLzmaSyncFlush) {
+    const int got = bxz_flush(bxz::lzma);
+    EXPECT_EQ(got, LZMA_SYNC_FLUSH);
+}
+
 #endif
 
 #if defined(BXZSTR_ZSTD_SUPPORT) && (BXZSTR_ZSTD_SUPPORT) == 1
@@ -91,5 +136,65 @@ TEST(BxzFinishTest, BxzFinishReturnsZstdEndStream) {
     EXPECT_EQ(got, 1);
 }
 
+TEST(BxzFlushTest, BxzFlushReturnsZstdFlush) {
+    const int got = bxz_flush(bxz::zstd);
+    EXPECT_EQ(got, 2);
+}
+
+#endif
+
+#if defined(BXZSTR_LZ4_SUPPORT) && (BXZSTR_LZ4_SUPPORT) == 1
+// bxz::lz4 test
+TEST_F(DetectLz4Test, Lz4HeaderReturnsLz4) {
+    for (size_t i = 0; i < this->test_headers.size(); ++i) {
+	const bxz::Compression &got = bxz::detect_type(reinterpret_cast<char*>(&this->test_headers[i][0]), reinterpret_cast<char*>(&this->test_headers[i][this->test_headers[i].size()]));
+	EXPECT_EQ(got, expected);
+    }
+}
+
+TEST(BxzRunTest, BxzRunReturnsLz4Update) {
+    const int got = bxz_run(bxz::lz4);
+    EXPECT_EQ(got, 0);
+}
+
+TEST(BxzFinishTest, BxzFinishReturnsLz4End) {
+    const int got = bxz_finish(bxz::lz4);
+    EXPECT_EQ(got, 1);
+}
+
+TEST(BxzFlushTest, BxzFlushReturnsLz4Flush) {
+    const int got = bxz_flush(bxz::lz4);
+    EXPECT_EQ(got, 2);
+}
+
+#endif
+
+#if defined(BXZSTR_BROTLI_SUPPORT) && (BXZSTR_BROTLI_SUPPORT) == 1
+// bxz::brotli test
+TEST(DetectTypeFromExtensionTest, BrExtensionReturnsBrotli) {
+    EXPECT_EQ(bxz::detect_type_from_extension("file.txt.br"), bxz::brotli);
+}
+
+TEST(DetectTypeFromExtensionTest, OtherExtensionReturnsNone) {
+    EXPECT_EQ(bxz::detect_type_from_extension("file.txt.gz"), bxz::none);
+    EXPECT_EQ(bxz::detect_type_from_extension("file.brx"), bxz::none);
+    EXPECT_EQ(bxz::detect_type_from_extension(".br"), bxz::none);
+}
+
+TEST(BxzRunTest, BxzRunReturnsBrotliProcess) {
+    const int got = bxz_run(bxz::brotli);
+    EXPECT_EQ(got, BROTLI_OPERATION_PROCESS);
+}
+
+TEST(BxzFinishTest, BxzFinishReturnsBrotliFinish) {
+    const int got = bxz_finish(bxz::brotli);
+    EXPECT_EQ(got, BROTLI_OPERATION_FINISH);
+}
+
+TEST(BxzFlushTest, BxzFlushReturnsBrotliFlush) {
+    const int got = bxz_flush(bxz::brotli);
+    EXPECT_EQ(got, BROTLI_OPERATION_FLUSH);
+}
+
 #endif
 
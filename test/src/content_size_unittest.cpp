@@ -0,0 +1,129 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "content_size_unittest.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+TEST_F(ContentSizeTest, GzipSizeIsFromTheTrailer) {
+    std::stringbuf in(this->compress(bxz::z, bxz::params()));
+    const bxz::content_info info = bxz::stat(&in);
+    EXPECT_EQ(info.type, bxz::z);
+    EXPECT_EQ(info.compressed_size, in.str().size());
+    EXPECT_TRUE(info.size_known);
+    EXPECT_FALSE(info.size_exact);
+    EXPECT_EQ(info.content_size, this->data.size());
+}
+
+TEST_F(ContentSizeTest, GzipCannotSeekFromTheEnd) {
+    std::stringbuf in(this->compress(bxz::z, bxz::params()));
+    bxz::istreambuf ibuf(&in);
+    EXPECT_EQ(ibuf.content_size(), -1);
+    EXPECT_THROW(ibuf.pubseekoff(-10, std::ios_base::end), std::runtime_error);
+}
+
+TEST_F(ContentSizeTest, BgzfSizeIsExact) {
+    std::stringbuf in(this->compress(bxz::bgzf, bxz::params()));
+    const bxz::content_info info = bxz::stat(&in);
+    EXPECT_EQ(info.type, bxz::bgzf);
+    EXPECT_TRUE(info.size_exact);
+    EXPECT_EQ(info.content_size, this->data.size());
+}
+
+TEST_F(ContentSizeTest, SeekFromTheEnd) {
+    std::stringbuf in(this->compress(bxz::bgzf, bxz::params()));
+    bxz::istreambuf ibuf(&in);
+    EXPECT_EQ(ibuf.content_size(), (std::streamoff)this->data.size());
+    std::istream is(&ibuf);
+    is.seekg(-20, std::ios_base::end);
+    std::string tail(20, '\0');
+    is.read(&tail[0], 20);
+    EXPECT_EQ(tail, this->data.substr(this->data.size() - 20));
+    EXPECT_EQ(ibuf.pubseekoff(1, std::ios_base::end), std::streampos(std::streamoff(-1)));
+}
+
+TEST_F(ContentSizeTest, UnseekableStream) {
+    UnseekableBuf in(this->compress(bxz::bgzf, bxz::params()));
+    EXPECT_THROW(bxz::stat(&in), std::runtime_error);
+    bxz::istreambuf ibuf(&in);
+    EXPECT_EQ(ibuf.content_size(), -1);
+}
+#endif
+
+#if defined(BXZSTR_LZMA_SUPPORT) && (BXZSTR_LZMA_SUPPORT) == 1
+TEST_F(ContentSizeTest, XzSizeIsFromTheIndexes) {
+    std::stringbuf in(this->compress(bxz::lzma, bxz::params(), true));
+    const bxz::content_info info = bxz::stat(&in);
+    EXPECT_EQ(info.type, bxz::lzma);
+    EXPECT_TRUE(info.size_exact);
+    EXPECT_EQ(info.content_size, this->data.size());
+}
+#endif
+
+#if defined(BXZSTR_ZSTD_SUPPORT) && (BXZSTR_ZSTD_SUPPORT) == 1
+TEST_F(ContentSizeTest, ZstdSizeIsUnknownUnlessPledged) {
+    std::stringbuf in(this->compress(bxz::zstd, bxz::params()));
+    EXPECT_FALSE(bxz::stat(&in).size_known);
+    bxz::params prm;
+    prm.zstd_pledged_size = this->data.size();
+    std::stringbuf pledged(this->compress(bxz::zstd, prm));
+    const bxz::content_info info = bxz::stat(&pledged);
+    EXPECT_EQ(info.type, bxz::zstd);
+    EXPECT_TRUE(info.size_exact);
+    EXPECT_EQ(info.content_size, this->data.size());
+}
+
+TEST_F(ContentSizeTest, ZstdSizeIsSummedOverFrames) {
+    bxz::params prm;
+    prm.zstd_pledged_size = this->data.size();
+    std::string compressed;
+    for (int i = 0; i < 3; ++i) compressed += this->compress(bxz::zstd, prm);
+    std::stringbuf in(compressed);
+    EXPECT_EQ(bxz::stat(&in).content_size, 3*this->data.size());
+}
+
+TEST_F(ContentSizeTest, ZstdSeekTable) {
+    // two frames without sizes in the headers, followed by a seek table
+    std::string compressed = this->compress(bxz::zstd, bxz::params());
+    const uint32_t first_size = (uint32_t)compressed.size();
+    compressed += this->compress(bxz::zstd, bxz::params());
+    std::string table;
+    put_le32(&table, 0x184D2A5E);
+    put_le32(&table, 2*8 + 9);
+    for (int i = 0; i < 2; ++i) {
+	put_le32(&table, i == 0 ? first_size : (uint32_t)compressed.size() - first_size);
+	put_le32(&table, (uint32_t)this->data.size());
+    }
+    put_le32(&table, 2);
+    table.push_back('\0');
+    put_le32(&table, 0x8F92EAB1);
+    std::stringbuf in(compressed + table);
+    const bxz::content_info info = bxz::stat(&in);
+    EXPECT_TRUE(info.size_exact);
+    EXPECT_EQ(info.content_size, 2*this->data.size());
+    bxz::istreambuf ibuf(&in);
+    const std::string decompressed((std::istreambuf_iterator<char>(&ibuf)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(decompressed, this->data + this->data);
+}
+#endif
+
+TEST_F(ContentSizeTest, StatPlainFile) {
+    const std::string path = "content_size_test.txt";
+    {
+	std::ofstream out(path, std::ios_base::binary);
+	out << this->data;
+    }
+    const bxz::content_info info = bxz::stat(path);
+    std::remove(path.c_str());
+    EXPECT_EQ(info.type, bxz::plaintext);
+    EXPECT_TRUE(info.size_exact);
+    EXPECT_EQ(info.content_size, this->data.size());
+    EXPECT_THROW(bxz::stat(path), std::runtime_error);
+}
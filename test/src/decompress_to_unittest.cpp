@@ -0,0 +1,53 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "decompress_to_unittest.hpp"
+
+TEST_P(DecompressToTest, PlaintextIsCopied) {
+    EXPECT_EQ(this->expected, this->decompress(this->expected));
+}
+
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+TEST_P(DecompressToTest, GzipRoundTrip) {
+    EXPECT_EQ(this->expected, this->decompress(this->compress(bxz::z)));
+}
+
+TEST_P(DecompressToTest, ConcatenatedGzipMembers) {
+    const std::string compressed = this->compress(bxz::z);
+    EXPECT_EQ(this->expected + this->expected, this->decompress(compressed + compressed));
+}
+
+TEST_P(DecompressToTest, GzipHeaderFields) {
+    // gzip -c of "1\n" with FNAME "a"
+    const unsigned char test_vals[] = { 0x1f, 0x8b, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x61, 0x00, 0x33, 0xe4, 0x02, 0x00,
+					0x53, 0xfc, 0x51, 0x67, 0x02, 0x00, 0x00, 0x00 };
+    EXPECT_EQ("1\n", this->decompress(std::string(reinterpret_cast<const char*>(test_vals), sizeof(test_vals))));
+}
+
+TEST_P(DecompressToTest, CorruptChecksumThrows) {
+    std::string compressed = this->compress(bxz::z);
+    compressed[compressed.size() - 8] ^= 0xFF;
+    EXPECT_ANY_THROW(this->decompress(compressed));
+    this->prm.verify_checksums = false;
+    EXPECT_EQ(this->expected, this->decompress(compressed));
+}
+
+TEST_P(DecompressToTest, TruncatedGzipThrowsWithInflateBack) {
+    // istreambuf stops quietly at the end of the input
+    if (!GetParam()) return;
+    const std::string compressed = this->compress(bxz::z);
+    EXPECT_ANY_THROW(this->decompress(compressed.substr(0, compressed.size()/2)));
+}
+#endif
+
+#if defined(BXZSTR_BZ2_SUPPORT) && (BXZSTR_BZ2_SUPPORT) == 1
+TEST_P(DecompressToTest, OtherFormatsUseTheStreams) {
+    EXPECT_EQ(this->expected, this->decompress(this->compress(bxz::bz2)));
+}
+#endif
+
+INSTANTIATE_TEST_SUITE_P(InflateBack, DecompressToTest, ::testing::Bool());
@@ -0,0 +1,102 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "executor_unittest.hpp"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_F(ExecutorTest, RunsAllTasks) {
+    EXPECT_EQ(this->pool->concurrency(), 4u);
+    std::atomic<unsigned> sum(0);
+    for (unsigned i = 0; i < 1000; ++i) this->pool->submit([this, &sum, i]() { sum += i; this->task_done(); });
+    this->wait_for(1000);
+    EXPECT_EQ(sum, 999u*1000u/2);
+}
+
+TEST_F(ExecutorTest, RunsTasksSubmittedByTasks) {
+    for (unsigned i = 0; i < 10; ++i) {
+	this->pool->submit([this]() {
+	    for (unsigned j = 0; j < 10; ++j) this->pool->submit([this]() { this->task_done(); });
+	    this->task_done();
+	});
+    }
+    this->wait_for(110);
+    EXPECT_EQ(this->done, 110u);
+}
+
+TEST_F(ExecutorTest, DestructorRunsQueuedTasks) {
+    std::atomic<unsigned> count(0);
+    {
+	bxz::thread_pool_executor local(2);
+	for (unsigned i = 0; i < 100; ++i) local.submit([&count]() { ++count; });
+    }
+    EXPECT_EQ(count, 100u);
+}
+
+TEST_F(ExecutorTest, ParallelForRunsEachItemOnce) {
+    std::vector<std::atomic<unsigned>> calls(500);
+    for (std::atomic<unsigned> &n : calls) n = 0;
+    bxz::detail::parallel_for(this->pool, calls.size(), 0, [&calls](const std::size_t i) { ++calls[i]; });
+    for (const std::atomic<unsigned> &n : calls) EXPECT_EQ(n, 1u);
+    bxz::detail::parallel_for(this->pool, 0, 0, [](const std::size_t) { FAIL(); });
+}
+
+TEST_F(ExecutorTest, ParallelForRespectsTheCap) {
+    for (const unsigned cap : { 1u, 2u, 3u }) {
+	std::atomic<unsigned> active(0);
+	std::atomic<unsigned> peak(0);
+	bxz::detail::parallel_for(this->pool, 40, cap, [&active, &peak](const std::size_t) {
+	    const unsigned now = ++active;
+	    unsigned seen = peak;
+	    while (now > seen && !peak.compare_exchange_weak(seen, now)) {}
+	    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	    --active;
+	});
+	EXPECT_LE(peak, cap);
+    }
+}
+
+TEST_F(ExecutorTest, NestedParallelForFinishesOnBusyPool) {
+    std::shared_ptr<bxz::executor> single = std::make_shared<bxz::thread_pool_executor>(1);
+    std::atomic<unsigned> count(0);
+    // the outer items occupy the only worker while they wait for the
+    // inner loops, which the calling threads run themselves
+    bxz::detail::parallel_for(single, 4, 2, [&single, &count](const std::size_t) {
+	bxz::detail::parallel_for(single, 10, 2, [&count](const std::size_t) { ++count; });
+    });
+    EXPECT_EQ(count, 40u);
+}
+
+TEST_F(ExecutorTest, BatchUsesTheInjectedExecutor) {
+    std::shared_ptr<CountingExecutor> counting = std::make_shared<CountingExecutor>(this->pool);
+    std::vector<std::string> pages(16, std::string(20000, 'a'));
+    std::vector<std::string> out(pages.size(), std::string(bxz::compress_bound(bxz::plaintext, 20000), '\0'));
+    std::vector<bxz::batch_input> inputs;
+    std::vector<bxz::batch_output> outputs;
+    for (std::size_t i = 0; i < pages.size(); ++i) {
+	inputs.emplace_back(pages[i].data(), pages[i].size());
+	outputs.emplace_back(&out[i][0], out[i].size());
+    }
+    bxz::params prm;
+    prm.executor_p = counting;
+    prm.max_threads = 3;
+    for (const bxz::batch_result &result : bxz::compress_batch(bxz::plaintext, inputs, outputs, prm))
+	EXPECT_TRUE(result.ok());
+    EXPECT_EQ(counting->submitted, 2u);
+    EXPECT_TRUE(out == pages);
+
+    // as the default executor
+    bxz::set_default_executor(counting);
+    EXPECT_EQ(bxz::default_executor(), counting);
+    bxz::compress_batch(bxz::plaintext, inputs, outputs);
+    EXPECT_EQ(counting->submitted, 5u);
+    bxz::set_default_executor(nullptr);
+    EXPECT_NE(bxz::default_executor(), counting);
+}
@@ -0,0 +1,58 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "gzip_backend_unittest.hpp"
+
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+TEST_F(GzipBackendSelectionTest, ZlibIsAlwaysAvailable) {
+    EXPECT_TRUE(bxz::gzip_backend_available(bxz::gzip_backend_default));
+    EXPECT_TRUE(bxz::gzip_backend_available(bxz::gzip_backend_zlib));
+}
+
+TEST_F(GzipBackendSelectionTest, DefaultPrefersZlibNg) {
+    const bxz::GzipBackend expected = (bxz::gzip_backend_available(bxz::gzip_backend_zlib_ng)
+				       ? bxz::gzip_backend_zlib_ng : bxz::gzip_backend_zlib);
+    EXPECT_EQ(expected, bxz::gzip_backend());
+}
+
+TEST_F(GzipBackendSelectionTest, SetGzipBackendChangesDefault) {
+    bxz::set_gzip_backend(bxz::gzip_backend_zlib);
+    EXPECT_EQ(bxz::gzip_backend_zlib, bxz::gzip_backend());
+}
+
+TEST_F(GzipBackendSelectionTest, UnavailableBackendThrows) {
+    const bxz::GzipBackend optional[] = { bxz::gzip_backend_zlib_ng, bxz::gzip_backend_isal };
+    for (const bxz::GzipBackend backend : optional) {
+	if (bxz::gzip_backend_available(backend)) continue;
+	EXPECT_THROW(bxz::set_gzip_backend(backend), std::runtime_error);
+
+	bxz::params prm;
+	prm.z_backend = backend;
+	std::stringbuf out;
+	EXPECT_THROW(bxz::ostreambuf(&out, bxz::z, prm), std::runtime_error);
+    }
+}
+
+TEST_P(GzipBackendMatrixTest, RoundTrip) {
+    const std::string compressed = this->compress(std::get<0>(GetParam()), 0);
+    EXPECT_EQ(this->expected, this->decompress(std::get<1>(GetParam()), compressed));
+}
+
+TEST_P(GzipBackendMatrixTest, RoundTripWithFlushes) {
+    const std::string compressed = this->compress(std::get<0>(GetParam()), 1000);
+    EXPECT_EQ(this->expected, this->decompress(std::get<1>(GetParam()), compressed));
+}
+
+TEST_P(GzipBackendMatrixTest, ConcatenatedMembers) {
+    const std::string compressed = this->compress(std::get<0>(GetParam()), 0);
+    EXPECT_EQ(this->expected + this->expected, this->decompress(std::get<1>(GetParam()), compressed + compressed));
+}
+
+INSTANTIATE_TEST_SUITE_P(AvailableBackends, GzipBackendMatrixTest,
+			 ::testing::Combine(::testing::ValuesIn(available_gzip_backends()),
+					    ::testing::ValuesIn(available_gzip_backends())));
+#endif
@@ -0,0 +1,76 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "line_reader_unittest.hpp"
+
+#include <cstdio>
+
+TEST_F(LineReaderTest, SameLinesAsGetline) {
+    const std::vector<std::string> expected = getlines(this->data);
+    EXPECT_TRUE(read_lines(bxz::plaintext, this->data, 1 << 16) == expected);
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+    EXPECT_TRUE(read_lines(bxz::z, this->data, 1 << 16) == expected);
+#endif
+#if defined(BXZSTR_ZSTD_SUPPORT) && (BXZSTR_ZSTD_SUPPORT) == 1
+    EXPECT_TRUE(read_lines(bxz::zstd, this->data, 1 << 16) == expected);
+#endif
+}
+
+TEST_F(LineReaderTest, LinesLongerThanTheBuffer) {
+    // every line is carried over several chunks
+    const std::string text = std::string(1000, 'a') + "\n" + std::string(3000, 'b') + "\n\n" + std::string(10, 'c');
+    EXPECT_EQ(read_lines(bxz::plaintext, text, 256), getlines(text));
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+    EXPECT_EQ(read_lines(bxz::z, text, 256), getlines(text));
+#endif
+}
+
+TEST_F(LineReaderTest, EmptyAndUnterminatedLines) {
+    EXPECT_TRUE(read_lines(bxz::plaintext, "", 64).empty());
+    EXPECT_EQ(read_lines(bxz::plaintext, "\n", 64), std::vector<std::string>({ "" }));
+    EXPECT_EQ(read_lines(bxz::plaintext, "a\n\nb", 64), std::vector<std::string>({ "a", "", "b" }));
+    EXPECT_EQ(read_lines(bxz::plaintext, "a\nb\n", 64), std::vector<std::string>({ "a", "b" }));
+}
+
+TEST_F(LineReaderTest, CustomDelimiter) {
+    const std::string text = "chr1\t100\t200\nchr2\t300\t400\n";
+    EXPECT_EQ(read_lines(bxz::plaintext, text, 4, '\t'), getlines(text, '\t'));
+}
+
+TEST_F(LineReaderTest, Next) {
+    std::stringbuf in("first\nsecond\n");
+    bxz::istreambuf ibuf(&in);
+    bxz::line_reader reader(ibuf);
+    bxz::chunk line;
+    ASSERT_TRUE(reader.next(&line));
+    EXPECT_EQ(line.str(), "first");
+    ASSERT_TRUE(reader.next(&line));
+    EXPECT_EQ(line.str(), "second");
+    EXPECT_FALSE(reader.next(&line));
+    EXPECT_FALSE(reader.next(&line));
+}
+
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+TEST_F(LineReaderTest, Ifstream) {
+    const std::string path = "line_reader_test.fastq.gz";
+    {
+	bxz::ofstream out(path, bxz::z);
+	out << this->data;
+    }
+    bxz::ifstream in(path);
+    std::size_t records = 0;
+    std::size_t line_number = 0;
+    for (const bxz::chunk &line : bxz::line_reader(in)) {
+	if (line_number++ % 4 == 0) {
+	    EXPECT_EQ(line.data[0], '@');
+	    ++records;
+	}
+    }
+    EXPECT_EQ(4*records, getlines(this->data).size());
+    std::remove(path.c_str());
+}
+#endif
@@ -0,0 +1,116 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "bxzstr.hpp"
+
+#if defined(BXZSTR_LZ4_SUPPORT) && (BXZSTR_LZ4_SUPPORT) == 1
+
+#include "lz4_stream_wrapper_unittest.hpp"
+
+#include "lz4frame.h"
+
+TEST_F(Lz4ExceptionTest, MsgConstructorWorks) {
+    bxz::lz4Exception e(msgConstructorValue);
+    const std::string &got = e.what();
+    EXPECT_EQ(msgConstructorExpected, got);
+}
+
+TEST_F(Lz4ExceptionTest, ErrcodeConstructorWorks) {
+    bxz::lz4Exception e(errcodeConstructorValue);
+    const std::string &got = e.what();
+    EXPECT_EQ(errcodeConstructorExpected, got);
+}
+
+TEST_F(Lz4StreamWrapperTest, ConstructorDoesNotThrowOnInput) {
+    EXPECT_NO_THROW(bxz::detail::lz4_stream_wrapper wrapper(testTrue));
+}
+
+TEST_F(Lz4StreamWrapperTest, ConstructorDoesNotThrowOnOutput) {
+    EXPECT_NO_THROW(bxz::detail::lz4_stream_wrapper wrapper(testFalse));
+}
+
+TEST_F(Lz4StreamWrapperTest, ParamsConstructorDoesNotThrowOnInput) {
+    bxz::params p(9);
+    p.verify_checksums = false;
+    EXPECT_NO_THROW(bxz::detail::lz4_stream_wrapper wrapper(testTrue, p));
+}
+
+TEST_F(Lz4StreamWrapperTest, ParamsConstructorDoesNotThrowOnOutput) {
+    bxz::params p(9);
+    p.lz4_block_size_id = LZ4F_max1MB;
+    p.lz4_block_independent = true;
+    p.lz4_content_size = 1000;
+    p.checksum = bxz::checksum_on;
+    EXPECT_NO_THROW(bxz::detail::lz4_stream_wrapper wrapper(testFalse, p));
+}
+
+TEST_F(Lz4StreamWrapperTest, ParamsConstructorThrowsOnInvalidParams) {
+    bxz::params p;
+    p.lz4_block_size_id = 3;
+    EXPECT_THROW(bxz::detail::lz4_stream_wrapper wrapper(testFalse, p), bxz::lz4Exception);
+}
+
+TEST_F(Lz4StreamWrapperTest, DefaultLevelUsesFastCompressor) {
+    bxz::params prm;
+    EXPECT_EQ(bxz::detail::lz4_frame_level(prm), 0);
+    prm.level = -4;
+    EXPECT_EQ(bxz::detail::lz4_frame_level(prm), -4);
+    prm.lz4_hc = true;
+    EXPECT_EQ(bxz::detail::lz4_frame_level(prm), LZ4HC_CLEVEL_MIN);
+    prm.level = 9;
+    EXPECT_EQ(bxz::detail::lz4_frame_level(prm), 9);
+    const bxz::detail::lz4_stream_wrapper fast(false, bxz::params());
+    const bxz::detail::lz4_stream_wrapper hc(false, prm);
+    EXPECT_LT(fast.memory_usage(), hc.memory_usage());
+}
+
+TEST_F(Lz4DecompressTest, DecompressDoesNotThrowOnValidFrame) {
+    EXPECT_NO_THROW(wrapper->decompress());
+}
+
+TEST_F(Lz4DecompressTest, DecompressUpdatesStreamState) {
+    wrapper->decompress();
+    EXPECT_EQ(wrapper->next_in(), &testIn[10]);
+    EXPECT_EQ(wrapper->avail_in(), 0);
+    EXPECT_EQ(wrapper->next_out(), &testOut[0]);
+    EXPECT_EQ(wrapper->avail_out(), 64);
+}
+
+TEST_F(Lz4DecompressTest, DecompressEndsStream) {
+    wrapper->set_avail_in(26);
+    wrapper->decompress();
+    EXPECT_TRUE(wrapper->stream_end());
+    EXPECT_EQ(wrapper->avail_out(), 64 - 10*2 + 1);
+}
+
+TEST_F(Lz4CompressTest, CompressEndsStream) {
+    wrapper->compress(false);
+    EXPECT_NO_THROW(wrapper->compress(true));
+    EXPECT_TRUE(wrapper->done());
+}
+
+TEST_F(Lz4CompressTest, CompressDoesNotThrowOnValidInput) {
+    EXPECT_NO_THROW(wrapper->compress(false));
+}
+
+TEST_F(Lz4CompressTest, CompressUpdatesStreamState) {
+    wrapper->compress(false);
+    EXPECT_EQ(wrapper->next_in(), &testIn[10]);
+    EXPECT_EQ(wrapper->avail_in(), 0);
+    EXPECT_GT(wrapper->next_out(), &testOut[0]);
+}
+
+TEST_F(Lz4CompressTest, CompressStagesOutputThatDoesNotFit) {
+    wrapper->set_avail_out(4);
+    wrapper->compress(false);
+    EXPECT_EQ(wrapper->avail_out(), 0);
+    EXPECT_EQ(wrapper->avail_in(), 10);
+    EXPECT_EQ(output_vals[0], 0x04);
+    EXPECT_EQ(output_vals[3], 0x18);
+}
+
+#endif
@@ -33,6 +33,23 @@ TEST_F(LzmaStreamWrapperTest, ConstructorDoesNotThrowOnOutput) {
     EXPECT_NO_THROW(bxz::detail::lzma_stream_wrapper wrapper(testFalse));
 }
 
+TEST_F(LzmaStreamWrapperTest, ParamsConstructorDoesNotThrowOnInput) {
+    bxz::params p(1);
+    p.lzma_preset_flags = LZMA_PRESET_EXTREME;
+    EXPECT_NO_THROW(bxz::detail::lzma_stream_wrapper wrapper(testTrue, p));
+}
+
+TEST_F(LzmaStreamWrapperTest, ParamsConstructorDoesNotThrowOnOutput) {
+    bxz::params p(1);
+    p.lzma_preset_flags = LZMA_PRESET_EXTREME;
+    EXPECT_NO_THROW(bxz::detail::lzma_stream_wrapper wrapper(testFalse, p));
+}
+
+TEST_F(LzmaStreamWrapperTest, ParamsConstructorThrowsOnInvalidParams) {
+    bxz::params p(10);
+    EXPECT_THROW(bxz::detail::lzma_stream_wrapper wrapper(testFalse, p), bxz::lzmaException);
+}
+
 TEST_F(LzmaDecompressTest, DecompressDoesNotThrowOnValidInput) {
     EXPECT_NO_THROW(wrapper->decompress());
 }
@@ -50,6 +67,14 @@ TEST_F(LzmaDecompressTest, DecompressUpdatesStreamState) {
     EXPECT_EQ(wrapper->avail_out(), 10);
 }
 
+TEST_F(LzmaDecompressTest, DecompressDoesNotThrowWithoutInput) {
+    wrapper->decompress();
+    EXPECT_NO_THROW(wrapper->decompress());
+    EXPECT_NO_THROW(wrapper->decompress());
+    EXPECT_EQ(wrapper->avail_out(), 10);
+    EXPECT_FALSE(wrapper->stream_end());
+}
+
 TEST_F(LzmaCompressTest, CompressEndsStream) {
     wrapper->set_avail_out(0);
     wrapper->set_next_out(&testOut[10]);
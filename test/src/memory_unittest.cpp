@@ -0,0 +1,86 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "memory_unittest.hpp"
+
+TEST_F(MemoryBudgetTest, StreamsAreAccountedFor) {
+    const uint64_t before = bxz::memory_in_use();
+    {
+	bxz::istreambuf ibuf(&sbuf, this->buff_size);
+	EXPECT_EQ(bxz::memory_in_use(), before + 2*this->buff_size);
+    }
+    EXPECT_EQ(bxz::memory_in_use(), before);
+}
+
+TEST_F(MemoryBudgetTest, StreamOverBudgetThrows) {
+    bxz::set_memory_budget(bxz::memory_in_use() + this->buff_size);
+    EXPECT_THROW(bxz::istreambuf ibuf(&sbuf, this->buff_size), std::runtime_error);
+}
+
+TEST_F(MemoryBudgetTest, StreamWithinBudgetDoesNotThrow) {
+    bxz::set_memory_budget(bxz::memory_in_use() + 4*this->buff_size);
+    EXPECT_NO_THROW(bxz::istreambuf ibuf(&sbuf, this->buff_size));
+}
+
+TEST_F(MemoryBudgetTest, EffectiveLimitIsWhatIsLeftOfBudget) {
+    bxz::set_memory_budget(bxz::memory_in_use() + 1000);
+    EXPECT_EQ(bxz::detail::effective_memory_limit(0), (uint64_t)1000);
+    EXPECT_EQ(bxz::detail::effective_memory_limit(100), (uint64_t)100);
+}
+
+#if defined(BXZSTR_LZMA_SUPPORT) && (BXZSTR_LZMA_SUPPORT) == 1
+TEST_F(MemoryLimitTest, LzmaDecoderRespectsLimit) {
+    const std::string data = this->compress(bxz::lzma, bxz::params(6), 10);
+    EXPECT_THROW(this->decompress(data), bxz::lzmaException);
+}
+
+TEST_F(MemoryLimitTest, LzmaMemoryUsageIsReported) {
+    bxz::detail::lzma_stream_wrapper wrapper(false, bxz::params(1));
+    EXPECT_GT(wrapper.memory_usage(), (std::size_t)0);
+}
+#endif
+
+#if defined(BXZSTR_BZ2_SUPPORT) && (BXZSTR_BZ2_SUPPORT) == 1
+TEST_F(MemoryLimitTest, Bz2DecoderUsesSmallModeUnderLimit) {
+    bxz::detail::bz_stream_wrapper normal(true, bxz::params());
+    bxz::params p;
+    p.memory_limit = (uint64_t)3 << 20;
+    bxz::detail::bz_stream_wrapper small(true, p);
+    EXPECT_LT(small.memory_usage(), normal.memory_usage());
+
+    const std::string data = this->compress(bxz::bz2, bxz::params(9), 1000);
+    this->prm.memory_limit = p.memory_limit;
+    EXPECT_EQ(this->decompress(data), this->decompress(data));
+}
+#endif
+
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+TEST_F(MemoryLimitTest, ZMemoryUsageIsReported) {
+    bxz::detail::z_stream_wrapper wrapper(false, bxz::params());
+    EXPECT_GT(wrapper.memory_usage(), (std::size_t)0);
+}
+#endif
+
+#if defined(BXZSTR_ZSTD_SUPPORT) && (BXZSTR_ZSTD_SUPPORT) == 1
+TEST_F(MemoryLimitTest, ZstdDecoderRespectsLimit) {
+    bxz::params p;
+    p.zstd_window_log = 24;
+    const std::string data = this->compress(bxz::zstd, p, 1000000);
+    EXPECT_THROW(this->decompress(data), bxz::zstdException);
+}
+
+TEST_F(MemoryLimitTest, ZstdDecoderWithinLimitDoesNotThrow) {
+    const std::string data = this->compress(bxz::zstd, bxz::params(), 1000);
+    this->prm.memory_limit = (uint64_t)1 << 23;
+    EXPECT_NO_THROW(this->decompress(data));
+}
+
+TEST_F(MemoryLimitTest, ZstdMemoryUsageIsReported) {
+    bxz::detail::zstd_stream_wrapper wrapper(false, bxz::params());
+    EXPECT_GT(wrapper.memory_usage(), (std::size_t)0);
+}
+#endif
@@ -0,0 +1,114 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "one_shot_unittest.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <iterator>
+
+TEST_F(OneShotTest, RoundTrip) {
+    for (const bxz::Compression type : this->types()) {
+	for (const std::string &data : { this->message, this->large, std::string() }) {
+	    const std::string compressed = bxz::compress(type, data);
+	    EXPECT_LE(compressed.size(), bxz::compress_bound(type, data.size())) << type;
+	    EXPECT_TRUE(bxz::decompress(compressed, type) == data) << type;
+	}
+    }
+}
+
+TEST_F(OneShotTest, DetectsTheFormat) {
+    for (const bxz::Compression type : this->types()) {
+	if (type == bxz::brotli) continue;
+	EXPECT_EQ(bxz::decompress(bxz::compress(type, this->message, 1)), this->message) << type;
+    }
+}
+
+TEST_F(OneShotTest, StreamsReadOneShotOutput) {
+    for (const bxz::Compression type : this->types()) {
+	std::stringbuf in(bxz::compress(type, this->large, 3));
+	bxz::istreambuf ibuf(&in, type);
+	EXPECT_TRUE(std::string(std::istreambuf_iterator<char>(&ibuf), std::istreambuf_iterator<char>()) == this->large) << type;
+    }
+}
+
+TEST_F(OneShotTest, ReadsStreamOutput) {
+    for (const bxz::Compression type : this->types()) {
+	if (type == bxz::plaintext) continue;
+	std::stringbuf out;
+	{
+	    bxz::ostreambuf obuf(&out, type, 6);
+	    std::ostream os(&obuf);
+	    // two members or frames
+	    os << this->large.substr(0, 1000) << std::flush << this->large.substr(1000);
+	}
+	EXPECT_TRUE(bxz::decompress(out.str(), type) == this->large) << type;
+    }
+}
+
+TEST_F(OneShotTest, BufferTooSmallThrows) {
+    for (const bxz::Compression type : this->types()) {
+	const std::string compressed = bxz::compress(type, this->large);
+	std::vector<char> dst(this->large.size() - 1);
+	EXPECT_THROW(bxz::decompress(compressed.data(), compressed.size(), dst.data(), dst.size(), type),
+		     std::runtime_error) << type;
+	std::vector<char> small(compressed.size()/2);
+	EXPECT_THROW(bxz::compress(type, this->large.data(), this->large.size(), small.data(), small.size()),
+		     std::runtime_error) << type;
+    }
+}
+
+TEST_F(OneShotTest, ExactBuffer) {
+    for (const bxz::Compression type : this->types()) {
+	const std::string compressed = bxz::compress(type, this->large);
+	std::vector<char> dst(this->large.size());
+	EXPECT_EQ(bxz::decompress(compressed.data(), compressed.size(), dst.data(), dst.size(), type), this->large.size()) << type;
+	EXPECT_TRUE(std::string(dst.begin(), dst.end()) == this->large) << type;
+    }
+}
+
+TEST_F(OneShotTest, TruncatedInputThrows) {
+    for (const bxz::Compression type : this->types()) {
+	if (type == bxz::plaintext) continue;
+	const std::string compressed = bxz::compress(type, this->large);
+	EXPECT_ANY_THROW(bxz::decompress(compressed.substr(0, compressed.size()/2), type)) << type;
+    }
+}
+
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+TEST_F(OneShotTest, ForgedGzipSizeThrowsWithoutLargeAllocation) {
+    // ISIZE of 4 GiB - 1; the output is only sized up to 32x the input
+    std::string compressed = bxz::compress(bxz::z, this->message);
+    compressed.replace(compressed.size() - 4, 4, "\xff\xff\xff\xff");
+    EXPECT_THROW(bxz::decompress(compressed, bxz::z), bxz::zException);
+}
+#endif
+
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+TEST_F(OneShotTest, GzipLevelChangeLeavesLastOutputAlone) {
+    std::vector<char> first(bxz::compress_bound(bxz::z, this->large.size()));
+    bxz::compress(bxz::z, this->large.data(), this->large.size(), first.data(), first.size(), 1);
+    std::fill(first.begin(), first.end(), 'x');
+    const std::string best = bxz::compress(bxz::z, this->large, 6);
+    EXPECT_EQ(std::count(first.begin(), first.end(), 'x'), (std::ptrdiff_t)first.size());
+    EXPECT_TRUE(bxz::decompress(best) == this->large);
+}
+#endif
+
+TEST_F(OneShotTest, LevelsChangeBetweenCalls) {
+    for (const bxz::Compression type : this->types()) {
+	if (type == bxz::plaintext) continue;
+	// lz4 levels only change the acceleration unless lz4_hc is set
+	const int fast_level = (type == bxz::lz4 ? -20 : 1);
+	const std::string fast = bxz::compress(type, this->large, fast_level);
+	const std::string best = bxz::compress(type, this->large, 9);
+	const std::string fast_again = bxz::compress(type, this->large, fast_level);
+	EXPECT_TRUE(fast == fast_again) << type;
+	EXPECT_FALSE(best == fast) << type;
+    }
+}
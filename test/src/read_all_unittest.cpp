@@ -0,0 +1,110 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "read_all_unittest.hpp"
+
+#include <iterator>
+#include <stdexcept>
+
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+TEST_F(ReadAllTest, Gzip) {
+    this->write(bxz::z);
+    EXPECT_EQ(bxz::read_all(this->path), this->data);
+}
+
+TEST_F(ReadAllTest, GzipMembers) {
+    // the trailer of the last member gives too small a size
+    this->write(bxz::z, true);
+    EXPECT_EQ(bxz::read_all(this->path), this->data);
+}
+
+TEST_F(ReadAllTest, ForgedGzipSizeIsOnlyAHint) {
+    this->write(bxz::z);
+    {
+	// ISIZE of 4 GiB - 1 for 1 MB of text
+	std::fstream out(this->path, std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+	out.seekp(-4, std::ios_base::end);
+	out.write("\xff\xff\xff\xff", 4);
+    }
+    bxz::params prm;
+    prm.verify_checksums = false;
+    EXPECT_EQ(bxz::read_all(this->path, prm), this->data);
+}
+
+TEST_F(ReadAllTest, TruncatedGzipThrows) {
+    this->write(bxz::z);
+    std::string compressed;
+    {
+	std::ifstream in(this->path, std::ios_base::binary);
+	compressed.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    {
+	std::ofstream out(this->path, std::ios_base::binary);
+	out << compressed.substr(0, compressed.size()/2);
+    }
+    EXPECT_THROW(bxz::read_all(this->path), std::runtime_error);
+    bxz::params prm;
+    prm.verify_checksums = false;
+    EXPECT_THROW(bxz::read_all(this->path, prm), std::runtime_error);
+}
+
+TEST_F(ReadAllTest, Bgzf) {
+    this->write(bxz::bgzf);
+    EXPECT_EQ(bxz::read_all(this->path), this->data);
+}
+#endif
+
+#if defined(BXZSTR_BZ2_SUPPORT) && (BXZSTR_BZ2_SUPPORT) == 1
+TEST_F(ReadAllTest, Bzip2SizeIsGuessed) {
+    this->write(bxz::bz2, true);
+    EXPECT_EQ(bxz::read_all(this->path), this->data);
+}
+#endif
+
+#if defined(BXZSTR_LZMA_SUPPORT) && (BXZSTR_LZMA_SUPPORT) == 1
+TEST_F(ReadAllTest, Xz) {
+    this->write(bxz::lzma, true);
+    EXPECT_EQ(bxz::read_all(this->path), this->data);
+}
+#endif
+
+#if defined(BXZSTR_ZSTD_SUPPORT) && (BXZSTR_ZSTD_SUPPORT) == 1
+TEST_F(ReadAllTest, Zstd) {
+    this->write(bxz::zstd, true);
+    EXPECT_EQ(bxz::read_all(this->path), this->data);
+    bxz::params prm;
+    prm.zstd_pledged_size = this->data.size();
+    this->write(bxz::zstd, false, prm);
+    EXPECT_EQ(bxz::read_all(this->path), this->data);
+}
+#endif
+
+TEST_F(ReadAllTest, Plaintext) {
+    {
+	std::ofstream out(this->path, std::ios_base::binary);
+	out << this->data;
+    }
+    EXPECT_EQ(bxz::read_all(this->path), this->data);
+}
+
+TEST_F(ReadAllTest, EmptyFile) {
+    {
+	std::ofstream out(this->path, std::ios_base::binary);
+    }
+    EXPECT_EQ(bxz::read_all(this->path), "");
+}
+
+#if defined(__linux__)
+TEST_F(ReadAllTest, ProcFileIsRead) {
+    // reports a size of 0
+    EXPECT_NE(bxz::read_all("/proc/self/status").find("Name:"), std::string::npos);
+}
+#endif
+
+TEST_F(ReadAllTest, MissingFileThrows) {
+    EXPECT_THROW(bxz::read_all("read_all_missing.bin"), std::runtime_error);
+}
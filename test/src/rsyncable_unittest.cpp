@@ -0,0 +1,77 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "rsyncable_unittest.hpp"
+
+TEST_F(RsyncableTest, BoundariesDependOnContentOnly) {
+    bxz::detail::rsync_boundaries whole(bxz::detail::rsync_flush_mask);
+    bxz::detail::rsync_boundaries pieces(bxz::detail::rsync_flush_mask);
+    const unsigned char *p = reinterpret_cast<const unsigned char*>(this->original.data());
+    size_t offset = 0;
+    size_t boundaries = 0;
+    while (true) {
+	size_t n = this->original.size() - offset;
+	if (!whole.scan(p + offset, &n)) break;
+	// the same boundary is found when the input arrives in small pieces
+	size_t scanned = 0;
+	bool found = false;
+	while (!found) {
+	    size_t m = std::min((size_t)1000, n - scanned);
+	    found = pieces.scan(p + offset + scanned, &m);
+	    scanned += m;
+	}
+	ASSERT_EQ(n, scanned);
+	offset += n;
+	++boundaries;
+    }
+    // about one boundary in 8 KiB
+    EXPECT_GT(boundaries, this->original.size() / 16384);
+    EXPECT_LT(boundaries, this->original.size() / 4096);
+}
+
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+TEST_F(RsyncableTest, GzipRoundTrip) {
+    bxz::params prm;
+    prm.rsyncable = true;
+    EXPECT_EQ(this->original, this->decompress(this->compress(this->original, bxz::z, prm)));
+}
+
+TEST_F(RsyncableTest, GzipOutputResynchronizes) {
+    bxz::params prm;
+    const std::string plain_a = this->compress(this->original, bxz::z, prm);
+    const std::string plain_b = this->compress(this->edited, bxz::z, prm);
+    prm.rsyncable = true;
+    const std::string a = this->compress(this->original, bxz::z, prm);
+    const std::string b = this->compress(this->edited, bxz::z, prm);
+    // everything but the first block and the gzip trailer is shared
+    EXPECT_GT(common_suffix(a, b, 8), a.size() - 8192);
+    EXPECT_LT(common_suffix(plain_a, plain_b, 8), plain_a.size() / 2);
+    // at a cost in ratio, which is larger on this repetitive text than
+    // on typical data
+    EXPECT_LT(a.size(), plain_a.size() + plain_a.size() / 4);
+}
+#endif
+
+#if defined(BXZSTR_ZSTD_SUPPORT) && (BXZSTR_ZSTD_SUPPORT) == 1
+TEST_F(RsyncableTest, ZstdFramesResynchronize) {
+    bxz::params prm(3);
+    prm.rsyncable = true;
+    const std::string a = this->compress(this->original, bxz::zstd, prm);
+    const std::string b = this->compress(this->edited, bxz::zstd, prm);
+    EXPECT_EQ(this->original, this->decompress(a));
+    EXPECT_EQ(this->edited, this->decompress(b));
+    EXPECT_GT(common_suffix(a, b), a.size() / 2);
+}
+
+TEST_F(RsyncableTest, ZstdWorkersRoundTrip) {
+    if (ZSTD_cParam_getBounds(ZSTD_c_nbWorkers).upperBound == 0) GTEST_SKIP() << "zstd without threads";
+    bxz::params prm(3);
+    prm.rsyncable = true;
+    prm.zstd_workers = 2;
+    EXPECT_EQ(this->original, this->decompress(this->compress(this->original, bxz::zstd, prm)));
+}
+#endif
@@ -0,0 +1,93 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "stream_stats_unittest.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <iterator>
+
+#if defined(BXZSTR_Z_SUPPORT) && (BXZSTR_Z_SUPPORT) == 1
+TEST_F(StreamStatsTest, DisabledByDefault) {
+    std::stringbuf in(this->compressed);
+    bxz::istreambuf ibuf(&in);
+    std::string decompressed((std::istreambuf_iterator<char>(&ibuf)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(ibuf.stats().uncompressed_bytes, 0);
+    EXPECT_EQ(ibuf.stats().buffer_calls, 0);
+}
+
+TEST_F(StreamStatsTest, ReaderCountsBytesAndMembers) {
+    std::stringbuf in(this->compressed);
+    bxz::istreambuf ibuf(&in, this->stats_params(), (std::size_t)1 << 16);
+    std::string decompressed((std::istreambuf_iterator<char>(&ibuf)), std::istreambuf_iterator<char>());
+    const bxz::stream_stats stats = ibuf.stats();
+    EXPECT_EQ(stats.compressed_bytes, this->compressed.size());
+    EXPECT_EQ(stats.uncompressed_bytes, this->data.size());
+    EXPECT_EQ(stats.streams, 2);
+    EXPECT_GT(stats.buffer_calls, 2);
+    EXPECT_GT(stats.codec_ns, 0);
+    EXPECT_GE(stats.peak_memory, ((std::size_t)1 << 17));
+}
+
+TEST_F(StreamStatsTest, WriterCountsBytesAndMembers) {
+    std::stringbuf out;
+    bxz::ostreambuf obuf(&out, bxz::z, this->stats_params());
+    std::ostream os(&obuf);
+    os << this->data.substr(0, 100000) << std::flush;
+    os << this->data.substr(100000);
+    obuf.close();
+    const bxz::stream_stats stats = obuf.stats();
+    EXPECT_EQ(stats.compressed_bytes, out.str().size());
+    EXPECT_EQ(stats.uncompressed_bytes, this->data.size());
+    EXPECT_EQ(stats.streams, 2);
+    EXPECT_GT(stats.codec_ns, 0);
+}
+
+TEST_F(StreamStatsTest, CallbackSeesProgress) {
+    bxz::params prm;
+    std::size_t calls = 0;
+    uint64_t last = 0;
+    prm.on_stats = [&calls, &last](const bxz::stream_stats &stats) {
+	++calls;
+	EXPECT_GE(stats.uncompressed_bytes, last);
+	last = stats.uncompressed_bytes;
+    };
+    std::stringbuf in(this->compressed);
+    bxz::istreambuf ibuf(&in, prm, (std::size_t)1 << 16);
+    std::string decompressed((std::istreambuf_iterator<char>(&ibuf)), std::istreambuf_iterator<char>());
+    EXPECT_GT(calls, 2);
+    EXPECT_EQ(last, this->data.size());
+}
+
+TEST_F(StreamStatsTest, SlowConsumerShowsAsCallerTime) {
+    std::stringbuf in(this->compressed);
+    bxz::istream is(&in, this->stats_params());
+    std::string line;
+    for (int i = 0; std::getline(is, line); ++i) {
+	if (i % 10000 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    const bxz::stream_stats stats = static_cast<bxz::istreambuf*>(is.rdbuf())->stats();
+    EXPECT_GT(stats.caller_ns, stats.io_ns);
+    EXPECT_GE(stats.caller_ns, (uint64_t)20000000);
+}
+
+TEST_F(StreamStatsTest, FileStreams) {
+    const std::string path = "stream_stats_test.gz";
+    {
+	bxz::ofstream out(path, bxz::z, this->stats_params());
+	out << this->data;
+	out.close();
+	EXPECT_EQ(out.stats().uncompressed_bytes, this->data.size());
+    }
+    bxz::ifstream in(path, this->stats_params());
+    std::string decompressed((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(in.stats().uncompressed_bytes, this->data.size());
+    EXPECT_EQ(in.stats().streams, 1);
+    std::remove(path.c_str());
+}
+#endif
@@ -33,6 +33,28 @@ TEST_F(ZStreamWrapperTest, ConstructorDoesNotThrowOnOutput) {
     EXPECT_NO_THROW(bxz::detail::z_stream_wrapper wrapper(testFalse));
 }
 
+TEST_F(ZStreamWrapperTest, ParamsConstructorDoesNotThrowOnInput) {
+    bxz::params p;
+    p.z_window_bits = 12;
+    p.z_mem_level = 9;
+    p.z_strategy = Z_RLE;
+    EXPECT_NO_THROW(bxz::detail::z_stream_wrapper wrapper(testTrue, p));
+}
+
+TEST_F(ZStreamWrapperTest, ParamsConstructorDoesNotThrowOnOutput) {
+    bxz::params p;
+    p.z_window_bits = 12;
+    p.z_mem_level = 9;
+    p.z_strategy = Z_RLE;
+    EXPECT_NO_THROW(bxz::detail::z_stream_wrapper wrapper(testFalse, p));
+}
+
+TEST_F(ZStreamWrapperTest, ParamsConstructorThrowsOnInvalidParams) {
+    bxz::params p;
+    p.z_mem_level = 0;
+    EXPECT_THROW(bxz::detail::z_stream_wrapper wrapper(testFalse, p), bxz::zException);
+}
+
 TEST_F(ZDecompressTest, DecompressDoesNotThrowOnValidInput) {
     EXPECT_NO_THROW(wrapper->decompress());
 }
@@ -50,6 +72,14 @@ TEST_F(ZDecompressTest, DecompressUpdatesStreamState) {
     EXPECT_EQ(wrapper->avail_out(), 10);
 }
 
+TEST_F(ZDecompressTest, DecompressDoesNotThrowWithoutInput) {
+    wrapper->decompress();
+    EXPECT_NO_THROW(wrapper->decompress());
+    EXPECT_NO_THROW(wrapper->decompress());
+    EXPECT_EQ(wrapper->avail_out(), 10);
+    EXPECT_FALSE(wrapper->stream_end());
+}
+
 TEST_F(ZCompressTest, CompressEndsStream) {
     wrapper->set_avail_out(0);
     wrapper->set_next_out(&testOut[10]);
@@ -0,0 +1,89 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "bxzstr.hpp"
+
+#if defined(BXZSTR_ZSTD_SUPPORT) && (BXZSTR_ZSTD_SUPPORT) == 1
+
+#include "zstd_dictionary_unittest.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+TEST_F(ZstdDictionaryTest, TrainedDictionaryHasId) {
+    EXPECT_GT(this->dict.size(), 0);
+    EXPECT_LE(this->dict.size(), 4096);
+    EXPECT_NE(this->dict_id, 0);
+    ASSERT_TRUE(bxz::find_zstd_dictionary(this->dict_id) != nullptr);
+    EXPECT_EQ(bxz::find_zstd_dictionary(this->dict_id)->id(), this->dict_id);
+}
+
+TEST_F(ZstdDictionaryTest, RawContentDictionaryIsRejected) {
+    EXPECT_THROW(bxz::add_zstd_dictionary("not a trained dictionary"), std::runtime_error);
+}
+
+TEST_F(ZstdDictionaryTest, RoundTripSelectsDictionaryFromFrame) {
+    bxz::params prm(3);
+    prm.zstd_dict_id = this->dict_id;
+    for (size_t i = 0; i < this->samples.size(); i += 100) {
+	EXPECT_EQ(this->samples[i], this->decompress(this->compress(this->samples[i], prm)));
+    }
+}
+
+TEST_F(ZstdDictionaryTest, DictionaryImprovesRatio) {
+    bxz::params prm(3);
+    size_t without = 0;
+    size_t with = 0;
+    for (size_t i = 0; i < this->samples.size(); i += 100) {
+	without += this->compress(this->samples[i], prm).size();
+    }
+    prm.zstd_dict_id = this->dict_id;
+    for (size_t i = 0; i < this->samples.size(); i += 100) {
+	with += this->compress(this->samples[i], prm).size();
+    }
+    EXPECT_LT(2*with, without);
+}
+
+TEST_F(ZstdDictionaryTest, UnregisteredDictionaryThrows) {
+    bxz::params prm(3);
+    prm.zstd_dict_id = this->dict_id;
+    const std::string compressed = this->compress(this->samples[0], prm);
+    bxz::remove_zstd_dictionary(this->dict_id);
+    EXPECT_ANY_THROW(this->decompress(compressed));
+    std::stringbuf out;
+    EXPECT_THROW(bxz::ostreambuf(&out, bxz::zstd, prm), bxz::zstdException);
+}
+
+TEST_F(ZstdDictionaryTest, FilesRoundTripWithIfstream) {
+    bxz::params prm(3);
+    prm.zstd_dict_id = this->dict_id;
+    {
+	bxz::ofstream out("ZstdDictionaryTest_fake_data.json.zst", bxz::zstd, prm);
+	out << this->samples[1] << this->samples[2];
+    }
+    bxz::ifstream in("ZstdDictionaryTest_fake_data.json.zst");
+    std::string line;
+    std::getline(in, line);
+    EXPECT_EQ(line + '\n', this->samples[1]);
+    std::getline(in, line);
+    EXPECT_EQ(line + '\n', this->samples[2]);
+}
+
+TEST_F(ZstdDictionaryTest, TrainFromFiles) {
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < 200; ++i) {
+	paths.push_back("ZstdDictionaryTest_sample_" + std::to_string(i) + ".json");
+	std::ofstream out(paths.back());
+	for (size_t j = 0; j < 5; ++j) out << this->samples[5*i + j];
+    }
+    const std::string dict = bxz::train_zstd_dictionary_from_files(paths, 2048);
+    EXPECT_GT(dict.size(), 0);
+    EXPECT_LE(dict.size(), 2048);
+    for (const std::string &path : paths) std::remove(path.c_str());
+}
+
+#endif
@@ -0,0 +1,72 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * This file is a part of bxzstr (https://github.com/tmaklin/bxzstr)
+ * Written by Tommi Mäklin (tommi@maklin.fi) */
+
+#include "bxzstr.hpp"
+
+#if defined(BXZSTR_ZSTD_SUPPORT) && (BXZSTR_ZSTD_SUPPORT) == 1
+
+#include "zstd_patch_unittest.hpp"
+
+TEST_F(ZstdPatchTest, RoundTrip) {
+    const std::string patch = this->compress(this->next_version, this->patch_params());
+    EXPECT_EQ(this->next_version, this->decompress(patch, this->patch_params()));
+}
+
+TEST_F(ZstdPatchTest, PatchIsMuchSmallerThanFullCompression) {
+    const std::string full = this->compress(this->next_version, bxz::params(3));
+    const std::string patch = this->compress(this->next_version, this->patch_params());
+    EXPECT_LT(patch.size()*100, full.size());
+}
+
+TEST_F(ZstdPatchTest, EachFrameUsesTheReference) {
+    bxz::params prm = this->patch_params();
+    std::stringbuf out;
+    {
+	bxz::ostreambuf obuf(&out, bxz::zstd, prm);
+	std::ostream os(&obuf);
+	os << this->next_version.substr(0, 1000000) << std::flush;
+	os << this->next_version.substr(1000000);
+    }
+    EXPECT_LT(out.str().size(), 10000);
+    EXPECT_EQ(this->next_version, this->decompress(out.str(), prm));
+}
+
+TEST_F(ZstdPatchTest, FilesRoundTrip) {
+    const std::string path = "zstd_patch_test.zst";
+    {
+	bxz::ofstream out(path, bxz::zstd, this->patch_params());
+	out << this->next_version;
+    }
+    bxz::ifstream in(path, this->patch_params());
+    const std::string decompressed((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(this->next_version, decompressed);
+    std::remove(path.c_str());
+}
+
+TEST_F(ZstdPatchTest, DecompressWithoutReferenceThrows) {
+    const std::string patch = this->compress(this->next_version, this->patch_params());
+    EXPECT_THROW(this->decompress(patch, bxz::params()), bxz::zstdException);
+}
+
+#if defined(__linux__)
+TEST_F(ZstdPatchTest, ReferenceIsReadWhenItCannotBeMapped) {
+    // reports a size of 0
+    bxz::params prm(3);
+    prm.zstd_patch_from = "/proc/self/cmdline";
+    const std::string patch = this->compress(this->next_version, prm);
+    EXPECT_EQ(this->next_version, this->decompress(patch, prm));
+    EXPECT_GT(bxz::detail::mapped_file(prm.zstd_patch_from).size(), 0);
+}
+#endif
+
+TEST_F(ZstdPatchTest, MissingReferenceThrows) {
+    bxz::params prm(3);
+    prm.zstd_patch_from = "no_such_reference.bin";
+    EXPECT_THROW(this->compress(this->next_version, prm), std::runtime_error);
+}
+
+#endif
@@ -36,6 +36,30 @@ TEST_F(ZstdStreamWrapperTest, ConstructorDoesNotThrowOnOutput) {
     EXPECT_NO_THROW(bxz::detail::zstd_stream_wrapper wrapper(testFalse));
 }
 
+TEST_F(ZstdStreamWrapperTest, ParamsConstructorDoesNotThrowOnInput) {
+    bxz::params p(19);
+    p.zstd_window_log = 20;
+    p.zstd_long_distance_matching = true;
+    p.zstd_strategy = ZSTD_btultra;
+    p.zstd_window_log_max = 20;
+    EXPECT_NO_THROW(bxz::detail::zstd_stream_wrapper wrapper(testTrue, p));
+}
+
+TEST_F(ZstdStreamWrapperTest, ParamsConstructorDoesNotThrowOnOutput) {
+    bxz::params p(19);
+    p.zstd_window_log = 20;
+    p.zstd_long_distance_matching = true;
+    p.zstd_strategy = ZSTD_btultra;
+    p.zstd_window_log_max = 20;
+    EXPECT_NO_THROW(bxz::detail::zstd_stream_wrapper wrapper(testFalse, p));
+}
+
+TEST_F(ZstdStreamWrapperTest, ParamsConstructorThrowsOnInvalidParams) {
+    bxz::params p;
+    p.zstd_window_log = 64;
+    EXPECT_THROW(bxz::detail::zstd_stream_wrapper wrapper(testFalse, p), bxz::zstdException);
+}
+
 TEST_F(ZstdDecompressTest, DecompressDoesNotThrowOnValidFrame) {
     EXPECT_NO_THROW(wrapper->decompress());
 }